@@ -41,14 +41,23 @@ model::Office DeserializeOffice(const json::value& json_office) {
   return model::Office(office_id, office_point, office_offset);
 }
 
+model::LootType DeserializeLootType(const json::value& json_loot_type) {
+  auto value = json_loot_type.at("value"s).as_int64();
+  if (value < 0) {
+    throw std::invalid_argument("Negative value of loot type"s);
+  }
+  return model::LootType(static_cast<std::uint32_t>(value),
+                         json::serialize(json_loot_type));
+}
+
 // Вызывает внутри себя функции:
 //  - DeserializeRoad(const json::value&);
 //  - DeserializeBuilding(const json::value&);
 //  - DeserializeOffice(const json::value&);
+//  - DeserializeLootType(const json::value&);
 //  - JsonObjectToString(const json::value& value);
 model::Map DeserializeMap(const json::object& json_map,
                           model::Speed& default_dog_speed,
-                          std::uint32_t num_of_loot_types,
                           std::uint32_t default_bag_capacity,
                           Seconds dog_retirement_time) {
   if (const auto& dog_speed = json_map.if_contains("dogSpeed"s)) {
@@ -62,8 +71,7 @@ model::Map DeserializeMap(const json::object& json_map,
   }
   model::Map::Id map_id(JsonObjectToString(json_map.at("id"s)));
   model::Map map(map_id, JsonObjectToString(json_map.at("name"s)),
-                 default_dog_speed, num_of_loot_types, default_bag_capacity,
-                 dog_retirement_time);
+                 default_dog_speed, default_bag_capacity, dog_retirement_time);
   for (const auto& map_road : json_map.at("roads"s).as_array()) {
     try {
       model::Road road = DeserializeRoad(map_road);
@@ -90,6 +98,17 @@ model::Map DeserializeMap(const json::object& json_map,
                                e.what());
     }
   }
+  for (const auto& map_loot_type : json_map.at("lootTypes"s).as_array()) {
+    try {
+      map.AddLootType(DeserializeLootType(map_loot_type));
+    } catch (const std::exception& e) {
+      throw std::runtime_error("Error when deserializing the loot type"s +
+                               e.what());
+    }
+  }
+  if (map.GetLootTypes().empty()) {
+    throw std::invalid_argument("Map has no loot types"s);
+  }
   return map;
 }
 
@@ -99,8 +118,8 @@ model::Map DeserializeMap(const json::object& json_map,
 //  - DeserializeOffice(const json::value&);
 //  - DeserializeMap(const json::object& json_map,
 //                   model::Speed& default_dog_speed,
-//                   std::uint32_t num_of_loot_types,
-//                   std::uint32_t default_bag_capacity);
+//                   std::uint32_t default_bag_capacity,
+//                   Seconds dog_retirement_time);
 //  - JsonObjectToString(const json::value& value);
 model::Game LoadGame(const std::filesystem::path& json_path) {
   std::string json_obj_to_str = util::LoadContentFromFile(json_path);
@@ -128,7 +147,6 @@ model::Game LoadGame(const std::filesystem::path& json_path) {
           model::Speed(dog_speed->as_double(), dog_speed->as_double());
     }
     try {
-      auto loot_types = json_map.at("lootTypes"s).as_array();
       std::uint32_t default_bag_capacity = 3;
       if (const auto& bag_capacity =
               json_content.if_contains("defaultBagCapacity"s)) {
@@ -136,9 +154,8 @@ model::Game LoadGame(const std::filesystem::path& json_path) {
             static_cast<std::uint32_t>(bag_capacity->as_uint64());
       }
       model::Map map = DeserializeMap(json_map.as_object(), default_dog_speed,
-                                      loot_types.size(), default_bag_capacity,
+                                      default_bag_capacity,
                                       default_dog_retirement_time);
-      LootTypesStorage::AddTypesOfLoots(map.GetId(), loot_types);
       game.AddMap(std::move(map));
     } catch (const std::exception& e) {
       throw std::runtime_error("Error during parsing config.json: "s +
@@ -5,7 +5,6 @@
 
 #include "../model/model.h"
 #include "../util/file_handler.h"
-#include "loot_types_storage.h"
 
 namespace json_loader {
 
@@ -30,19 +29,23 @@ model::Building DeserializeBuilding(const json::value& json_building);
 // model::Office и возвращает этот объект.
 model::Office DeserializeOffice(const json::value& json_office);
 
+// Получает описание типа потерянного предмета в формате JSON, исходя из этих
+// данных создает объект model::LootType и возвращает этот объект. Описание
+// сериализуется один раз, чтобы ответы на /api/v1/maps/{id} переиспользовали
+// готовые байты.
+model::LootType DeserializeLootType(const json::value& json_loot_type);
+
 // Получает описание игровой карты в формате JSON и данные, нужные для
 // конструирования объекта model::Map, исходя из этих данных создает объект
 // model::Map и возвращает этот объект.
 model::Map DeserializeMap(const json::object& json_map,
                           model::Speed& default_dog_speed,
-                          std::uint32_t num_of_loot_types,
                           std::uint32_t default_bag_capacity,
                           Seconds dog_retirement_time);
 
 // Получает путь к конфигурационному файлу config.json, содержащий информацию
-// об объектах игры. Создает хранилище для типов потерянных объектов
-// LootTypesStorage, конструирует объект model::Game, заполняет его информацией
-// о картах и возвращает его.
+// об объектах игры. Конструирует объект model::Game, заполняет его информацией
+// о картах и типах потерянных объектов на них и возвращает его.
 model::Game LoadGame(const std::filesystem::path& json_path);
 
 }  // namespace json_loader
\ No newline at end of file
@@ -159,8 +159,13 @@ GameSession::RetiredDogs Game::UpdateGameSession(
   using namespace std::chrono;
   if (auto game_session = GetGameSessionById(game_session_id)) {
     auto map = GetMapById(game_session->GetMapId());
-    std::uint32_t loot_count = loot_generator_.Generate(
-        time_delta, game_session->GetLootCount(), game_session->GetDogsCount());
+    std::uint32_t loot_count = 0;
+    {
+      util::TickProfiler::PhaseTimer timer(util::TickPhase::kLootGeneration);
+      loot_count = loot_generator_.Generate(time_delta,
+                                            game_session->GetLootCount(),
+                                            game_session->GetDogsCount());
+    }
     auto retired_dogs =
         game_session->UpdateSession(map, loot_count, time_delta);
     if (game_session->IsEmpty()) {
@@ -174,6 +179,22 @@ GameSession::RetiredDogs Game::UpdateGameSession(
   }
 }
 
+Game::Milliseconds Game::GetGameSessionIdleTime(
+    const GameSession::Id& game_session_id) const {
+  if (auto game_session = GetGameSessionById(game_session_id)) {
+    // Генератор создает потерянные вещи, только пока их меньше, чем собак.
+    if (game_session->HasMovingDogs() ||
+        game_session->GetLootCount() < game_session->GetDogsCount()) {
+      return Milliseconds::zero();
+    }
+    auto map = GetMapById(game_session->GetMapId());
+    return game_session->GetTimeUntilRetirement(map->GetDogRetirementTime());
+  }
+  throw std::invalid_argument("Game session with id "s +
+                              std::to_string(*game_session_id) +
+                              "does not exist"s);
+}
+
 Dog* Game::AddDogInGameSession(const GameSession::Id& game_session_id,
                                std::string dog_name,
                                const std::pair<Point, const Road*>& dog_pos) {
@@ -188,11 +209,12 @@ Dog* Game::AddDogInGameSession(const GameSession::Id& game_session_id,
 }
 
 void Game::MoveDog(const GameSession::Id& game_session_id,
-                   const Dog::Id& dog_id, const std::string& movement) {
+                   const Dog::Id& dog_id,
+                   std::optional<Direction> direction) {
   if (auto game_session = GetGameSessionById(game_session_id)) {
     auto map = GetMapById(game_session->GetMapId());
     auto dog_speed_on_map = map->GetDogSpeed();
-    game_session->MoveDog(dog_id, dog_speed_on_map, movement);
+    game_session->MoveDog(dog_id, dog_speed_on_map, direction);
 
   } else {
     throw std::invalid_argument("Game session with id "s +
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <optional>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
@@ -70,12 +71,19 @@ class Game {
   GameSession::RetiredDogs UpdateGameSession(
       const GameSession::Id& game_session_id, Milliseconds time_delta);
 
+  // Возвращает время, в течение которого обновление игровой сессии ничего не
+  // изменит, кроме времени в игре и времени простоя собак: все собаки стоят,
+  // потерянных вещей не меньше, чем собак, и никто не уходит на покой.
+  // Если сессию нужно обновлять на каждом тике, возвращает 0.
+  Milliseconds GetGameSessionIdleTime(
+      const GameSession::Id& game_session_id) const;
+
   Dog* AddDogInGameSession(const GameSession::Id& game_session_id,
                            std::string dog_name,
                            const std::pair<Point, const Road*>& dog_pos);
 
   void MoveDog(const GameSession::Id& game_session_id, const Dog::Id& dog_id,
-               const std::string& movement);
+               std::optional<Direction> direction);
 
  private:
   using MapIdHasher = util::TaggedHasher<Map::Id>;
@@ -70,6 +70,23 @@ const Dog* GameSession::GetDogByName(const std::string& dog_name) const {
 
 bool GameSession::IsEmpty() const noexcept { return dog_id_to_dog_.empty(); }
 
+bool GameSession::HasMovingDogs() const noexcept {
+  return std::any_of(dog_id_to_dog_.begin(), dog_id_to_dog_.end(),
+                     [](const auto& dog_id_and_dog) {
+                       return dog_id_and_dog.second.IsMovingNow();
+                     });
+}
+
+GameSession::Milliseconds GameSession::GetTimeUntilRetirement(
+    Milliseconds retirement_time) const noexcept {
+  auto result = Milliseconds::max();
+  for (const auto& [dog_id, dog] : dog_id_to_dog_) {
+    result = std::min(result, std::max(retirement_time - dog.GetIdleTime(),
+                                       Milliseconds::zero()));
+  }
+  return result;
+}
+
 Dog* GameSession::AddDog(std::string dog_name,
                          const std::pair<Point, const Road*>& dog_pos,
                          std::uint32_t bag_capacity) {
@@ -104,14 +121,14 @@ Dog* GameSession::LoadDog(Dog dog) {
 }
 
 void GameSession::MoveDog(const Dog::Id& dog_id, const Speed& dog_speed_on_map,
-                          const std::string& movement) {
+                          std::optional<Direction> direction) {
   if (auto dog = GetDogById(dog_id)) {
-    if (movement.empty()) {
+    if (!direction) {
       dog->SetSpeed(model::Speed(0, 0));
       dog->ResetIdleTime();
       return;
     }
-    switch (static_cast<model::Direction>(movement[0])) {
+    switch (*direction) {
       case model::Direction::kNorth:
         dog->SetDirection(model::Direction::kNorth);
         dog->SetSpeed(model::Speed(0, -dog_speed_on_map.sy));
@@ -147,17 +164,13 @@ void GameSession::AddLoot(const Map* map, std::uint32_t loot_count) {
     ++next_lost_object_id_;
     try {
       std::uint32_t num_of_loot_type = map->GenerateRandomLootType();
-      std::uint64_t value =
-          json_loader::LootTypesStorage::GetTypesOfLoots(map_id_)
-              ->at(num_of_loot_type)
-              .as_object()
-              .at("value"s)
-              .as_int64();
       LostObject lost_object(LostObject::Id(next_lost_object_id_),
                              num_of_loot_type,
                              map->GenerateRandomPosition().first,
-                             static_cast<std::uint32_t>(value));
-      loot_.push_back(lost_object);
+                             map->GetLootType(num_of_loot_type).GetValue());
+      const auto& inserted_lost_object = loot_.emplace_back(lost_object);
+      loot_index_.Insert(inserted_lost_object.GetPosition(),
+                         &inserted_lost_object);
     } catch (...) {
       --next_lost_object_id_;
       throw std::runtime_error("Failed to add lost object with id == "s +
@@ -175,6 +188,8 @@ LostObject* GameSession::LoadLostObject(const LostObject& lost_object) {
   std::uint32_t temp_next_lost_object_id = next_lost_object_id_;
   try {
     auto& inserted_lost_object = loot_.emplace_back(lost_object);
+    loot_index_.Insert(inserted_lost_object.GetPosition(),
+                       &inserted_lost_object);
     next_lost_object_id_ = std::max(next_lost_object_id_, *lost_object.GetId());
     return &inserted_lost_object;
   } catch (...) {
@@ -195,23 +210,41 @@ GameSession::RetiredDogs GameSession::UpdateSession(const Map* map,
                                                     std::uint32_t loot_count,
                                                     Milliseconds time_delta) {
   using namespace std::chrono;
-  AddLoot(map, loot_count);
+  using util::TickPhase;
+  using PhaseTimer = util::TickProfiler::PhaseTimer;
+  {
+    PhaseTimer timer(TickPhase::kLootGeneration);
+    AddLoot(map, loot_count);
+  }
   RetiredDogs retired_dogs;
-  for (auto& [dog_id, dog] : dog_id_to_dog_) {
-    dog.AddTimeInGame(time_delta);
-    if (!dog.IsMovingNow()) {
-      dog.AddIdleTime(time_delta);
-      if (dog.GetIdleTime() >= map->GetDogRetirementTime()) {
-        retired_dogs.emplace_back(dog_id, dog.GetName(), dog.GetScore(),
-                                  dog.GetTimeInGame(), id_);
+  {
+    PhaseTimer timer(TickPhase::kMovement);
+    for (auto& [dog_id, dog] : dog_id_to_dog_) {
+      dog.AddTimeInGame(time_delta);
+      if (!dog.IsMovingNow()) {
+        dog.AddIdleTime(time_delta);
+        if (dog.GetIdleTime() >= map->GetDogRetirementTime()) {
+          retired_dogs.emplace_back(dog_id, dog.GetName(), dog.GetScore(),
+                                    dog.GetTimeInGame(), id_);
+        }
+      } else {
+        dog.UpdatePosition(map, time_delta);
       }
-    } else {
-      dog.UpdatePosition(map, time_delta);
     }
   }
-  DeleteRetiredDogs(retired_dogs);
-  auto events = FindCollisionEvents(map->GetOffices());
-  HandleCollisions(events);
+  {
+    PhaseTimer timer(TickPhase::kRetirement);
+    DeleteRetiredDogs(retired_dogs);
+  }
+  CollisionEvents events;
+  {
+    PhaseTimer timer(TickPhase::kFindCollisions);
+    events = FindCollisionEvents(map->GetOffices());
+  }
+  {
+    PhaseTimer timer(TickPhase::kHandleCollisions);
+    HandleCollisions(events);
+  }
   return retired_dogs;
 }
 
@@ -278,6 +311,8 @@ void GameSession::HandleCollisions(const GameSession::CollisionEvents& events) {
         !event.lost_object_ptr->IsCollected()) {
       if (dog->PutInBag(*event.lost_object_ptr)) {
         event.lost_object_ptr->Collect();
+        loot_index_.Remove(event.lost_object_pos->GetPosition(),
+                           &*event.lost_object_pos);
         loot_.erase(event.lost_object_pos);
       }
     } else if (event.type == CollisionEventType::kPass) {
@@ -3,15 +3,17 @@
 #include <algorithm>
 #include <chrono>
 #include <list>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
-#include "../json_loader/loot_types_storage.h"
 #include "../util/tagged.h"
+#include "../util/tick_profiler.h"
 #include "collision_detector.h"
 #include "dog.h"
 #include "map.h"
+#include "spatial_index.h"
 
 namespace model {
 
@@ -38,7 +40,16 @@ class GameSession {
   using Milliseconds = std::chrono::milliseconds;
   using Clock = std::chrono::steady_clock;
 
+  // Размер ячейки индекса потерянных вещей.
+  static constexpr Dimension kLootIndexCellSize = 8.0;
+
   explicit GameSession(Id id, std::string name, Map::Id map_id);
+  // Индекс потерянных вещей хранит указатели на элементы loot_. При
+  // перемещении std::list они остаются валидными, при копировании - нет.
+  GameSession(const GameSession&) = delete;
+  GameSession& operator=(const GameSession&) = delete;
+  GameSession(GameSession&&) = default;
+  GameSession& operator=(GameSession&&) = default;
 
   const Id& GetId() const noexcept;
 
@@ -60,6 +71,14 @@ class GameSession {
   // Если в игре нет собак, возвращает true.
   bool IsEmpty() const noexcept;
 
+  // Если хотя бы одна собака движется, возвращает true.
+  bool HasMovingDogs() const noexcept;
+
+  // Возвращает время, через которое первая из стоящих собак уйдет на покой.
+  // Если собак нет, возвращает Milliseconds::max().
+  Milliseconds GetTimeUntilRetirement(
+      Milliseconds retirement_time) const noexcept;
+
   // Конструирует нового игрового персонажа и возвращает указатель на него.
   Dog* AddDog(std::string dog_name,
               const std::pair<Point, const Road*>& dog_pos,
@@ -68,13 +87,25 @@ class GameSession {
   // Добавляет уже сконструированного персонажа, взятого из файла сохранения.
   Dog* LoadDog(Dog dog);
 
+  // Направляет собаку в сторону direction. Пустое направление останавливает
+  // собаку.
   void MoveDog(const Dog::Id& dog_id, const Speed& dog_speed_on_map,
-               const std::string& movement);
+               std::optional<Direction> direction);
 
   const Loot& GetLoot() const noexcept;
 
   std::uint32_t GetLootCount() const noexcept;
 
+  // Вызывает fn(const LostObject&) для каждой потерянной вещи, находящейся на
+  // расстоянии не больше radius от center.
+  template <typename Fn>
+  void ForEachLootInRadius(const Point& center, Dimension radius,
+                           Fn&& fn) const {
+    loot_index_.ForEachInRadius(
+        center, radius,
+        [&fn](const LostObject* lost_object) { fn(*lost_object); });
+  }
+
   //  Генерирует loot_count потерянных объектов.
   //  В качестве входных данным передаем Map*, чтобы получить доступ к
   //  генератору типа потерянного объекта.
@@ -108,6 +139,7 @@ class GameSession {
   DogIdToDog dog_id_to_dog_;
   std::uint32_t next_dog_id_ = 0;
   Loot loot_;
+  SpatialIndex<LostObject> loot_index_{kLootIndexCellSize};
   std::uint32_t next_lost_object_id_ = 0;
 };
 
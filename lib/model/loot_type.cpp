@@ -0,0 +1,14 @@
+#include "loot_type.h"
+
+namespace model {
+
+LootType::LootType(std::uint32_t value, std::string json_fragment) noexcept
+    : value_(value), json_fragment_(std::move(json_fragment)) {}
+
+std::uint32_t LootType::GetValue() const noexcept { return value_; }
+
+const std::string& LootType::GetJsonFragment() const noexcept {
+  return json_fragment_;
+}
+
+}  // namespace model
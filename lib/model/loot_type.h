@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace model {
+
+// Описывает тип потерянного предмета на карте. Хранит ценность предмета и
+// заранее сериализованное JSON-описание типа, необходимое фронтенду (для
+// отрисовки объектов и тд.).
+class LootType {
+ public:
+  explicit LootType(std::uint32_t value, std::string json_fragment) noexcept;
+
+  std::uint32_t GetValue() const noexcept;
+
+  const std::string& GetJsonFragment() const noexcept;
+
+ private:
+  std::uint32_t value_ = 0;
+  std::string json_fragment_;
+};
+
+}  // namespace model
@@ -3,12 +3,10 @@
 namespace model {
 
 Map::Map(Map::Id id, std::string name, const Speed& dog_speed,
-         std::uint32_t num_of_loot_types, std::uint32_t bag_capacity,
-         Milliseconds dog_retirement_time)
+         std::uint32_t bag_capacity, Milliseconds dog_retirement_time)
     : id_(std::move(id)),
       name_(std::move(name)),
       dog_speed_(dog_speed),
-      num_of_loot_types_(num_of_loot_types),
       bag_capacity_(bag_capacity),
       dog_retirement_time_(dog_retirement_time) {}
 
@@ -22,6 +20,12 @@ const Map::Buildings& Map::GetBuildings() const noexcept { return buildings_; }
 
 const Map::Offices& Map::GetOffices() const noexcept { return offices_; }
 
+const Map::LootTypes& Map::GetLootTypes() const noexcept { return loot_types_; }
+
+const LootType& Map::GetLootType(std::uint32_t type) const {
+  return loot_types_.at(type);
+}
+
 Speed Map::GetDogSpeed() const noexcept { return dog_speed_; }
 
 Map::Milliseconds Map::GetDogRetirementTime() const noexcept {
@@ -179,6 +183,10 @@ void Map::AddOffice(Office office) {
   }
 }
 
+void Map::AddLootType(LootType loot_type) {
+  loot_types_.push_back(std::move(loot_type));
+}
+
 std::pair<Point, const Road*> Map::GenerateRandomPosition(
     bool randomize_spawn_position) const {
   if (randomize_spawn_position) {
@@ -202,7 +210,7 @@ std::pair<Point, const Road*> Map::GenerateRandomPosition(
 
 std::uint32_t Map::GenerateRandomLootType() const {
   std::uniform_int_distribution<std::uint32_t> type_distrib(
-      0, num_of_loot_types_ - 1);
+      0, static_cast<std::uint32_t>(loot_types_.size()) - 1);
   return type_distrib(random_engine_);
 }
 
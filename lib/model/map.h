@@ -10,6 +10,7 @@
 #include "../util/tagged.h"
 #include "building.h"
 #include "geometry.h"
+#include "loot_type.h"
 #include "office.h"
 #include "road.h"
 
@@ -21,11 +22,11 @@ class Map {
   using Roads = std::vector<Road>;
   using Buildings = std::vector<Building>;
   using Offices = std::vector<Office>;
+  using LootTypes = std::vector<LootType>;
   using Milliseconds = std::chrono::milliseconds;
 
   Map(Id id, std::string name, const Speed& dog_speed,
-      std::uint32_t num_of_loot_types, std::uint32_t bag_capacity,
-      Milliseconds dog_retirement_time);
+      std::uint32_t bag_capacity, Milliseconds dog_retirement_time);
 
   const Id& GetId() const noexcept;
 
@@ -37,6 +38,12 @@ class Map {
 
   const Offices& GetOffices() const noexcept;
 
+  const LootTypes& GetLootTypes() const noexcept;
+
+  // Возвращает тип потерянного предмета по его индексу. Индекс должен быть
+  // получен из GenerateRandomLootType или проверен заранее.
+  const LootType& GetLootType(std::uint32_t type) const;
+
   Speed GetDogSpeed() const noexcept;
 
   Milliseconds GetDogRetirementTime() const noexcept;
@@ -54,6 +61,8 @@ class Map {
 
   void AddOffice(Office office);
 
+  void AddLootType(LootType loot_type);
+
   // Генерирует рандомную позицию с помощью генератора псевдослучайных чисел.
   // randomize_spawn_position == false - возвращает начало первой дороги на
   //                                     карте.
@@ -87,7 +96,7 @@ class Map {
   Buildings buildings_;
   OfficeIdToIndex warehouse_id_to_index_;
   Offices offices_;
-  std::uint32_t num_of_loot_types_ = 1;
+  LootTypes loot_types_;
   std::uint32_t bag_capacity_;
 
   // Генератор псевдослучайных чисел, который будет использоваться в
@@ -10,6 +10,7 @@
 #include "game_session.h"
 #include "geometry.h"
 #include "loot_generator.h"
+#include "loot_type.h"
 #include "lost_object.h"
 #include "map.h"
 #include "office.h"
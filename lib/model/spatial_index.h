@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "geometry.h"
+
+namespace model {
+
+// Равномерная сетка для быстрого поиска объектов рядом с точкой.
+// Хранит указатели на объекты, поэтому объекты не должны перемещаться в
+// памяти, пока находятся в индексе. Перемещение объекта - это Remove со
+// старой позицией и Insert с новой.
+template <typename T>
+class SpatialIndex {
+ public:
+  explicit SpatialIndex(Dimension cell_size) : cell_size_(cell_size) {}
+
+  void Insert(const Point& pos, const T* item) {
+    cells_[GetCellKey(ToCell(pos.x), ToCell(pos.y))].push_back({pos, item});
+  }
+
+  // Удаляет объект, добавленный с позицией pos. Если его нет, ничего не
+  // делает.
+  void Remove(const Point& pos, const T* item) {
+    auto it = cells_.find(GetCellKey(ToCell(pos.x), ToCell(pos.y)));
+    if (it == cells_.end()) {
+      return;
+    }
+    auto& entries = it->second;
+    auto entry = std::find_if(entries.begin(), entries.end(),
+                              [item](const auto& e) { return e.item == item; });
+    if (entry != entries.end()) {
+      *entry = entries.back();
+      entries.pop_back();
+    }
+  }
+
+  // Вызывает fn(item) для каждого объекта, находящегося на расстоянии не
+  // больше radius от center. Порядок обхода не определен.
+  template <typename Fn>
+  void ForEachInRadius(const Point& center, Dimension radius, Fn&& fn) const {
+    auto visit = [&](const std::vector<Entry>& entries) {
+      for (const auto& entry : entries) {
+        auto dx = entry.pos.x - center.x;
+        auto dy = entry.pos.y - center.y;
+        if (dx * dx + dy * dy <= radius * radius) {
+          fn(entry.item);
+        }
+      }
+    };
+    // Если радиус накрывает больше ячеек, чем занято, дешевле обойти все
+    // занятые ячейки.
+    auto cells_per_side = 2 * radius / cell_size_ + 2;
+    if (cells_per_side * cells_per_side >
+        static_cast<double>(cells_.size())) {
+      for (const auto& [key, entries] : cells_) {
+        visit(entries);
+      }
+      return;
+    }
+    auto max_x = ToCell(center.x + radius);
+    auto max_y = ToCell(center.y + radius);
+    for (auto x = ToCell(center.x - radius); x <= max_x; ++x) {
+      for (auto y = ToCell(center.y - radius); y <= max_y; ++y) {
+        if (auto it = cells_.find(GetCellKey(x, y)); it != cells_.end()) {
+          visit(it->second);
+        }
+      }
+    }
+  }
+
+ private:
+  struct Entry {
+    Point pos;
+    const T* item;
+  };
+
+  std::int32_t ToCell(Coord coord) const noexcept {
+    return static_cast<std::int32_t>(std::floor(coord / cell_size_));
+  }
+
+  static std::uint64_t GetCellKey(std::int32_t x, std::int32_t y) noexcept {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) |
+           static_cast<std::uint32_t>(y);
+  }
+
+  Dimension cell_size_;
+  std::unordered_map<std::uint64_t, std::vector<Entry>> cells_;
+};
+
+}  // namespace model
@@ -0,0 +1,161 @@
+#include "compression.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace util {
+
+namespace zlib = boost::beast::zlib;
+
+namespace {
+
+// Сжимает данные алгоритмом deflate без заголовков и дописывает результат в
+// конец out.
+// Состояние компрессора (окно и хеш-таблицы, около 256 КиБ) выделяется один
+// раз на поток и переиспользуется: reset только сбрасывает его.
+void RawDeflate(std::string_view data, int level, std::string& out) {
+  thread_local zlib::deflate_stream stream;
+  stream.reset(level, 15, 8, zlib::Strategy::normal);
+
+  const std::size_t offset = out.size();
+  out.resize(offset + stream.upper_bound(data.size()));
+
+  zlib::z_params params;
+  params.next_in = data.data();
+  params.avail_in = data.size();
+  params.next_out = out.data() + offset;
+  params.avail_out = out.size() - offset;
+
+  boost::system::error_code ec;
+  stream.write(params, zlib::Flush::finish, ec);
+  if (ec && ec != zlib::error::end_of_stream) {
+    throw std::runtime_error("Failed to compress data: "s + ec.message());
+  }
+  out.resize(offset + params.total_out);
+}
+
+std::uint32_t Adler32(std::string_view data) noexcept {
+  constexpr std::uint32_t kModAdler = 65521;
+  // Максимальное число байт, после которого нужно брать остаток, чтобы
+  // избежать переполнения.
+  constexpr std::size_t kMaxBlock = 5552;
+  std::uint32_t a = 1;
+  std::uint32_t b = 0;
+  while (!data.empty()) {
+    auto block = data.substr(0, kMaxBlock);
+    for (unsigned char c : block) {
+      a += c;
+      b += a;
+    }
+    a %= kModAdler;
+    b %= kModAdler;
+    data.remove_prefix(block.size());
+  }
+  return (b << 16) | a;
+}
+
+void AppendLittleEndian(std::string& out, std::uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+void AppendBigEndian(std::string& out, std::uint32_t value) {
+  for (int i = 3; i >= 0; --i) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+// Возвращает вес кодировки из элемента Accept-Encoding вида "gzip;q=0.5".
+double GetQuality(std::string_view params) {
+  auto q_pos = params.find("q="sv);
+  if (q_pos == std::string_view::npos) {
+    return 1.0;
+  }
+  try {
+    return std::stod(std::string(params.substr(q_pos + 2)));
+  } catch (...) {
+    return 0.0;
+  }
+}
+
+std::string_view Trim(std::string_view str) {
+  while (!str.empty() && (str.front() == ' ' || str.front() == '\t')) {
+    str.remove_prefix(1);
+  }
+  while (!str.empty() && (str.back() == ' ' || str.back() == '\t')) {
+    str.remove_suffix(1);
+  }
+  return str;
+}
+
+}  // namespace
+
+std::string_view ToString(ContentEncoding encoding) noexcept {
+  switch (encoding) {
+    case ContentEncoding::kGzip:
+      return "gzip"sv;
+    case ContentEncoding::kDeflate:
+      return "deflate"sv;
+    default:
+      return ""sv;
+  }
+}
+
+ContentEncoding NegotiateContentEncoding(std::string_view accept_encoding) {
+  double gzip_quality = 0.0;
+  double deflate_quality = 0.0;
+  while (!accept_encoding.empty()) {
+    auto comma_pos = accept_encoding.find(',');
+    auto item = accept_encoding.substr(0, comma_pos);
+    accept_encoding.remove_prefix(comma_pos == std::string_view::npos
+                                      ? accept_encoding.size()
+                                      : comma_pos + 1);
+
+    auto params_pos = item.find(';');
+    auto coding = Trim(item.substr(0, params_pos));
+    double quality = params_pos == std::string_view::npos
+                         ? 1.0
+                         : GetQuality(item.substr(params_pos + 1));
+    if (coding == "gzip"sv || coding == "x-gzip"sv) {
+      gzip_quality = quality;
+    } else if (coding == "deflate"sv) {
+      deflate_quality = quality;
+    } else if (coding == "*"sv) {
+      gzip_quality = std::max(gzip_quality, quality);
+    }
+  }
+  if (gzip_quality > 0.0 && gzip_quality >= deflate_quality) {
+    return ContentEncoding::kGzip;
+  }
+  if (deflate_quality > 0.0) {
+    return ContentEncoding::kDeflate;
+  }
+  return ContentEncoding::kIdentity;
+}
+
+// Формат gzip: 10 байт заголовка, сжатые данные, CRC-32 и размер исходных
+// данных (оба в little-endian).
+std::string GzipCompress(std::string_view data, int level) {
+  std::string result("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff"sv);
+  RawDeflate(data, level, result);
+  AppendLittleEndian(result, Crc32(data));
+  AppendLittleEndian(result, static_cast<std::uint32_t>(data.size()));
+  return result;
+}
+
+// Формат zlib: 2 байта заголовка, сжатые данные и Adler-32 (в big-endian).
+std::string DeflateCompress(std::string_view data, int level) {
+  std::string result("\x78\x9c"sv);
+  RawDeflate(data, level, result);
+  AppendBigEndian(result, Adler32(data));
+  return result;
+}
+
+std::uint32_t Crc32(std::string_view data) noexcept {
+  boost::crc_32_type crc;
+  crc.process_bytes(data.data(), data.size());
+  return crc.checksum();
+}
+
+}  // namespace util
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <boost/beast/zlib.hpp>
+#include <boost/crc.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace util {
+
+using namespace std::literals;
+
+// Кодировки тела HTTP-ответа, которые умеет формировать сервер.
+enum class ContentEncoding { kIdentity, kGzip, kDeflate };
+
+// Возвращает значение заголовка Content-Encoding для кодировки (для
+// kIdentity - пустую строку).
+std::string_view ToString(ContentEncoding encoding) noexcept;
+
+// Выбирает кодировку ответа по значению заголовка Accept-Encoding.
+// Предпочтение отдается gzip, затем deflate. Кодировки с q=0 не выбираются.
+ContentEncoding NegotiateContentEncoding(std::string_view accept_encoding);
+
+// Сжимает данные в формате gzip (RFC 1952).
+std::string GzipCompress(std::string_view data, int level = 6);
+
+// Сжимает данные в формате zlib (RFC 1950), который в HTTP называется
+// deflate.
+std::string DeflateCompress(std::string_view data, int level = 6);
+
+// Вычисляет контрольную сумму CRC-32 данных.
+std::uint32_t Crc32(std::string_view data) noexcept;
+
+}  // namespace util
@@ -0,0 +1,89 @@
+#include "io_context_pool.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace util {
+
+namespace {
+
+// Возвращает номера ядер, на которых процессу разрешено выполняться
+// (с учетом taskset, cgroups и тд.). Пустой список, если набор ядер
+// определить не удалось.
+std::vector<unsigned> GetAllowedCores() {
+  std::vector<unsigned> cores;
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+    for (unsigned core = 0; core < CPU_SETSIZE; ++core) {
+      if (CPU_ISSET(core, &cpu_set)) {
+        cores.push_back(core);
+      }
+    }
+  }
+#endif
+  return cores;
+}
+
+// Закрепляет поток thread за ядром core. Возвращает false, если закрепить не
+// удалось: тогда поток продолжает работать на любом разрешенном ядре.
+bool PinThread([[maybe_unused]] std::jthread& thread,
+               [[maybe_unused]] unsigned core) noexcept {
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(core, &cpu_set);
+  return pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set),
+                                &cpu_set) == 0;
+#else
+  return false;
+#endif
+}
+
+}  // namespace
+
+IoContextPool::IoContextPool(std::size_t size) {
+  contexts_.reserve(size);
+  work_guards_.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    // Подсказка 1 сообщает io_context, что его обслуживает один поток.
+    contexts_.push_back(std::make_unique<net::io_context>(1));
+    work_guards_.push_back(net::make_work_guard(*contexts_.back()));
+  }
+}
+
+IoContextPool::~IoContextPool() { Stop(); }
+
+std::size_t IoContextPool::GetSize() const noexcept { return contexts_.size(); }
+
+net::io_context& IoContextPool::GetIoContext(std::size_t index) noexcept {
+  return *contexts_[index];
+}
+
+std::size_t IoContextPool::Start(bool pin_threads) {
+  const auto cores = pin_threads ? GetAllowedCores() : std::vector<unsigned>{};
+  std::size_t num_of_unpinned = 0;
+  threads_.reserve(contexts_.size());
+  for (std::size_t i = 0; i < contexts_.size(); ++i) {
+    threads_.emplace_back([this, i] { contexts_[i]->run(); });
+    if (!pin_threads) {
+      continue;
+    }
+    if (cores.empty() || !PinThread(threads_.back(), cores[i % cores.size()])) {
+      ++num_of_unpinned;
+    }
+  }
+  return num_of_unpinned;
+}
+
+void IoContextPool::Stop() {
+  work_guards_.clear();
+  threads_.clear();
+}
+
+}  // namespace util
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+namespace net = boost::asio;
+
+// Набор io_context, каждый из которых обслуживается одним потоком. Поток
+// может быть закреплен за своим ядром процессора. Используется для
+// шардирования: работа, привязанная к одному io_context, всегда выполняется
+// на одном ядре, и ее данные не переходят между кешами ядер.
+class IoContextPool {
+ public:
+  explicit IoContextPool(std::size_t size);
+  IoContextPool(const IoContextPool&) = delete;
+  IoContextPool& operator=(const IoContextPool&) = delete;
+  ~IoContextPool();
+
+  std::size_t GetSize() const noexcept;
+
+  net::io_context& GetIoContext(std::size_t index) noexcept;
+
+  // Запускает по потоку на каждый io_context. Если pin_threads == true,
+  // поток io_context с номером i закрепляется за i-м по счету (по модулю их
+  // числа) ядром из набора, разрешенного процессу. Возвращает число потоков,
+  // которые закрепить не удалось.
+  std::size_t Start(bool pin_threads);
+
+  // Дожидается выполнения уже поставленных задач и завершает потоки.
+  void Stop();
+
+ private:
+  using WorkGuard = net::executor_work_guard<net::io_context::executor_type>;
+
+  std::vector<std::unique_ptr<net::io_context>> contexts_;
+  std::vector<WorkGuard> work_guards_;
+  std::vector<std::jthread> threads_;
+};
+
+}  // namespace util
@@ -12,13 +12,81 @@ namespace util {
                               po::value(&args.www_root)->value_name("dir"),
                               "set static files root")(
       "tick-period,t", po::value(&args.tick_period)->value_name("milliseconds"),
-      "set tick period")("randomize-spawn-points",
+      "set tick period")(
+      "tick-mode",
+      po::value(&args.tick_mode)->value_name("fixed-rate|fixed-delay"),
+      "set tick scheduling mode")("randomize-spawn-points",
                          "spawn dogs at random positions")(
       "state-file", po::value(&args.state_file)->value_name("file"),
       "set path to save file")(
       "save-state-period",
       po::value(&args.save_state_period)->value_name("milliseconds"),
-      "set save state period");
+      "set save state period")(
+      "static-cache-size",
+      po::value(&args.static_cache_size)->value_name("bytes"),
+      "set memory budget for cached static files")(
+      "log-queue-size",
+      po::value(&args.log_queue_size)->value_name("records"),
+      "set async log queue size, 0 disables async logging")(
+      "log-overflow-policy",
+      po::value(&args.log_overflow_policy)->value_name("drop|block"),
+      "set behaviour when async log queue is full")(
+      "log-level",
+      po::value(&args.log_level)
+          ->value_name("debug|info|warning|error|off"),
+      "set minimal level of logged messages")(
+      "log-sampling",
+      po::value(&args.log_sampling)->value_name("event=rate,..."),
+      "set share of logged request, response, error and server messages")(
+      "admin-token", po::value(&args.admin_token)->value_name("token"),
+      "enable admin endpoints authorized with this bearer token")(
+      "game-shards", po::value(&args.game_shards)->value_name("count"),
+      "spread game sessions over count pinned single-thread io_contexts")(
+      "view-radius", po::value(&args.view_radius)->value_name("distance"),
+      "send each player only dogs and loot within distance of their dog")(
+      "compression-threshold",
+      po::value(&args.compression_threshold)->value_name("bytes"),
+      "compress API responses of at least bytes size (default 1024)")(
+      "max-connections", po::value(&args.max_connections)->value_name("count"),
+      "answer 503 to connections over count open ones")(
+      "max-connections-per-ip",
+      po::value(&args.max_connections_per_ip)->value_name("count"),
+      "answer 429 to connections over count open ones from one IP")(
+      "rate-limit", po::value(&args.rate_limit)->value_name("requests/s"),
+      "answer 429 to requests from one IP over this rate")(
+      "rate-limit-burst",
+      po::value(&args.rate_limit_burst)->value_name("requests"),
+      "set number of requests allowed at once over the rate limit")(
+      "address", po::value(&args.address)->value_name("ip"),
+      "set address to listen on (default 0.0.0.0)")(
+      "port", po::value(&args.port)->value_name("port"),
+      "set port to listen on (default 8080)")(
+      "acceptors", po::value(&args.acceptors)->value_name("count"),
+      "accept connections on count SO_REUSEPORT sockets")(
+      "listen-backlog", po::value(&args.listen_backlog)->value_name("count"),
+      "set queue size of pending connections")(
+      "tcp-nodelay", "disable Nagle's algorithm on connections")(
+      "socket-send-buffer",
+      po::value(&args.socket_send_buffer)->value_name("bytes"),
+      "set SO_SNDBUF of connections")(
+      "socket-receive-buffer",
+      po::value(&args.socket_receive_buffer)->value_name("bytes"),
+      "set SO_RCVBUF of connections")(
+      "idle-timeout",
+      po::value(&args.idle_timeout)->value_name("milliseconds"),
+      "close connections waiting for a request longer (default 30000)")(
+      "header-timeout",
+      po::value(&args.header_timeout)->value_name("milliseconds"),
+      "set time limit for reading request headers (default 10000)")(
+      "body-timeout",
+      po::value(&args.body_timeout)->value_name("milliseconds"),
+      "set time limit for reading request body (default 30000)")(
+      "response-timeout",
+      po::value(&args.response_timeout)->value_name("milliseconds"),
+      "set time limit for handling and sending response (default 30000)")(
+      "max-requests-per-connection",
+      po::value(&args.max_requests_per_connection)->value_name("count"),
+      "close connections after count requests");
 
   po::variables_map vm;
   po::store(po::parse_command_line(argc, argv, description), vm);
@@ -37,9 +105,24 @@ namespace util {
     throw std::runtime_error("www-root has been not specified"s);
   }
 
+  if (!args.log_overflow_policy.empty() &&
+      args.log_overflow_policy != "drop"s &&
+      args.log_overflow_policy != "block"s) {
+    throw std::runtime_error("log-overflow-policy must be drop or block"s);
+  }
+
+  if (!args.tick_mode.empty() && args.tick_mode != "fixed-rate"s &&
+      args.tick_mode != "fixed-delay"s) {
+    throw std::runtime_error("tick-mode must be fixed-rate or fixed-delay"s);
+  }
+
   if (vm.contains("randomize-spawn-points"s)) {
     args.randomize_spawn_points = true;
   }
+
+  if (vm.contains("tcp-nodelay"s)) {
+    args.tcp_nodelay = true;
+  }
   return args;
 }
 
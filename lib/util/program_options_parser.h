@@ -19,8 +19,34 @@ struct Args {
   std::string www_root;
   bool randomize_spawn_points = false;
   std::string tick_period;
+  std::string tick_mode;
   std::string state_file;
   std::string save_state_period;
+  std::string static_cache_size;
+  std::string log_queue_size;
+  std::string log_overflow_policy;
+  std::string log_level;
+  std::string log_sampling;
+  std::string admin_token;
+  std::string game_shards;
+  std::string view_radius;
+  std::string compression_threshold;
+  std::string max_connections;
+  std::string max_connections_per_ip;
+  std::string rate_limit;
+  std::string rate_limit_burst;
+  std::string address;
+  std::string port;
+  std::string acceptors;
+  std::string listen_backlog;
+  bool tcp_nodelay = false;
+  std::string socket_send_buffer;
+  std::string socket_receive_buffer;
+  std::string idle_timeout;
+  std::string header_timeout;
+  std::string body_timeout;
+  std::string response_timeout;
+  std::string max_requests_per_connection;
 };
 
 // Считывает параметры командой строки
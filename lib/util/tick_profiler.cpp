@@ -0,0 +1,215 @@
+#include "tick_profiler.h"
+
+#include <algorithm>
+
+namespace util {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::array<std::string_view, kNumOfTickPhases> kTickPhaseNames{
+    "lootGeneration"sv, "movement"sv,       "retirement"sv,
+    "findCollisions"sv, "handleCollisions"sv, "playersCleanup"sv,
+    "saveRetiredPlayers"sv};
+
+// Профилируемый тик текущего потока.
+thread_local TickProfiler::SessionScope* current_scope = nullptr;
+
+// Возвращает небольшой номер текущего потока для trace-событий.
+std::uint32_t GetThreadIndex() noexcept {
+  static std::atomic<std::uint32_t> next_index{0};
+  thread_local std::uint32_t index = next_index.fetch_add(1);
+  return index;
+}
+
+std::uint64_t ToNanoseconds(TickProfiler::Clock::duration duration) noexcept {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+double ToMilliseconds(std::uint64_t nanoseconds) noexcept {
+  return static_cast<double>(nanoseconds) / 1e6;
+}
+
+}  // namespace
+
+std::string_view ToString(TickPhase phase) noexcept {
+  return kTickPhaseNames[static_cast<std::size_t>(phase)];
+}
+
+TickProfiler::PhaseTimer::PhaseTimer(TickPhase phase) noexcept
+    : scope_(current_scope), phase_(phase) {
+  if (scope_) {
+    start_ = Clock::now();
+  }
+}
+
+TickProfiler::PhaseTimer::~PhaseTimer() {
+  if (scope_) {
+    scope_->AddPhase(phase_, start_, Clock::now());
+  }
+}
+
+void TickProfiler::Window::Add(std::uint64_t duration) noexcept {
+  auto index = count.load(std::memory_order_relaxed);
+  durations[index % kWindowSize].store(duration, std::memory_order_relaxed);
+  count.store(index + 1, std::memory_order_release);
+}
+
+json::object TickProfiler::Window::GetSummary() const {
+  auto total_count = count.load(std::memory_order_acquire);
+  std::vector<std::uint64_t> values(std::min(total_count, kWindowSize));
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    values[i] = durations[i].load(std::memory_order_relaxed);
+  }
+  std::sort(values.begin(), values.end());
+  auto percentile = [&values](double p) {
+    if (values.empty()) {
+      return 0.0;
+    }
+    auto index = static_cast<std::size_t>(p * (values.size() - 1));
+    return ToMilliseconds(values[index]);
+  };
+  json::object summary;
+  summary["count"s] = total_count;
+  summary["p50"s] = percentile(0.5);
+  summary["p90"s] = percentile(0.9);
+  summary["p99"s] = percentile(0.99);
+  summary["max"s] = percentile(1);
+  return summary;
+}
+
+TickProfiler::SessionScope::SessionScope(TickProfiler& profiler,
+                                         std::uint64_t session_id)
+    : profiler_(profiler),
+      session_id_(session_id),
+      stats_(profiler.GetSessionStats(session_id)),
+      previous_scope_(std::exchange(current_scope, this)),
+      start_(Clock::now()) {}
+
+TickProfiler::SessionScope::~SessionScope() {
+  auto end = Clock::now();
+  current_scope = previous_scope_;
+  stats_.total.Add(ToNanoseconds(end - start_));
+  for (std::size_t i = 0; i < kNumOfTickPhases; ++i) {
+    if (is_phase_measured_[i]) {
+      stats_.phases[i].Add(phase_durations_[i]);
+    }
+  }
+  profiler_.AddTraceEvent("tick"sv, session_id_, start_, end);
+}
+
+void TickProfiler::SessionScope::AddPhase(TickPhase phase,
+                                          Clock::time_point start,
+                                          Clock::time_point end) noexcept {
+  auto index = static_cast<std::size_t>(phase);
+  phase_durations_[index] += ToNanoseconds(end - start);
+  is_phase_measured_[index] = true;
+  profiler_.AddTraceEvent(ToString(phase), session_id_, start, end);
+}
+
+TickProfiler::TickProfiler() : start_(Clock::now()) {}
+
+void TickProfiler::RemoveSession(std::uint64_t session_id) {
+  std::unique_lock lock(sessions_mutex_);
+  sessions_.erase(session_id);
+}
+
+void TickProfiler::SetTracing(bool is_enabled) {
+  std::lock_guard lock(trace_mutex_);
+  if (is_enabled && !is_tracing_) {
+    trace_events_.clear();
+    trace_events_.reserve(kMaxTraceEvents);
+    next_trace_event_ = 0;
+  }
+  is_tracing_ = is_enabled;
+}
+
+bool TickProfiler::IsTracing() const noexcept {
+  return is_tracing_.load(std::memory_order_relaxed);
+}
+
+json::value TickProfiler::GetSummary() const {
+  json::object sessions;
+  {
+    std::shared_lock lock(sessions_mutex_);
+    for (const auto& [session_id, stats] : sessions_) {
+      json::object phases;
+      for (std::size_t i = 0; i < kNumOfTickPhases; ++i) {
+        phases[ToString(static_cast<TickPhase>(i))] =
+            stats->phases[i].GetSummary();
+      }
+      json::object session;
+      session["tick"s] = stats->total.GetSummary();
+      session["phases"s] = std::move(phases);
+      sessions[std::to_string(session_id)] = std::move(session);
+    }
+  }
+  json::object summary;
+  summary["tracing"s] = IsTracing();
+  summary["sessions"s] = std::move(sessions);
+  return summary;
+}
+
+std::string TickProfiler::GetChromeTrace() const {
+  using namespace std::chrono;
+  json::array events;
+  {
+    std::lock_guard lock(trace_mutex_);
+    events.reserve(trace_events_.size());
+    // Если буфер заполнен, самое старое событие лежит на месте следующего.
+    for (std::size_t i = 0; i < trace_events_.size(); ++i) {
+      const auto& event =
+          trace_events_[(next_trace_event_ + i) % trace_events_.size()];
+      events.push_back(json::object{
+          {"name"s, event.name},
+          {"cat"s, "tick"s},
+          {"ph"s, "X"s},
+          {"ts"s, duration<double, std::micro>(event.start - start_).count()},
+          {"dur"s, duration<double, std::micro>(event.duration).count()},
+          {"pid"s, 1},
+          {"tid"s, event.thread_index},
+          {"args"s, json::object{{"session"s, event.session_id}}}});
+    }
+  }
+  return json::serialize(json::object{{"traceEvents"s, std::move(events)},
+                                      {"displayTimeUnit"s, "ms"s}});
+}
+
+TickProfiler::SessionStats& TickProfiler::GetSessionStats(
+    std::uint64_t session_id) {
+  {
+    std::shared_lock lock(sessions_mutex_);
+    if (auto it = sessions_.find(session_id); it != sessions_.end()) {
+      return *it->second;
+    }
+  }
+  std::unique_lock lock(sessions_mutex_);
+  auto& stats = sessions_[session_id];
+  if (!stats) {
+    stats = std::make_unique<SessionStats>();
+  }
+  return *stats;
+}
+
+void TickProfiler::AddTraceEvent(std::string_view name,
+                                 std::uint64_t session_id,
+                                 Clock::time_point start,
+                                 Clock::time_point end) noexcept {
+  if (!IsTracing()) {
+    return;
+  }
+  TraceEvent event{name, session_id, GetThreadIndex(), start, end - start};
+  std::lock_guard lock(trace_mutex_);
+  // Место под kMaxTraceEvents событий выделено в SetTracing, поэтому
+  // push_back не перераспределяет память и не бросает исключений.
+  if (trace_events_.size() < kMaxTraceEvents) {
+    trace_events_.push_back(event);
+  } else {
+    trace_events_[next_trace_event_] = event;
+    next_trace_event_ = (next_trace_event_ + 1) % kMaxTraceEvents;
+  }
+}
+
+}  // namespace util
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <boost/json.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace util {
+
+namespace json = boost::json;
+
+// Фазы обновления игровой сессии за один тик.
+enum class TickPhase : std::uint8_t {
+  // Добавление потерянных вещей (GameSession::AddLoot).
+  kLootGeneration,
+  // Перемещение собак и учет времени простоя.
+  kMovement,
+  // Удаление собак, ушедших на покой.
+  kRetirement,
+  kFindCollisions,
+  kHandleCollisions,
+  // Удаление игроков, чьи собаки ушли на покой.
+  kPlayersCleanup,
+  kSaveRetiredPlayers,
+};
+
+inline constexpr std::size_t kNumOfTickPhases = 7;
+
+std::string_view ToString(TickPhase phase) noexcept;
+
+// Профилировщик тиков. Для каждой игровой сессии хранит длительности фаз за
+// последние kWindowSize тиков и по ним вычисляет перцентили. Если включена
+// трассировка, дополнительно сохраняет события для Chrome trace-event JSON
+// (chrome://tracing, Perfetto).
+//
+// Профилирование тика сессии начинается с создания SessionScope. Фазы
+// замеряются объектами PhaseTimer, которые находят текущий SessionScope
+// через thread_local указатель, поэтому код модели не зависит от
+// профилировщика. Вне SessionScope PhaseTimer ничего не делает.
+class TickProfiler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::size_t kWindowSize = 256;
+  static constexpr std::size_t kMaxTraceEvents = 64 * 1024;
+
+  class SessionScope;
+
+  // Замеряет одну фазу тика текущей сессии.
+  class PhaseTimer {
+   public:
+    explicit PhaseTimer(TickPhase phase) noexcept;
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+    ~PhaseTimer();
+
+   private:
+    SessionScope* scope_;
+    TickPhase phase_;
+    Clock::time_point start_;
+  };
+
+ private:
+  // Кольцевой буфер длительностей в наносекундах. Пишет в него только поток,
+  // обновляющий сессию, а читать может любой поток.
+  struct Window {
+    std::array<std::atomic<std::uint64_t>, kWindowSize> durations{};
+    std::atomic<std::uint64_t> count{0};
+
+    void Add(std::uint64_t duration) noexcept;
+    json::object GetSummary() const;
+  };
+
+  struct SessionStats {
+    Window total;
+    std::array<Window, kNumOfTickPhases> phases;
+  };
+
+ public:
+  // Профилирует один тик сессии session_id в текущем потоке.
+  class SessionScope {
+   public:
+    SessionScope(TickProfiler& profiler, std::uint64_t session_id);
+    SessionScope(const SessionScope&) = delete;
+    SessionScope& operator=(const SessionScope&) = delete;
+    ~SessionScope();
+
+   private:
+    friend class PhaseTimer;
+
+    void AddPhase(TickPhase phase, Clock::time_point start,
+                  Clock::time_point end) noexcept;
+
+    TickProfiler& profiler_;
+    std::uint64_t session_id_;
+    SessionStats& stats_;
+    SessionScope* previous_scope_;
+    Clock::time_point start_;
+    std::array<std::uint64_t, kNumOfTickPhases> phase_durations_{};
+    std::array<bool, kNumOfTickPhases> is_phase_measured_{};
+  };
+
+  TickProfiler();
+  TickProfiler(const TickProfiler&) = delete;
+  TickProfiler& operator=(const TickProfiler&) = delete;
+
+  // Удаляет статистику сессии, которая больше не существует.
+  void RemoveSession(std::uint64_t session_id);
+
+  // Включает или выключает запись событий для Chrome trace-event JSON.
+  // При включении ранее записанные события удаляются, а память под
+  // kMaxTraceEvents событий выделяется заранее.
+  void SetTracing(bool is_enabled);
+  bool IsTracing() const noexcept;
+
+  // Возвращает перцентили длительностей фаз (в миллисекундах) для каждой
+  // сессии.
+  json::value GetSummary() const;
+
+  // Возвращает записанные события в формате Chrome trace-event JSON.
+  std::string GetChromeTrace() const;
+
+ private:
+  struct TraceEvent {
+    std::string_view name;
+    std::uint64_t session_id;
+    std::uint32_t thread_index;
+    Clock::time_point start;
+    Clock::duration duration;
+  };
+
+  SessionStats& GetSessionStats(std::uint64_t session_id);
+  // Не выделяет память: вызывается из noexcept SessionScope::AddPhase и
+  // деструктора SessionScope во время тика.
+  void AddTraceEvent(std::string_view name, std::uint64_t session_id,
+                     Clock::time_point start, Clock::time_point end) noexcept;
+
+  const Clock::time_point start_;
+
+  mutable std::shared_mutex sessions_mutex_;
+  std::unordered_map<std::uint64_t, std::unique_ptr<SessionStats>> sessions_;
+
+  std::atomic<bool> is_tracing_{false};
+  mutable std::mutex trace_mutex_;
+  std::vector<TraceEvent> trace_events_;  // Guarded by trace_mutex_
+  std::size_t next_trace_event_ = 0;      // Guarded by trace_mutex_
+};
+
+}  // namespace util
@@ -64,27 +64,59 @@ const Player* Application::GetPlayerByMapIdAndDogName(
   }
 }
 
-bool Application::MovePlayer(const model::GameSession::Id& game_session_id,
-                             const model::Dog::Id& dog_id,
-                             const std::string& movement) {
-  bool result = false;
-  if (auto game_session_strand = strand_storage_.GetStrand(game_session_id)) {
-    auto handler = [self = this->shared_from_this(), &game_session_id, &dog_id,
-                    &movement, &result] {
-      try {
-        self->game_.MoveDog(game_session_id, dog_id, movement);
-        result = true;
-      } catch (const std::exception& ec) {
-        self->LogError(ec.what(), "Moving player in game session with id == "s +
-                                      std::to_string(*game_session_id) +
-                                      " and with dog id == "s +
-                                      std::to_string(*dog_id));
-        result = false;
-      }
-    };
-    net::dispatch(*game_session_strand, std::move(handler));
+bool Application::MovePlayerInStrand(
+    const model::GameSession::Id& game_session_id,
+    const model::Dog::Id& dog_id, std::optional<model::Direction> direction) {
+  try {
+    // Спящая сессия сначала догоняет игровое время, иначе собака
+    // двигалась бы и в то время, пока сессия спала.
+    if (session_scheduler_.IsSleeping(game_session_id)) {
+      CatchUpGameSession(game_session_id);
+    }
+    game_.MoveDog(game_session_id, dog_id, direction);
+    session_scheduler_.Wake(game_session_id);
+    return true;
+  } catch (const std::exception& ec) {
+    LogError(ec.what(), "Moving player in game session with id == "s +
+                            std::to_string(*game_session_id) +
+                            " and with dog id == "s + std::to_string(*dog_id));
+    return false;
   }
-  return result;
+}
+
+std::vector<bool> Application::MovePlayersInStrand(
+    const model::GameSession::Id& game_session_id,
+    const std::vector<DogMovement>& movements) {
+  std::vector<bool> results(movements.size(), false);
+  try {
+    // Как и в MovePlayerInStrand, спящая сессия сначала догоняет игровое
+    // время.
+    if (session_scheduler_.IsSleeping(game_session_id)) {
+      CatchUpGameSession(game_session_id);
+    }
+  } catch (const std::exception& ec) {
+    LogError(ec.what(), "Moving players in game session with id == "s +
+                            std::to_string(*game_session_id));
+    return results;
+  }
+  bool is_moved = false;
+  for (std::size_t i = 0; i < movements.size(); ++i) {
+    try {
+      game_.MoveDog(game_session_id, movements[i].dog_id,
+                    movements[i].direction);
+      results[i] = true;
+      is_moved = true;
+    } catch (const std::exception& ec) {
+      LogError(ec.what(),
+               "Moving player in game session with id == "s +
+                   std::to_string(*game_session_id) + " and with dog id == "s +
+                   std::to_string(*movements[i].dog_id));
+    }
+  }
+  if (is_moved) {
+    session_scheduler_.Wake(game_session_id);
+  }
+  return results;
 }
 
 model::GameSession* Application::GetGameSessionById(
@@ -137,6 +169,8 @@ model::GameSession* Application::CreateGameSession(
     result =
         game_.AddGameSession(std::move(game_session_name), std::move(map_id));
     strand_storage_.AddStrand(result->GetId());
+    session_scheduler_.AddSession(result->GetId());
+    metrics::GetServerMetrics().game_sessions.Add(1);
   } catch (const std::exception& ec) {
     LogError(ec.what(), "Creating game session with map id == "s + *map_id +
                             " and game session name == "s + game_session_name);
@@ -145,71 +179,108 @@ model::GameSession* Application::CreateGameSession(
   return result;
 }
 
-const Player* Application::JoinToGameSession(
-    std::string dog_name, model::GameSession::Id game_session_id,
+const Player* Application::JoinToGameSessionInStrand(
+    std::string dog_name, const model::GameSession::Id& game_session_id,
     const std::pair<model::Point, const model::Road*>& dog_position) {
-  const Player* result = nullptr;
-  if (auto game_session_strand = strand_storage_.GetStrand(game_session_id)) {
-    auto handler = [self = this->shared_from_this(), &dog_name,
-                    &game_session_id, &dog_position, &result] {
-      try {
-        auto dog = self->game_.AddDogInGameSession(
-            game_session_id, std::move(dog_name), dog_position);
-        result = self->players_table_.AddPlayer(game_session_id, dog->GetId());
-      } catch (const std::exception& ec) {
-        self->LogError(ec.what(), "Joining to game session with id == "s +
-                                      std::to_string(*game_session_id));
-        result = nullptr;
-      }
-    };
-    net::dispatch(*game_session_strand, std::move(handler));
+  try {
+    if (session_scheduler_.IsSleeping(game_session_id)) {
+      CatchUpGameSession(game_session_id);
+    }
+    auto dog = game_.AddDogInGameSession(game_session_id, std::move(dog_name),
+                                         dog_position);
+    auto result = players_table_.AddPlayer(game_session_id, dog->GetId());
+    session_scheduler_.Wake(game_session_id);
+    metrics::GetServerMetrics().dogs.Add(1);
+    return result;
+  } catch (const std::exception& ec) {
+    LogError(ec.what(), "Joining to game session with id == "s +
+                            std::to_string(*game_session_id));
+    return nullptr;
   }
-  return result;
 }
 
-bool Application::UpdateGameSession(
-    const model::GameSession::Id& game_session_id, Milliseconds time_delta) {
-  bool result = false;
-  if (auto game_session_strand = strand_storage_.GetStrand(game_session_id)) {
-    auto handler = [self = this->shared_from_this(), &game_session_id,
-                    &time_delta, &result] {
-      try {
-        auto retired_dogs =
-            self->game_.UpdateGameSession(game_session_id, time_delta);
-        if (!retired_dogs.empty()) {
-          self->players_table_.DeletePlayersByRetiredDogs(retired_dogs);
-          self->SaveRetiredPlayers(retired_dogs);
-        }
-        result = true;
-      } catch (const std::exception& ec) {
-        self->LogError(ec.what(), "Updating game session with id == "s +
-                                      std::to_string(*game_session_id));
-        result = false;
-      }
-    };
-    net::dispatch(*game_session_strand, std::move(handler));
-  }
-  return result;
+bool Application::SaveGameState() {
+  return AsyncSaveGameState(net::use_future).get();
 }
 
-bool Application::UpdateAllGameSessions(Milliseconds time_delta) {
+bool Application::UpdateGameSessionInStrand(
+    const model::GameSession::Id& game_session_id) {
   try {
-    for (auto game_session : game_.GetGameSessions()) {
-      if (!UpdateGameSession(game_session->GetId(), time_delta)) {
-        return false;
-      }
+    if (CatchUpGameSession(game_session_id)) {
+      ScheduleGameSession(game_session_id);
     }
     return true;
   } catch (const std::exception& ec) {
-    LogError(ec.what(), "Updating all game sessions"sv);
+    LogError(ec.what(), "Updating game session with id == "s +
+                            std::to_string(*game_session_id));
     return false;
   }
 }
 
-bool Application::SaveGameState() const {
-  if (!is_save_file_set_) {
-    return true;
+bool Application::CatchUpGameSession(
+    const model::GameSession::Id& game_session_id) {
+  using util::TickPhase;
+  using PhaseTimer = util::TickProfiler::PhaseTimer;
+  auto time_delta = session_scheduler_.TakeElapsedTime(game_session_id);
+  if (time_delta == Milliseconds::zero()) {
+    return game_.GetGameSessionById(game_session_id) != nullptr;
+  }
+  bool is_game_session_removed = false;
+  {
+    util::TickProfiler::SessionScope profiler_scope(tick_profiler_,
+                                                    *game_session_id);
+    const auto* game_session = game_.GetGameSessionById(game_session_id);
+    auto loot_count =
+        game_session ? static_cast<double>(game_session->GetLoot().size())
+                     : 0.0;
+    auto retired_dogs = game_.UpdateGameSession(game_session_id, time_delta);
+    // Опустевшая сессия удаляется из игры вместе с потерянными вещами.
+    auto& server_metrics = metrics::GetServerMetrics();
+    server_metrics.dogs.Add(-static_cast<double>(retired_dogs.size()));
+    if (game_session = game_.GetGameSessionById(game_session_id);
+        game_session) {
+      server_metrics.loot_objects.Add(
+          static_cast<double>(game_session->GetLoot().size()) - loot_count);
+    } else {
+      is_game_session_removed = true;
+      server_metrics.game_sessions.Add(-1);
+      server_metrics.loot_objects.Add(-loot_count);
+    }
+    if (!retired_dogs.empty()) {
+      {
+        PhaseTimer timer(TickPhase::kPlayersCleanup);
+        players_table_.DeletePlayersByRetiredDogs(retired_dogs);
+      }
+      PhaseTimer timer(TickPhase::kSaveRetiredPlayers);
+      SaveRetiredPlayers(retired_dogs);
+    }
+  }
+  if (is_game_session_removed) {
+    tick_profiler_.RemoveSession(*game_session_id);
+    session_scheduler_.RemoveSession(game_session_id);
   }
+  return !is_game_session_removed;
+}
+
+void Application::ScheduleGameSession(
+    const model::GameSession::Id& game_session_id) {
+  if (auto idle_time = game_.GetGameSessionIdleTime(game_session_id);
+      idle_time > Milliseconds::zero()) {
+    session_scheduler_.Sleep(game_session_id, idle_time);
+  } else {
+    session_scheduler_.Wake(game_session_id);
+  }
+}
+
+bool Application::SaveGameStateToFile() const {
+  auto start = std::chrono::steady_clock::now();
+  bool result = WriteGameStateToFile();
+  metrics::GetServerMetrics().save_state_duration.ObserveDuration(
+      std::chrono::steady_clock::now() - start);
+  return result;
+}
+
+bool Application::WriteGameStateToFile() const {
   using namespace serialization;
   const std::string_view where = "Saving the game state to a file"sv;
 
@@ -254,6 +325,11 @@ void Application::LoadGameState() {
       auto game_session =
           game_.LoadGameSession(std::move(serialized_game_session.Restore()));
       strand_storage_.AddStrand(game_session->GetId());
+      session_scheduler_.AddSession(game_session->GetId());
+      auto& server_metrics = metrics::GetServerMetrics();
+      server_metrics.game_sessions.Add(1);
+      server_metrics.dogs.Add(game_session->GetDogsCount());
+      server_metrics.loot_objects.Add(game_session->GetLoot().size());
     }
     std::vector<SerializedPlayer> serialized_players;
     ar >> serialized_players;
@@ -287,8 +363,15 @@ model::GameSession::RetiredDogs Application::GetRetiredPlayers(
   }
 }
 
+util::TickProfiler& Application::GetTickProfiler() noexcept {
+  return tick_profiler_;
+}
+
 void Application::LogError(std::string_view text_error,
                            std::string_view where) const {
+  if (!logger::ShouldLog(logger::LogEvent::kError)) {
+    return;
+  }
   logger::Log(json::value{{"text"s, text_error}, {"where"s, where}}, "error"sv);
 }
 
@@ -2,24 +2,37 @@
 
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/dispatch.hpp>
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_future.hpp>
 #include <boost/json.hpp>
 #include <boost/serialization/vector.hpp>
+#include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
 #include "../../lib/model/game.h"
 #include "../../lib/model/game_session.h"
 #include "../../lib/model/map.h"
+#include "../../lib/util/io_context_pool.h"
+#include "../../lib/util/tick_profiler.h"
 #include "../db/database.h"
 #include "../logger/logger.h"
+#include "../metrics/server_metrics.h"
 #include "../serialization/serialization.h"
 #include "player.h"
 #include "players_table.h"
+#include "session_scheduler.h"
 #include "strand_storage.h"
 #include "token.h"
 
@@ -34,6 +47,16 @@ namespace fs = std::filesystem;
 //
 // Функции, взаимодействующие с игровыми сессиями, выполняются с помощью
 // последовательного исполнителя. Это позволяет избежать гонки данных.
+// Такие функции асинхронны (Async*): они принимают completion token в стиле
+// Boost.Asio (обработчик, net::use_future, net::use_awaitable) и никогда не
+// блокируют вызывающий поток. Обработчик завершения вызывается через
+// связанный с ним исполнитель, по умолчанию - прямо в strand игровой сессии.
+//
+// Если задан пул шардов game_shards, strand каждой игровой сессии работает в
+// io_context своего шарда, и операции с сессией выполняются потоком шарда.
+//
+// Запросы к базе данных от клиентов выполняются в отдельном пуле потоков
+// database_pool_, чтобы ожидание ответа базы не занимало рабочие потоки.
 //
 // Также этот класс отвечает за создание последовательных исполнителей для
 // каждой игровой сессии (при создании этих игровых сессий), чтобы игровые
@@ -46,15 +69,30 @@ class Application : public std::enable_shared_from_this<Application> {
  public:
   using Milliseconds = std::chrono::milliseconds;
 
+  // Команда движения собаки с id равным dog_id для AsyncMovePlayers. Пустое
+  // направление останавливает собаку.
+  struct DogMovement {
+    model::Dog::Id dog_id;
+    std::optional<model::Direction> direction;
+  };
+
+  // Команды движения собак игровой сессии с id равным game_session_id.
+  struct SessionMovements {
+    model::GameSession::Id game_session_id;
+    std::vector<DogMovement> movements;
+  };
+
   template <typename ConnectionFactory>
-  explicit Application(net::io_context& ioc, model::Game& game,
-                       std::string save_file, bool is_save_file_set,
+  explicit Application(net::io_context& ioc, util::IoContextPool* game_shards,
+                       model::Game& game, std::string save_file,
+                       bool is_save_file_set,
                        const db::DatabaseConfig<ConnectionFactory> config)
-      : strand_storage_(ioc),
+      : strand_storage_(ioc, game_shards),
         game_(game),
         kSaveFile(std::move(save_file)),
         is_save_file_set_(is_save_file_set),
-        database_(config) {
+        database_(config),
+        database_pool_(config.connection_count) {
     if (is_save_file_set_ && fs::exists(kSaveFile)) {
       LoadGameState();
     }
@@ -86,9 +124,48 @@ class Application : public std::enable_shared_from_this<Application> {
                                            const std::string& dog_name) const;
 
   // Меняет направление собаки с id равно dog_id в игровой сессии с id равном
-  // game_session_id на movement.
-  bool MovePlayer(const model::GameSession::Id& game_session_id,
-                  const model::Dog::Id& dog_id, const std::string& movement);
+  // game_session_id на direction. Пустое направление останавливает собаку.
+  // Сигнатура обработчика завершения: void(bool). При неудаче передается
+  // false.
+  template <typename CompletionToken>
+  auto AsyncMovePlayer(model::GameSession::Id game_session_id,
+                       model::Dog::Id dog_id,
+                       std::optional<model::Direction> direction,
+                       CompletionToken&& token) {
+    return net::async_initiate<CompletionToken, void(bool)>(
+        [self = shared_from_this()](auto handler,
+                                    model::GameSession::Id game_session_id,
+                                    model::Dog::Id dog_id,
+                                    std::optional<model::Direction> direction) {
+          self->RunInGameSessionStrand(
+              game_session_id, std::move(handler),
+              [self, game_session_id, dog_id, direction] {
+                return self->MovePlayerInStrand(game_session_id, dog_id,
+                                                direction);
+              },
+              false);
+        },
+        token, game_session_id, dog_id, direction);
+  }
+
+  // Применяет команды sessions к собакам нескольких игровых сессий. Команды
+  // одной сессии применяются по порядку за один переход в ее strand, разные
+  // сессии обрабатываются параллельно.
+  // Сигнатура обработчика завершения:
+  // void(std::vector<std::vector<bool>>). Для каждой сессии передается,
+  // применена ли каждая ее команда. Если сессия не найдена, для нее
+  // передается пустой вектор.
+  template <typename CompletionToken>
+  auto AsyncMovePlayers(std::vector<SessionMovements> sessions,
+                        CompletionToken&& token) {
+    return net::async_initiate<CompletionToken,
+                               void(std::vector<std::vector<bool>>)>(
+        [self = shared_from_this()](auto handler,
+                                    std::vector<SessionMovements> sessions) {
+          self->MovePlayersInSessions(std::move(sessions), std::move(handler));
+        },
+        token, std::move(sessions));
+  }
 
   // Возвращает указатель на игровую сессию с id равном game_session_id.
   // При неудаче возвращает nullptr.
@@ -111,21 +188,79 @@ class Application : public std::enable_shared_from_this<Application> {
 
   // Добавляет нового игрока в таблицу players_table_ и связанную с ним собаку в
   // игровую сессию с id равном game_session_id.
-  // При неудаче возвращает nullptr.
-  const Player* JoinToGameSession(
+  // Сигнатура обработчика завершения: void(const Player*). При неудаче
+  // передается nullptr.
+  template <typename CompletionToken>
+  auto AsyncJoinToGameSession(
       std::string dog_name, model::GameSession::Id game_session_id,
-      const std::pair<model::Point, const model::Road*>& dog_position);
+      std::pair<model::Point, const model::Road*> dog_position,
+      CompletionToken&& token) {
+    return net::async_initiate<CompletionToken, void(const Player*)>(
+        [self = shared_from_this()](
+            auto handler, std::string dog_name,
+            model::GameSession::Id game_session_id,
+            std::pair<model::Point, const model::Road*> dog_position) {
+          self->RunInGameSessionStrand(
+              game_session_id, std::move(handler),
+              [self, dog_name = std::move(dog_name), game_session_id,
+               dog_position]() mutable {
+                return self->JoinToGameSessionInStrand(
+                    std::move(dog_name), game_session_id, dog_position);
+              },
+              static_cast<const Player*>(nullptr));
+        },
+        token, std::move(dog_name), game_session_id, dog_position);
+  }
 
-  // Обновляет игровую сессию с id равном game_session_id внутри своего strand.
-  // При неудаче возвращает false.
-  bool UpdateGameSession(const model::GameSession::Id& game_session_id,
-                         Milliseconds time_delta);
+  // Продвигает игровое время на time_delta и обновляет в их strand активные
+  // игровые сессии и сессии, чей сон закончился: каждая сессия обновляется на
+  // игровое время, прошедшее с ее предыдущего обновления, и засыпает, если в
+  // ней ничего не происходит. Сессии разных шардов обновляются параллельно.
+  // Сигнатура обработчика завершения: void(bool). Если хотя бы одну сессию
+  // обновить не удалось, передается false.
+  template <typename CompletionToken>
+  auto AsyncUpdateAllGameSessions(Milliseconds time_delta,
+                                  CompletionToken&& token) {
+    return net::async_initiate<CompletionToken, void(bool)>(
+        [self = shared_from_this()](auto handler, Milliseconds time_delta) {
+          SessionScheduler::SessionIds game_session_ids;
+          try {
+            game_session_ids = self->session_scheduler_.AdvanceTime(time_delta);
+            metrics::GetServerMetrics().sleeping_game_sessions.Set(
+                static_cast<double>(
+                    self->session_scheduler_.GetSleepingCount()));
+          } catch (const std::exception& ec) {
+            self->LogError(ec.what(), "Updating all game sessions"sv);
+            return Complete(std::move(handler), false);
+          }
+          self->UpdateGameSessions(std::move(game_session_ids),
+                                   std::move(handler));
+        },
+        token, time_delta);
+  }
 
-  // Вызывает внутри себя UpdateGameSession для всех игровых сессий.
-  bool UpdateAllGameSessions(Milliseconds time_delta);
+  // Сохраняет состояние игры в kSaveFile. Перед сохранением спящие игровые
+  // сессии догоняют игровое время, чтобы в файл попало их текущее состояние.
+  // Сигнатура обработчика завершения: void(bool).
+  template <typename CompletionToken>
+  auto AsyncSaveGameState(CompletionToken&& token) {
+    return net::async_initiate<CompletionToken, void(bool)>(
+        [self = shared_from_this()](auto handler) {
+          if (!self->is_save_file_set_) {
+            return Complete(std::move(handler), true);
+          }
+          self->UpdateGameSessions(
+              self->session_scheduler_.GetSleepingSessions(),
+              [self, handler = std::move(handler)](bool) mutable {
+                Complete(std::move(handler), self->SaveGameStateToFile());
+              });
+        },
+        token);
+  }
 
-  // Сохраняет состояние игры в kSaveFile.
-  bool SaveGameState() const;
+  // Синхронная версия AsyncSaveGameState. Используется при завершении
+  // сервера, когда рабочие потоки уже остановлены.
+  bool SaveGameState();
 
   // Восстанавливает состояние игры их kSaveFile.
   void LoadGameState();
@@ -137,16 +272,194 @@ class Application : public std::enable_shared_from_this<Application> {
   model::GameSession::RetiredDogs GetRetiredPlayers(std::uint32_t offset,
                                                     std::uint32_t max_items);
 
+  // Асинхронная версия GetRetiredPlayers. Запрос выполняется в
+  // database_pool_.
+  // Сигнатура обработчика завершения: void(model::GameSession::RetiredDogs).
+  template <typename CompletionToken>
+  auto AsyncGetRetiredPlayers(std::uint32_t offset, std::uint32_t max_items,
+                              CompletionToken&& token) {
+    return net::async_initiate<CompletionToken,
+                               void(model::GameSession::RetiredDogs)>(
+        [self = shared_from_this()](auto handler, std::uint32_t offset,
+                                    std::uint32_t max_items) {
+          net::post(self->database_pool_, [self, handler = std::move(handler),
+                                           offset, max_items]() mutable {
+            Complete(std::move(handler),
+                     self->GetRetiredPlayers(offset, max_items));
+          });
+        },
+        token, offset, max_items);
+  }
+
+  // Профилировщик фаз обновления игровых сессий.
+  util::TickProfiler& GetTickProfiler() noexcept;
+
  private:
+  // Сохраняет состояние игры в файл и замеряет время сохранения.
+  bool SaveGameStateToFile() const;
+  bool WriteGameStateToFile() const;
+
+  // Вызывает обработчик завершения handler с результатом result через
+  // связанный с обработчиком исполнитель.
+  template <typename Handler, typename Result>
+  static void Complete(Handler&& handler, Result result) {
+    auto executor = net::get_associated_executor(handler);
+    net::dispatch(executor, [handler = std::forward<Handler>(handler),
+                             result = std::move(result)]() mutable {
+      std::move(handler)(std::move(result));
+    });
+  }
+
+  // Выполняет fn() в strand игровой сессии и передает ее результат
+  // обработчику handler. Обработчик вызывается через связанный с ним
+  // исполнитель, по умолчанию - в том же strand. Если strand свободен и
+  // принадлежит io_context текущего потока, fn выполняется сразу. Если
+  // сессии не существует, handler получает default_result.
+  //
+  // При завершении сервера io_context уже может быть остановлен. Тогда с
+  // сессией больше никто не работает, и fn и handler выполняются в текущем
+  // потоке.
+  template <typename Handler, typename Fn, typename Result>
+  void RunInGameSessionStrand(const model::GameSession::Id& game_session_id,
+                              Handler&& handler, Fn&& fn,
+                              Result default_result) {
+    auto game_session_strand = strand_storage_.GetStrand(game_session_id);
+    if (!game_session_strand) {
+      return Complete(std::forward<Handler>(handler),
+                      std::move(default_result));
+    }
+    const bool is_stopped =
+        game_session_strand->get_inner_executor().context().stopped();
+    auto task = [handler = std::forward<Handler>(handler),
+                 fn = std::forward<Fn>(fn), strand = *game_session_strand,
+                 is_stopped]() mutable {
+      auto result = fn();
+      if (is_stopped) {
+        return std::move(handler)(std::move(result));
+      }
+      auto executor = net::get_associated_executor(handler, strand);
+      net::dispatch(executor, [handler = std::move(handler),
+                               result = std::move(result)]() mutable {
+        std::move(handler)(std::move(result));
+      });
+    };
+    if (is_stopped) {
+      task();
+    } else {
+      net::dispatch(*game_session_strand, std::move(task));
+    }
+  }
+
+  // Обновляет игровые сессии game_session_ids в их strand и вызывает
+  // handler(bool) после обновления последней из них.
+  template <typename Handler>
+  void UpdateGameSessions(SessionScheduler::SessionIds game_session_ids,
+                          Handler&& handler) {
+    if (game_session_ids.empty()) {
+      return Complete(std::forward<Handler>(handler), true);
+    }
+    struct State {
+      State(std::size_t count, Handler&& handler)
+          : remaining(count), handler(std::forward<Handler>(handler)) {}
+
+      std::atomic<std::size_t> remaining;
+      std::atomic<bool> result{true};
+      std::decay_t<Handler> handler;
+    };
+    auto state = std::make_shared<State>(game_session_ids.size(),
+                                         std::forward<Handler>(handler));
+    for (const auto& game_session_id : game_session_ids) {
+      RunInGameSessionStrand(
+          game_session_id,
+          [state](bool result) {
+            if (!result) {
+              state->result = false;
+            }
+            if (state->remaining.fetch_sub(1) == 1) {
+              Complete(std::move(state->handler), state->result.load());
+            }
+          },
+          [self = shared_from_this(), game_session_id] {
+            return self->UpdateGameSessionInStrand(game_session_id);
+          },
+          false);
+    }
+  }
+
+  // Запускает команды всех сессий sessions в их strand и вызывает
+  // handler(std::vector<std::vector<bool>>) после обработки последней из них.
+  template <typename Handler>
+  void MovePlayersInSessions(std::vector<SessionMovements> sessions,
+                             Handler&& handler) {
+    using Results = std::vector<std::vector<bool>>;
+    if (sessions.empty()) {
+      return Complete(std::forward<Handler>(handler), Results());
+    }
+    // Каждая сессия пишет только свой элемент results, а последняя
+    // завершившаяся передает их обработчику.
+    struct State {
+      State(std::size_t count, Handler&& handler)
+          : remaining(count),
+            results(count),
+            handler(std::forward<Handler>(handler)) {}
+
+      std::atomic<std::size_t> remaining;
+      Results results;
+      std::decay_t<Handler> handler;
+    };
+    auto state = std::make_shared<State>(sessions.size(),
+                                         std::forward<Handler>(handler));
+    for (std::size_t i = 0; i < sessions.size(); ++i) {
+      const auto game_session_id = sessions[i].game_session_id;
+      RunInGameSessionStrand(
+          game_session_id,
+          [state, i](std::vector<bool> results) {
+            state->results[i] = std::move(results);
+            if (state->remaining.fetch_sub(1) == 1) {
+              Complete(std::move(state->handler), std::move(state->results));
+            }
+          },
+          [self = shared_from_this(), game_session_id,
+           movements = std::move(sessions[i].movements)] {
+            return self->MovePlayersInStrand(game_session_id, movements);
+          },
+          std::vector<bool>());
+    }
+  }
+
+  // Тела асинхронных операций. Вызываются в strand игровой сессии.
+  bool MovePlayerInStrand(const model::GameSession::Id& game_session_id,
+                          const model::Dog::Id& dog_id,
+                          std::optional<model::Direction> direction);
+  std::vector<bool> MovePlayersInStrand(
+      const model::GameSession::Id& game_session_id,
+      const std::vector<DogMovement>& movements);
+  const Player* JoinToGameSessionInStrand(
+      std::string dog_name, const model::GameSession::Id& game_session_id,
+      const std::pair<model::Point, const model::Road*>& dog_position);
+  bool UpdateGameSessionInStrand(const model::GameSession::Id& game_session_id);
+
+  // Обновляет игровую сессию на время, прошедшее с ее предыдущего обновления.
+  // Вызывается в strand игровой сессии. Если сессия опустела и была удалена,
+  // возвращает false.
+  bool CatchUpGameSession(const model::GameSession::Id& game_session_id);
+
+  // Усыпляет игровую сессию, если в ней ничего не происходит, иначе делает
+  // ее активной. Вызывается в strand игровой сессии.
+  void ScheduleGameSession(const model::GameSession::Id& game_session_id);
+
   void LogError(std::string_view error_text, std::string_view where) const;
 
   StrandStorage strand_storage_;
+  SessionScheduler session_scheduler_;
   model::Game& game_;
   PlayersTable players_table_;
   const std::string kSaveFile;
   const std::string kTempSaveFile = kSaveFile + "temp_";
   bool is_save_file_set_;
   db::Database database_;
+  net::thread_pool database_pool_;
+  util::TickProfiler tick_profiler_;
 };
 
 }  // namespace app
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "session_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace app {
+
+void SessionScheduler::AddSession(
+    const model::GameSession::Id& game_session_id) {
+  std::lock_guard lock(mutex_);
+  sessions_.insert_or_assign(game_session_id, SessionState{now_, std::nullopt});
+  active_.insert(game_session_id);
+}
+
+void SessionScheduler::RemoveSession(
+    const model::GameSession::Id& game_session_id) {
+  std::lock_guard lock(mutex_);
+  if (auto it = sessions_.find(game_session_id); it != sessions_.end()) {
+    if (it->second.wake_position) {
+      wake_queue_.erase(*it->second.wake_position);
+    }
+    sessions_.erase(it);
+  }
+  active_.erase(game_session_id);
+}
+
+SessionScheduler::SessionIds SessionScheduler::AdvanceTime(
+    Milliseconds time_delta) {
+  std::lock_guard lock(mutex_);
+  now_ += time_delta;
+  while (!wake_queue_.empty() && wake_queue_.begin()->first <= now_) {
+    auto game_session_id = wake_queue_.begin()->second;
+    WakeLocked(sessions_.at(game_session_id), game_session_id);
+  }
+  return {active_.begin(), active_.end()};
+}
+
+SessionScheduler::Milliseconds SessionScheduler::TakeElapsedTime(
+    const model::GameSession::Id& game_session_id) {
+  std::lock_guard lock(mutex_);
+  auto it = sessions_.find(game_session_id);
+  if (it == sessions_.end()) {
+    return Milliseconds::zero();
+  }
+  return now_ - std::exchange(it->second.last_update_time, now_);
+}
+
+void SessionScheduler::Sleep(const model::GameSession::Id& game_session_id,
+                             Milliseconds sleep_time) {
+  std::lock_guard lock(mutex_);
+  auto it = sessions_.find(game_session_id);
+  if (it == sessions_.end()) {
+    return;
+  }
+  auto& state = it->second;
+  if (state.wake_position) {
+    wake_queue_.erase(*state.wake_position);
+  }
+  // Время сна ограничено, чтобы не переполнить игровые часы.
+  auto wake_time = state.last_update_time +
+                   std::min(sleep_time, Milliseconds::max() / 2 - now_);
+  state.wake_position = wake_queue_.emplace(wake_time, game_session_id);
+  active_.erase(game_session_id);
+}
+
+void SessionScheduler::Wake(const model::GameSession::Id& game_session_id) {
+  std::lock_guard lock(mutex_);
+  if (auto it = sessions_.find(game_session_id); it != sessions_.end()) {
+    WakeLocked(it->second, game_session_id);
+  }
+}
+
+bool SessionScheduler::IsSleeping(
+    const model::GameSession::Id& game_session_id) const {
+  std::lock_guard lock(mutex_);
+  auto it = sessions_.find(game_session_id);
+  return it != sessions_.end() && it->second.wake_position.has_value();
+}
+
+SessionScheduler::SessionIds SessionScheduler::GetSleepingSessions() const {
+  std::lock_guard lock(mutex_);
+  SessionIds result;
+  result.reserve(wake_queue_.size());
+  for (const auto& [wake_time, game_session_id] : wake_queue_) {
+    result.push_back(game_session_id);
+  }
+  return result;
+}
+
+std::size_t SessionScheduler::GetSleepingCount() const {
+  std::lock_guard lock(mutex_);
+  return wake_queue_.size();
+}
+
+void SessionScheduler::WakeLocked(
+    SessionState& state, const model::GameSession::Id& game_session_id) {
+  if (state.wake_position) {
+    wake_queue_.erase(*state.wake_position);
+    state.wake_position.reset();
+  }
+  active_.insert(game_session_id);
+}
+
+}  // namespace app
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../../lib/model/game_session.h"
+#include "../../lib/util/tagged.h"
+
+namespace app {
+
+// Определяет, какие игровые сессии нужно обновить на очередном тике.
+//
+// Активные сессии обновляются на каждом тике. Сессия, в которой ничего не
+// происходит, засыпает до момента ближайшего события в ней и затем
+// обновляется один раз на все прошедшее время. Время отсчитывается по
+// игровым часам, которые продвигаются тиками.
+//
+// Методы, принимающие id сессии, вызываются в strand этой сессии.
+class SessionScheduler {
+ public:
+  using Milliseconds = std::chrono::milliseconds;
+  using SessionIds = std::vector<model::GameSession::Id>;
+
+  SessionScheduler() = default;
+  SessionScheduler(const SessionScheduler&) = delete;
+  SessionScheduler& operator=(const SessionScheduler&) = delete;
+
+  // Добавляет активную сессию, обновленную в текущий момент игрового времени.
+  void AddSession(const model::GameSession::Id& game_session_id);
+  void RemoveSession(const model::GameSession::Id& game_session_id);
+
+  // Продвигает игровые часы на time_delta и возвращает сессии, которые нужно
+  // обновить: активные и те, чей сон закончился.
+  SessionIds AdvanceTime(Milliseconds time_delta);
+
+  // Возвращает игровое время, прошедшее с предыдущего обновления сессии, и
+  // считает сессию обновленной в текущий момент.
+  Milliseconds TakeElapsedTime(const model::GameSession::Id& game_session_id);
+
+  // Усыпляет сессию на sleep_time от момента ее последнего обновления.
+  void Sleep(const model::GameSession::Id& game_session_id,
+             Milliseconds sleep_time);
+  // Делает сессию активной.
+  void Wake(const model::GameSession::Id& game_session_id);
+
+  bool IsSleeping(const model::GameSession::Id& game_session_id) const;
+
+  SessionIds GetSleepingSessions() const;
+  std::size_t GetSleepingCount() const;
+
+ private:
+  using WakeQueue = std::multimap<Milliseconds, model::GameSession::Id>;
+
+  struct SessionState {
+    Milliseconds last_update_time;
+    // Для спящей сессии указывает на ее элемент в wake_queue_.
+    std::optional<WakeQueue::iterator> wake_position;
+  };
+
+  using GameSessionIdHasher = util::TaggedHasher<model::GameSession::Id>;
+
+  // Переводит спящую сессию в активные. Вызывается под mutex_.
+  void WakeLocked(SessionState& state,
+                  const model::GameSession::Id& game_session_id);
+
+  mutable std::mutex mutex_;
+  Milliseconds now_{0};
+  std::unordered_map<model::GameSession::Id, SessionState, GameSessionIdHasher>
+      sessions_;
+  std::unordered_set<model::GameSession::Id, GameSessionIdHasher> active_;
+  WakeQueue wake_queue_;
+};
+
+}  // namespace app
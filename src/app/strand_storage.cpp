@@ -2,7 +2,8 @@
 
 namespace app {
 
-StrandStorage::StrandStorage(net::io_context& ioc) : ioc_(ioc) {}
+StrandStorage::StrandStorage(net::io_context& ioc, util::IoContextPool* shards)
+    : ioc_(ioc), shards_(shards) {}
 
 const StrandStorage::Strand* StrandStorage::GetStrand(
     const model::GameSession::Id& game_session_id) const noexcept {
@@ -17,7 +18,11 @@ const StrandStorage::Strand* StrandStorage::GetStrand(
 void StrandStorage::AddStrand(const model::GameSession::Id& game_session_id) {
   using namespace std::literals;
   try {
-    storage_.emplace(game_session_id, net::make_strand(ioc_));
+    auto& ioc = (shards_ && shards_->GetSize() != 0)
+                    ? shards_->GetIoContext(*game_session_id %
+                                            shards_->GetSize())
+                    : ioc_;
+    storage_.emplace(game_session_id, net::make_strand(ioc));
   } catch (...) {
     throw;
   }
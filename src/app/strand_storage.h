@@ -4,6 +4,7 @@
 #include <boost/asio/strand.hpp>
 
 #include "../../lib/model/game_session.h"
+#include "../../lib/util/io_context_pool.h"
 #include "../../lib/util/tagged.h"
 
 namespace app {
@@ -11,11 +12,15 @@ namespace app {
 namespace net = boost::asio;
 
 // Хранит последовательных исполнителей для игровых сессий.
+//
+// Если задан пул шардов, strand игровой сессии создается в io_context шарда
+// с номером id % число шардов, иначе - в общем io_context.
 class StrandStorage {
  public:
   using Strand = net::strand<net::io_context::executor_type>;
 
-  explicit StrandStorage(net::io_context& ioc);
+  explicit StrandStorage(net::io_context& ioc,
+                         util::IoContextPool* shards = nullptr);
   StrandStorage(const StrandStorage&) = delete;
   StrandStorage& operator=(const StrandStorage&) = delete;
 
@@ -30,6 +35,7 @@ class StrandStorage {
 
   GameSessionToStrand storage_;
   net::io_context& ioc_;
+  util::IoContextPool* shards_;
 };
 
 }  // namespace app
\ No newline at end of file
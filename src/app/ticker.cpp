@@ -1,25 +1,41 @@
 #include "ticker.h"
 
+#include <cassert>
+
 namespace app {
 
 Ticker::Ticker(net::io_context& ioc, Milliseconds update_period,
                bool is_save_state_period_set, Milliseconds save_state_period,
-               UpdateHandler update_handler, SaveHandler save_handler)
-    : timer_(ioc),
+               UpdateHandler update_handler, SaveHandler save_handler,
+               SchedulingMode mode)
+    : strand_(net::make_strand(ioc)),
+      timer_(strand_),
+      save_timer_(strand_),
       update_period_(update_period),
       is_save_state_period_set_(is_save_state_period_set),
       save_state_period_(save_state_period),
       update_handler_(std::move(update_handler)),
-      save_handler_(std::move(save_handler)) {}
+      save_handler_(std::move(save_handler)),
+      mode_(mode) {
+  // Нулевой период делит временную шкалу тиков на ноль, а нулевой период
+  // сохранения зациклил бы save_timer_.
+  assert(update_period_ > Milliseconds::zero());
+  assert(!is_save_state_period_set_ ||
+         save_state_period_ > Milliseconds::zero());
+}
 
 void Ticker::Start() {
   last_update_tick_ = Clock::now();
-  last_save_tick_ = Clock::now();
+  next_tick_ = last_update_tick_ + update_period_;
   ScheduleTick();
+  if (is_save_state_period_set_) {
+    save_timer_.expires_at(last_update_tick_ + save_state_period_);
+    ScheduleSave();
+  }
 }
 
 void Ticker::ScheduleTick() {
-  timer_.expires_after(update_period_);
+  timer_.expires_at(next_tick_);
   timer_.async_wait([self = this->shared_from_this()](sys::error_code ec) {
     self->OnTick(ec);
   });
@@ -27,19 +43,82 @@ void Ticker::ScheduleTick() {
 
 void Ticker::OnTick(sys::error_code ec) {
   using namespace std::chrono;
-  if (!ec) {
-    auto current_tick = Clock::now();
-    auto time_delta =
-        duration_cast<Milliseconds>(current_tick - last_update_tick_);
-    last_update_tick_ = current_tick;
-    update_handler_(time_delta);
-    if (is_save_state_period_set_ &&
-        duration_cast<Milliseconds>(current_tick - last_save_tick_) >=
-            save_state_period_) {
-      save_handler_();
+  if (ec) {
+    return;
+  }
+  auto& server_metrics = metrics::GetServerMetrics();
+  auto current_tick = Clock::now();
+  server_metrics.tick_lag.ObserveDuration(current_tick - next_tick_);
+
+  // Игровое время продвигается на целое число миллисекунд, а остаток
+  // переходит в следующий тик. После перегрузки Δt ограничивается, и
+  // отставание отбрасывается.
+  auto time_delta =
+      duration_cast<Milliseconds>(current_tick - last_update_tick_);
+  if (time_delta > kMaxCatchUpPeriods * update_period_) {
+    server_metrics.tick_dropped_time.ObserveDuration(
+        time_delta - kMaxCatchUpPeriods * update_period_);
+    time_delta = kMaxCatchUpPeriods * update_period_;
+    last_update_tick_ = current_tick - time_delta;
+  }
+  last_update_tick_ += time_delta;
+  update_handler_(time_delta, [self = shared_from_this(), current_tick] {
+    net::dispatch(self->strand_, [self, current_tick] {
+      self->OnUpdateDone(current_tick);
+    });
+  });
+}
+
+void Ticker::OnUpdateDone(Clock::time_point current_tick) {
+  auto tick_end = Clock::now();
+  metrics::GetServerMetrics().tick_duration.ObserveDuration(tick_end -
+                                                            current_tick);
+  if (!is_save_due_) {
+    return ScheduleNextTick(tick_end);
+  }
+  is_save_due_ = false;
+  save_handler_([self = shared_from_this()] {
+    net::dispatch(self->strand_,
+                  [self] { self->ScheduleNextTick(Clock::now()); });
+  });
+}
+
+void Ticker::ScheduleNextTick(Clock::time_point tick_end) {
+  if (mode_ == SchedulingMode::kFixedDelay) {
+    next_tick_ = tick_end + update_period_;
+  } else {
+    next_tick_ += update_period_;
+    if (next_tick_ <= tick_end) {
+      // Тик не уложился в период: пропускаем прошедшие моменты шкалы.
+      auto missed_ticks = (tick_end - next_tick_) / update_period_ + 1;
+      auto& server_metrics = metrics::GetServerMetrics();
+      server_metrics.tick_overruns.Inc();
+      server_metrics.tick_skipped.Inc(missed_ticks);
+      next_tick_ += missed_ticks * update_period_;
     }
-    ScheduleTick();
   }
+  ScheduleTick();
+}
+
+void Ticker::ScheduleSave() {
+  save_timer_.async_wait([self = this->shared_from_this()](sys::error_code ec) {
+    self->OnSave(ec);
+  });
+}
+
+void Ticker::OnSave(sys::error_code ec) {
+  if (ec) {
+    return;
+  }
+  // Сохранение выполнится после ближайшего тика. Пропущенные периоды не
+  // навёрстываются.
+  is_save_due_ = true;
+  auto next_save = save_timer_.expiry() + save_state_period_;
+  if (auto now = Clock::now(); next_save <= now) {
+    next_save = now + save_state_period_;
+  }
+  save_timer_.expires_at(next_save);
+  ScheduleSave();
 }
 
-}  //  namespace app
\ No newline at end of file
+}  //  namespace app
@@ -6,10 +6,12 @@
 #include <boost/asio/strand.hpp>
 #include <boost/date_time.hpp>
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <utility>
 
 #include "../app/application.h"
+#include "../metrics/server_metrics.h"
 
 namespace app {
 
@@ -18,17 +20,43 @@ namespace sys = boost::system;
 
 // Класс Ticker обновляет игровое состояние через заданный tick_period и
 // сохраняет это состояние в файл.
+//
+// В режиме kFixedRate тики планируются на фиксированной временной шкале
+// (start + n * update_period), поэтому время выполнения тика не накапливается
+// в периоде. Если тик не уложился в период, пропущенные моменты шкалы не
+// навёрстываются серией тиков: следующий тик планируется на ближайший
+// будущий момент, а Δt тика ограничивается kMaxCatchUpPeriods периодами.
+// В режиме kFixedDelay следующий тик планируется через update_period после
+// окончания предыдущего.
+//
+// Обработчики обновления и сохранения асинхронны: они получают функцию done,
+// которую нужно вызвать после завершения операции. Пока операция не
+// завершилась, поток не блокируется, а следующий тик не планируется.
+//
+// Сохранение выполняется по своему таймеру с периодом save_state_period.
+// Таймер только отмечает, что пора сохраняться, а само сохранение
+// выполняется между тиками, поэтому оно не пересекается с обновлением.
 class Ticker : public std::enable_shared_from_this<Ticker> {
  public:
+  using Strand = net::strand<net::io_context::executor_type>;
   using Timer = net::steady_timer;
   using Milliseconds = std::chrono::milliseconds;
-  using UpdateHandler = std::function<bool(Milliseconds time_delta)>;
-  using SaveHandler = std::function<bool()>;
+  using DoneHandler = std::function<void()>;
+  using UpdateHandler =
+      std::function<void(Milliseconds time_delta, DoneHandler done)>;
+  using SaveHandler = std::function<void(DoneHandler done)>;
   using Clock = std::chrono::steady_clock;
 
+  enum class SchedulingMode { kFixedRate, kFixedDelay };
+
+  // Максимальное число периодов, на которое может продвинуться игровое время
+  // за один тик после перегрузки.
+  static constexpr int kMaxCatchUpPeriods = 4;
+
   explicit Ticker(net::io_context& ioc, Milliseconds update_period,
                   bool is_save_state_period_set, Milliseconds save_state_period,
-                  UpdateHandler update_handler, SaveHandler save_handler);
+                  UpdateHandler update_handler, SaveHandler save_handler,
+                  SchedulingMode mode = SchedulingMode::kFixedRate);
   Ticker(const Ticker&) = delete;
   Ticker& operator=(const Ticker&) = delete;
 
@@ -37,15 +65,28 @@ class Ticker : public std::enable_shared_from_this<Ticker> {
  private:
   void ScheduleTick();
   void OnTick(sys::error_code ec);
+  // Вызывается в strand_ после завершения обновления, начатого в момент
+  // current_tick.
+  void OnUpdateDone(Clock::time_point current_tick);
+  void ScheduleNextTick(Clock::time_point tick_end);
+  void ScheduleSave();
+  void OnSave(sys::error_code ec);
 
+  Strand strand_;
   Timer timer_;
+  Timer save_timer_;
   Milliseconds update_period_;
   bool is_save_state_period_set_;
   Milliseconds save_state_period_;
   UpdateHandler update_handler_;
   SaveHandler save_handler_;
+  SchedulingMode mode_;
+  // Момент, на который запланирован следующий тик.
+  Clock::time_point next_tick_;
+  // Момент, до которого игровое время уже обновлено.
   Clock::time_point last_update_tick_;
-  Clock::time_point last_save_tick_;
+  // Истек ли период сохранения.
+  bool is_save_due_ = false;
 };
 
-}  //  namespace app
\ No newline at end of file
+}  //  namespace app
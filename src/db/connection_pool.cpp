@@ -8,8 +8,11 @@ ConnectionPool::ConnectionWrapper ConnectionPool::GetConnection() {
       id_of_connection_owners_threads.end()) {
     throw std::runtime_error("This thread already has connection"s);
   }
+  auto wait_start = std::chrono::steady_clock::now();
   std::unique_lock lock(mutex_);
   cond_var_.wait(lock, [this] { return used_connections_ < pool_.size(); });
+  metrics::GetServerMetrics().db_pool_wait.ObserveDuration(
+      std::chrono::steady_clock::now() - wait_start);
 
   id_of_connection_owners_threads.insert(std::this_thread::get_id());
   return ConnectionWrapper(std::move(pool_[used_connections_++]), this);
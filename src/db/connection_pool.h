@@ -9,6 +9,8 @@
 #include <thread>
 #include <unordered_set>
 
+#include "../metrics/server_metrics.h"
+
 namespace db {
 
 // Реализация пула подключению к базе данных. Такой подход используется для
@@ -0,0 +1,152 @@
+#include "action_parser.h"
+
+#include <boost/json.hpp>
+
+namespace http_handler {
+
+namespace json = boost::json;
+namespace sys = boost::system;
+
+using namespace std::literals;
+
+namespace {
+
+bool IsWhitespace(char c) noexcept {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+}  // namespace
+
+std::optional<PlayerAction> ParseMove(std::string_view move) noexcept {
+  if (move.empty()) {
+    return PlayerAction{};
+  }
+  if (move.size() != 1) {
+    return std::nullopt;
+  }
+  switch (auto direction = static_cast<model::Direction>(move.front())) {
+    case model::Direction::kNorth:
+    case model::Direction::kSouth:
+    case model::Direction::kWest:
+    case model::Direction::kEast:
+      return PlayerAction{direction};
+  }
+  return std::nullopt;
+}
+
+std::optional<PlayerAction> ParseActionFast(std::string_view body) noexcept {
+  // Лексемы канонического тела в порядке следования.
+  enum class State { kObjectBegin, kKey, kColon, kValue, kObjectEnd, kEnd };
+
+  constexpr auto kKey = "\"move\""sv;
+  State state = State::kObjectBegin;
+  std::optional<PlayerAction> action;
+  std::size_t pos = 0;
+  while (true) {
+    while (pos < body.size() && IsWhitespace(body[pos])) {
+      ++pos;
+    }
+    auto rest = body.substr(pos);
+    switch (state) {
+      case State::kObjectBegin:
+        if (!rest.starts_with('{')) {
+          return std::nullopt;
+        }
+        ++pos;
+        state = State::kKey;
+        break;
+      case State::kKey:
+        if (!rest.starts_with(kKey)) {
+          return std::nullopt;
+        }
+        pos += kKey.size();
+        state = State::kColon;
+        break;
+      case State::kColon:
+        if (!rest.starts_with(':')) {
+          return std::nullopt;
+        }
+        ++pos;
+        state = State::kValue;
+        break;
+      case State::kValue: {
+        // Значение - строка из не более чем одного символа.
+        auto end = rest.starts_with('"') ? rest.find('"', 1) : 0;
+        if (end == 0 || end > 2) {
+          return std::nullopt;
+        }
+        action = ParseMove(rest.substr(1, end - 1));
+        if (!action) {
+          return std::nullopt;
+        }
+        pos += end + 1;
+        state = State::kObjectEnd;
+        break;
+      }
+      case State::kObjectEnd:
+        if (!rest.starts_with('}')) {
+          return std::nullopt;
+        }
+        ++pos;
+        state = State::kEnd;
+        break;
+      case State::kEnd:
+        return rest.empty() ? action : std::nullopt;
+    }
+  }
+}
+
+std::optional<PlayerAction> ParseAction(std::string_view body) {
+  if (auto action = ParseActionFast(body)) {
+    return action;
+  }
+  sys::error_code ec;
+  json::value content = json::parse(body, ec);
+  if (ec || !content.is_object()) {
+    return std::nullopt;
+  }
+  auto movement = content.as_object().if_contains("move"sv);
+  if (!movement || !movement->is_string()) {
+    return std::nullopt;
+  }
+  const auto& move = movement->as_string();
+  return ParseMove(std::string_view(move.data(), move.size()));
+}
+
+std::optional<std::vector<BatchAction>> ParseBatchActions(
+    std::string_view body) {
+  sys::error_code ec;
+  json::value content = json::parse(body, ec);
+  if (ec || !content.is_array()) {
+    return std::nullopt;
+  }
+  const auto& items = content.as_array();
+  if (items.empty() || items.size() > kMaxBatchActions) {
+    return std::nullopt;
+  }
+  std::vector<BatchAction> batch;
+  batch.reserve(items.size());
+  for (const auto& item : items) {
+    const auto* fields = item.if_object();
+    if (!fields) {
+      return std::nullopt;
+    }
+    const auto* token = fields->if_contains("token"sv);
+    const auto* movement = fields->if_contains("move"sv);
+    if (!token || !token->is_string() || !movement ||
+        !movement->is_string() || fields->contains("time"sv)) {
+      return std::nullopt;
+    }
+    const auto& move = movement->as_string();
+    auto action = ParseMove(std::string_view(move.data(), move.size()));
+    if (!action) {
+      return std::nullopt;
+    }
+    const auto& token_str = token->as_string();
+    batch.push_back(BatchAction{
+        std::string(token_str.data(), token_str.size()), *action});
+  }
+  return batch;
+}
+
+}  // namespace http_handler
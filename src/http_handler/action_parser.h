@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../lib/model/geometry.h"
+
+namespace http_handler {
+
+// Команда движения из запроса /api/v1/game/player/action. Пустое направление
+// останавливает собаку.
+struct PlayerAction {
+  std::optional<model::Direction> direction;
+};
+
+// Команда из пакетного запроса /api/v1/game/player/actions.
+struct BatchAction {
+  // Токен игрока, которому адресована команда.
+  std::string token;
+  PlayerAction action;
+};
+
+// Наибольшее число команд в одном пакетном запросе.
+inline constexpr std::size_t kMaxBatchActions = 1024;
+
+// Разбирает значение поля "move": "L", "R", "U", "D" или пустую строку.
+std::optional<PlayerAction> ParseMove(std::string_view move) noexcept;
+
+// Разбирает тело вида {"move":"L"} конечным автоматом, не строя json::value.
+// Между лексемами допускаются пробельные символы. Возвращает std::nullopt для
+// любого другого тела, в том числе для корректного JSON с другими полями или
+// экранированием.
+std::optional<PlayerAction> ParseActionFast(std::string_view body) noexcept;
+
+// Разбирает тело запроса действия игрока. Тело, которое не принял
+// ParseActionFast, разбирается как JSON полностью. При ошибке возвращает
+// std::nullopt.
+std::optional<PlayerAction> ParseAction(std::string_view body);
+
+// Разбирает тело пакетного запроса: JSON-массив объектов с полями token и
+// move. Команды применяются в момент обработки запроса, поэтому поле time
+// не поддерживается, и команда с ним считается неверной. Пустой массив,
+// массив длиннее kMaxBatchActions или неверная команда делают неверным весь
+// запрос: в этом случае возвращается std::nullopt.
+std::optional<std::vector<BatchAction>> ParseBatchActions(
+    std::string_view body);
+
+}  // namespace http_handler
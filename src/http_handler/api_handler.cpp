@@ -1,38 +1,209 @@
 #include "api_handler.h"
 
+#include <algorithm>
 #include <optional>
+#include <unordered_map>
 
 namespace http_handler {
 
+namespace {
+
+// Сравнивает строки за время, зависящее только от их длины, чтобы по времени
+// ответа нельзя было подобрать секрет побайтно.
+bool IsEqualConstantTime(std::string_view lhs, std::string_view rhs) noexcept {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  unsigned char diff = 0;
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    diff |= static_cast<unsigned char>(lhs[i] ^ rhs[i]);
+  }
+  return diff == 0;
+}
+
+}  // namespace
+
 // Если application->IsTickerSet() == false, то добавляется дополнительный
 // обработчик тиков (используется при обращении к /api/v1/game/tick).
-ApiHandler::ApiHandler(std::shared_ptr<app::Application> application,
-                       bool randomize_spawn_points, bool is_ticker_set)
-    : application_(std::move(application)),
+ApiHandler::ApiHandler(net::any_io_executor executor,
+                       std::shared_ptr<app::Application> application,
+                       bool randomize_spawn_points, bool is_ticker_set,
+                       std::string admin_token,
+                       model::Dimension view_radius,
+                       std::size_t compression_threshold)
+    : executor_(std::move(executor)),
+      application_(std::move(application)),
+      maps_response_(ApiSerializer::SerializeMaps(application_->GetMaps())),
       randomize_spawn_points_(randomize_spawn_points),
-      is_ticker_set_(is_ticker_set) {
-  handler_storage_[std::string(endpoint_storage::kApiV1Map)] =
-      &ApiHandler::HandleMapEndpoint;
-  handler_storage_[std::string(endpoint_storage::kApiV1Maps)] =
-      &ApiHandler::HandleMapsEndpoint;
-  handler_storage_[std::string(endpoint_storage::kApiV1GameJoin)] =
-      &ApiHandler::HandleJoinEndpoint;
-  handler_storage_[std::string(endpoint_storage::kApiV1GamePlayers)] =
-      &ApiHandler::HandlePlayersEndpoint;
-  handler_storage_[std::string(endpoint_storage::kApiV1GameState)] =
-      &ApiHandler::HandleStateEndpoint;
-  handler_storage_[std::string(endpoint_storage::kApiV1GamePlayerAction)] =
-      &ApiHandler::HandleActionEndpoint;
-  handler_storage_[std::string(endpoint_storage::kApiV1GameRecords)] =
-      &ApiHandler::HandleRecordsEndpoint;
+      is_ticker_set_(is_ticker_set),
+      admin_authorization_(admin_token.empty() ? ""s
+                                               : "Bearer "s + admin_token),
+      view_radius_(view_radius),
+      compression_threshold_(compression_threshold) {
+  for (const auto& map : application_->GetMaps()) {
+    map_responses_.emplace(map.GetId(),
+                           CachedResponse(ApiSerializer::SerializeMap(&map)));
+  }
+  constexpr MethodSet get_methods{http::verb::get, http::verb::head};
+  constexpr MethodSet post_methods{http::verb::post};
+  constexpr MethodSet admin_methods{http::verb::get, http::verb::head,
+                                    http::verb::post};
+  auto route = [this](Endpoint endpoint) -> std::optional<Route>& {
+    return routes_[static_cast<std::size_t>(endpoint)];
+  };
+
+  route(Endpoint::kMap) = Route{
+      {AllowMethods(get_methods)}, &ApiHandler::HandleMapEndpoint};
+  route(Endpoint::kMaps) = Route{
+      {AllowMethods(get_methods)}, &ApiHandler::HandleMapsEndpoint};
+  route(Endpoint::kGameJoin) = Route{
+      {AllowMethods(post_methods),
+       ParseRequestData(&ApiHandler::ParseJoinData)},
+      &ApiHandler::HandleJoinEndpoint};
+  route(Endpoint::kGamePlayers) = Route{
+      {AllowMethods(get_methods), RequirePlayerToken()},
+      &ApiHandler::HandlePlayersEndpoint};
+  route(Endpoint::kGameState) = Route{
+      {AllowMethods(get_methods), RequirePlayerToken()},
+      &ApiHandler::HandleStateEndpoint};
+  route(Endpoint::kGamePlayerAction) = Route{
+      {AllowMethods(post_methods), RequirePlayerToken(),
+       ParsePlayerAction()},
+      &ApiHandler::HandleActionEndpoint,
+      kSmallBodyLimit};
+  route(Endpoint::kGamePlayerActions) = Route{
+      {AllowMethods(post_methods), ParseBatchActions()},
+      &ApiHandler::HandleBatchActionEndpoint,
+      kBatchBodyLimit};
+  route(Endpoint::kGameRecords) = Route{
+      {AllowMethods(get_methods),
+       ParseRequestData(&ApiHandler::ParseRecordsData)},
+      &ApiHandler::HandleRecordsEndpoint};
   if (!is_ticker_set_) {
-    handler_storage_[std::string(endpoint_storage::kApiV1GameTick)] =
-        &ApiHandler::HandleTickEndpoint;
+    route(Endpoint::kGameTick) = Route{
+        {AllowMethods(post_methods),
+         ParseRequestData(&ApiHandler::ParseTickData)},
+        &ApiHandler::HandleTickEndpoint,
+        kSmallBodyLimit};
+  }
+  if (!admin_authorization_.empty()) {
+    route(Endpoint::kAdminLog) = Route{
+        {RequireAdminToken(), AllowMethods(admin_methods)},
+        &ApiHandler::HandleAdminLogEndpoint};
+    route(Endpoint::kAdminProfiler) = Route{
+        {RequireAdminToken(), AllowMethods(admin_methods)},
+        &ApiHandler::HandleAdminProfilerEndpoint};
   }
 }
 
-std::string ApiHandler::ClearTarget(std::string_view target) {
-  return std::string(target.substr(0, target.rfind('?')));
+std::string_view ApiHandler::GetEndpointName(std::string_view target) const {
+  auto match = MatchRoute(target);
+  if (!match) {
+    return "other"sv;
+  }
+  if (match->endpoint == Endpoint::kMap) {
+    return "/api/v1/maps/{id}"sv;
+  }
+  if (!routes_[static_cast<std::size_t>(match->endpoint)]) {
+    return "other"sv;
+  }
+  return kEndpointPaths[static_cast<std::size_t>(match->endpoint)];
+}
+
+std::uint64_t ApiHandler::GetBodyLimit(
+    std::string_view target) const noexcept {
+  auto match = MatchRoute(target);
+  if (!match || !routes_[static_cast<std::size_t>(match->endpoint)]) {
+    return kSmallBodyLimit;
+  }
+  return routes_[static_cast<std::size_t>(match->endpoint)]->body_limit;
+}
+
+ApiHandler::Middleware ApiHandler::AllowMethods(MethodSet methods) const {
+  return [this, methods](
+             RequestContext& context) -> std::optional<StringResponse> {
+    if (auto response = CheckHttpMethod(context.req.method(), methods,
+                                        context.http_version,
+                                        context.keep_alive);
+        response.result() == http::status::method_not_allowed) {
+      return response;
+    }
+    return std::nullopt;
+  };
+}
+
+ApiHandler::Middleware ApiHandler::RequirePlayerToken() const {
+  return [this](RequestContext& context) -> std::optional<StringResponse> {
+    auto player = CheckToken(context.req);
+    if (player.first.result() == http::status::unauthorized) {
+      return std::move(player.first);
+    }
+    context.player = player.second;
+    return std::nullopt;
+  };
+}
+
+ApiHandler::Middleware ApiHandler::RequireAdminToken() const {
+  return [this](RequestContext& context) -> std::optional<StringResponse> {
+    if (auto response = CheckAdminToken(context.req);
+        response.result() == http::status::unauthorized) {
+      return response;
+    }
+    return std::nullopt;
+  };
+}
+
+ApiHandler::Middleware ApiHandler::ParseRequestData(
+    ParserPointer parser) const {
+  return [this,
+          parser](RequestContext& context) -> std::optional<StringResponse> {
+    auto parse_response = (this->*parser)(context.req, context.http_version,
+                                          context.keep_alive);
+    if (parse_response.first.result() == http::status::bad_request) {
+      return std::move(parse_response.first);
+    }
+    context.data = std::move(parse_response.second);
+    return std::nullopt;
+  };
+}
+
+ApiHandler::Middleware ApiHandler::ParsePlayerAction() const {
+  return [this](RequestContext& context) -> std::optional<StringResponse> {
+    auto parse_response = ParseActionData(context.req, context.http_version,
+                                          context.keep_alive);
+    if (parse_response.first.result() == http::status::bad_request) {
+      return std::move(parse_response.first);
+    }
+    context.action = parse_response.second;
+    return std::nullopt;
+  };
+}
+
+ApiHandler::Middleware ApiHandler::ParseBatchActions() const {
+  return [this](RequestContext& context) -> std::optional<StringResponse> {
+    auto parse_response = ParseBatchActionData(
+        context.req, context.http_version, context.keep_alive);
+    if (parse_response.first.result() == http::status::bad_request) {
+      return std::move(parse_response.first);
+    }
+    context.batch_actions = std::move(parse_response.second);
+    return std::nullopt;
+  };
+}
+
+net::awaitable<ApiHandler::StringResponse> ApiHandler::RunCoroutineHandler(
+    CoroutineHandlerPointer handler, StringRequest request,
+    RequestContext context) {
+  RequestContext request_context(request, std::move(context));
+  co_return co_await (this->*handler)(request_context);
+}
+
+void ApiHandler::LogException(const std::exception& ex) {
+  if (logger::ShouldLog(logger::LogEvent::kError)) {
+    logger::Log(
+        json::value{{"code"s, EXIT_FAILURE}, {"exception"s, ex.what()}},
+        "Internel Server Error"sv);
+  }
 }
 
 std::pair<ApiHandler::StringResponse, const app::Player*>
@@ -58,18 +229,24 @@ ApiHandler::CheckToken(const ApiHandler::StringRequest& req) const {
   return std::make_pair(error_message, nullptr);
 }
 
+ApiHandler::StringResponse ApiHandler::CheckAdminToken(
+    const StringRequest& req) const {
+  if (!IsEqualConstantTime(req["Authorization"sv], admin_authorization_)) {
+    return ApiUnauthorized(
+        ApiSerializer::SerializeError(common_response_codes::kInvalidToken,
+                                      "Invalid authorization token"sv),
+        req.version(), req.keep_alive());
+  }
+  return {};
+}
+
 ApiHandler::StringResponse ApiHandler::CheckHttpMethod(
-    http::verb received_method, const std::vector<http::verb>& expected_methods,
+    http::verb received_method, MethodSet expected_methods,
     std::uint32_t http_version, bool keep_alive) const {
-  std::string expected_methods_str;
-  for (auto& method : expected_methods) {
-    expected_methods_str += (expected_methods_str.empty())
-                                ? http::to_string(method)
-                                : ", "s.append(http::to_string(method));
-    if (received_method == method) {
-      return {};
-    }
+  if (expected_methods.Contains(received_method)) {
+    return {};
   }
+  auto expected_methods_str = expected_methods.ToString();
   return ApiMethodNotAllowed(
       ApiSerializer::SerializeError(
           common_response_codes::kInvalidMethod,
@@ -110,43 +287,6 @@ std::pair<ApiHandler::StringResponse, json::value> ApiHandler::ParseJoinData(
   return std::make_pair(error_message, json_request_content);
 }
 
-std::pair<ApiHandler::StringResponse, json::value> ApiHandler::ParseActionData(
-    const ApiHandler::StringRequest& req, std::uint32_t http_version,
-    bool keep_alive) const {
-  sys::error_code ec;
-  json::value json_request_content = json::parse(req.body(), ec);
-  StringResponse error_message;
-  if (req["Content-Type"sv].empty() ||
-      req["Content-Type"sv] != ContentType::kApplicationJson) {
-    error_message = std::move(ApiBadRequest(
-        ApiSerializer::SerializeError(common_response_codes::kInvalidArgument,
-                                      "Invalid content type"sv),
-        http_version, keep_alive));
-    return std::make_pair(error_message, json::value());
-  }
-  if (ec) {
-    error_message = std::move(
-        ApiBadRequest(ApiSerializer::SerializeError(
-                          common_response_codes::kInvalidArgument,
-                          "Failed to parse the action request JSON"sv),
-                      http_version, keep_alive));
-    return std::make_pair(error_message, json::value());
-  }
-  if (auto movement = json_request_content.as_object().if_contains("move"s);
-      !movement ||
-      (!std::regex_match(json_loader::JsonObjectToString(*movement),
-                         std::regex("[LRUD]"s)) &&
-       !movement->as_string().empty())) {
-    error_message = std::move(
-        ApiBadRequest(ApiSerializer::SerializeError(
-                          common_response_codes::kInvalidArgument,
-                          "Failed to parse the action request JSON"sv),
-                      http_version, keep_alive));
-    return std::make_pair(error_message, json::value());
-  }
-  return std::make_pair(error_message, json_request_content);
-}
-
 std::optional<std::string> FindParam(std::string_view target,
                                      const std::string& param) {
   size_t params_start = target.find(param, target.find('?'));
@@ -164,7 +304,7 @@ std::optional<std::string> FindParam(std::string_view target,
   return std::string(target.begin() + begin, target.begin() + end);
 }
 
-std::pair<ApiHandler::StringResponse, json::object>
+std::pair<ApiHandler::StringResponse, json::value>
 ApiHandler::ParseRecordsData(const StringRequest& req,
                              std::uint32_t http_version,
                              bool keep_alive) const {
@@ -177,14 +317,16 @@ ApiHandler::ParseRecordsData(const StringRequest& req,
     try {
       request_data["start"s] = std::stoll(start_param_opt.value());
     } catch (std::exception& ex) {
-        logger::Log(
-            json::value{{"code"s, EXIT_FAILURE}, {"exception"s, ex.what()}},
-            "error");
+        if (logger::ShouldLog(logger::LogEvent::kError)) {
+          logger::Log(
+              json::value{{"code"s, EXIT_FAILURE}, {"exception"s, ex.what()}},
+              "error");
+        }
         error_message = std::move(ApiBadRequest(
             ApiSerializer::SerializeError(common_response_codes::kInvalidArgument,
                                           "Failed to parse start parameter"sv),
             http_version, keep_alive));
-        return std::make_pair(error_message, json::object());
+        return std::make_pair(error_message, json::value());
     }
   }
 
@@ -196,18 +338,72 @@ ApiHandler::ParseRecordsData(const StringRequest& req,
         throw std::runtime_error("maxItems greater than 100"s);
       }
     } catch (std::exception& ex) {
-        logger::Log(
-            json::value{{"code"s, EXIT_FAILURE}, {"exception"s, ex.what()}},
-            "error");
+        if (logger::ShouldLog(logger::LogEvent::kError)) {
+          logger::Log(
+              json::value{{"code"s, EXIT_FAILURE}, {"exception"s, ex.what()}},
+              "error");
+        }
         error_message = std::move(ApiBadRequest(
             ApiSerializer::SerializeError(common_response_codes::kInvalidArgument,
                                           "Failed to parse maxItems parameter"sv),
             http_version, keep_alive));
-        return std::make_pair(error_message, json::object());
+        return std::make_pair(error_message, json::value());
     }
   }
 
-  return std::make_pair(error_message, request_data);
+  return std::make_pair(error_message, json::value(std::move(request_data)));
+}
+
+std::pair<ApiHandler::StringResponse, PlayerAction>
+ApiHandler::ParseActionData(const ApiHandler::StringRequest& req,
+                            std::uint32_t http_version,
+                            bool keep_alive) const {
+  StringResponse error_message;
+  if (req["Content-Type"sv].empty() ||
+      req["Content-Type"sv] != ContentType::kApplicationJson) {
+    error_message = std::move(ApiBadRequest(
+        ApiSerializer::SerializeError(common_response_codes::kInvalidArgument,
+                                      "Invalid content type"sv),
+        http_version, keep_alive));
+    return std::make_pair(std::move(error_message), PlayerAction{});
+  }
+  auto action = ParseAction(req.body());
+  if (!action) {
+    error_message = std::move(
+        ApiBadRequest(ApiSerializer::SerializeError(
+                          common_response_codes::kInvalidArgument,
+                          "Failed to parse the action request JSON"sv),
+                      http_version, keep_alive));
+    return std::make_pair(std::move(error_message), PlayerAction{});
+  }
+  return std::make_pair(std::move(error_message), *action);
+}
+
+std::pair<ApiHandler::StringResponse, std::vector<BatchAction>>
+ApiHandler::ParseBatchActionData(const ApiHandler::StringRequest& req,
+                                 std::uint32_t http_version,
+                                 bool keep_alive) const {
+  StringResponse error_message;
+  if (req["Content-Type"sv].empty() ||
+      req["Content-Type"sv] != ContentType::kApplicationJson) {
+    error_message = std::move(ApiBadRequest(
+        ApiSerializer::SerializeError(common_response_codes::kInvalidArgument,
+                                      "Invalid content type"sv),
+        http_version, keep_alive));
+    return std::make_pair(std::move(error_message),
+                          std::vector<BatchAction>());
+  }
+  auto batch_actions = http_handler::ParseBatchActions(req.body());
+  if (!batch_actions) {
+    error_message = std::move(
+        ApiBadRequest(ApiSerializer::SerializeError(
+                          common_response_codes::kInvalidArgument,
+                          "Failed to parse the batch action request JSON"sv),
+                      http_version, keep_alive));
+    return std::make_pair(std::move(error_message),
+                          std::vector<BatchAction>());
+  }
+  return std::make_pair(std::move(error_message), std::move(*batch_actions));
 }
 
 std::pair<ApiHandler::StringResponse, json::value> ApiHandler::ParseTickData(
@@ -273,43 +469,22 @@ ApiHandler::FindPlayerByMapIdAndUsername(const model::Map::Id& map_id,
   return std::make_pair(error_message, nullptr);
 }
 
-ApiHandler::StringResponse ApiHandler::HandleMapEndpoint(
-    ApiHandler::StringRequest&& req) {
-  std::uint32_t http_version = req.version();
-  bool keep_alive = req.keep_alive();
-
-  if (auto check_http_method_response = CheckHttpMethod(
-          req.method(),
-          std::vector<http::verb>{http::verb::get, http::verb::head},
-          http_version, keep_alive);
-      check_http_method_response.result() == http::status::method_not_allowed) {
-    return check_http_method_response;
-  }
-  std::string map_name(req.target().substr(endpoint_storage::kApiV1Map.size()));
-  if (auto map = application_->GetMapById(model::Map::Id(map_name))) {
-    return ApiOkRequest(ApiSerializer::SerializeMap(map), http_version,
-                        keep_alive);
+ApiHandler::CachedResult ApiHandler::HandleMapEndpoint(
+    RequestContext& context) {
+  if (auto it = map_responses_.find(
+          model::Map::Id(std::string(context.path_param)));
+      it != map_responses_.end()) {
+    return ApiCachedResponse(it->second, context.req);
   }
   return ApiNotFound(
       ApiSerializer::SerializeError(common_response_codes::kMapNotFound,
                                     "Map not found"sv),
-      http_version, keep_alive);
+      context.http_version, context.keep_alive);
 }
 
-ApiHandler::StringResponse ApiHandler::HandleMapsEndpoint(
-    ApiHandler::StringRequest&& req) {
-  std::uint32_t http_version = req.version();
-  bool keep_alive = req.keep_alive();
-
-  if (auto check_http_method_response = CheckHttpMethod(
-          req.method(),
-          std::vector<http::verb>{http::verb::get, http::verb::head},
-          http_version, keep_alive);
-      check_http_method_response.result() == http::status::method_not_allowed) {
-    return check_http_method_response;
-  }
-  return ApiOkRequest(ApiSerializer::SerializeMaps(application_->GetMaps()),
-                      http_version, keep_alive);
+ApiHandler::CachedResult ApiHandler::HandleMapsEndpoint(
+    RequestContext& context) {
+  return ApiCachedResponse(maps_response_, context.req);
 }
 
 // В процессе подключения к игре пытается найти такого игрока, который участвует
@@ -318,218 +493,300 @@ ApiHandler::StringResponse ApiHandler::HandleMapsEndpoint(
 // user_name.
 // В случае успеха пользователь подключается в качестве найденного игрока.
 // В случае неудачи пользователь подключается в качестве нового игрока.
-ApiHandler::StringResponse ApiHandler::HandleJoinEndpoint(
-    ApiHandler::StringRequest&& req) {
-  std::uint32_t http_version = req.version();
-  bool keep_alive = req.keep_alive();
-
-  if (auto check_http_method_response = CheckHttpMethod(
-          req.method(), std::vector<http::verb>{http::verb::post}, http_version,
-          keep_alive);
-      check_http_method_response.result() == http::status::method_not_allowed) {
-    return check_http_method_response;
-  }
-  auto parse_user_data_response = ParseJoinData(req, http_version, keep_alive);
-  if (parse_user_data_response.first.result() == http::status::bad_request) {
-    return parse_user_data_response.first;
-  }
-  std::string user_name(json_loader::JsonObjectToString(
-      parse_user_data_response.second.at("userName"s)));
-  model::Map::Id map_id(json_loader::JsonObjectToString(
-      parse_user_data_response.second.at("mapId"s)));
-  if (auto map = application_->GetMapById(map_id)) {
-    if (auto find_player_response = FindPlayerByMapIdAndUsername(
-            map_id, user_name, http_version, keep_alive);
-        find_player_response.first.result() != http::status::bad_request) {
-      return ApiOkRequest(
-          ApiSerializer::SerializeJoinResponse(find_player_response.second),
-          http_version, keep_alive);
-    }
-    auto find_game_session_response =
-        FindFirstGameSessionByMapId(map_id, http_version, keep_alive);
-    if (find_game_session_response.first.result() ==
-        http::status::internal_server_error) {
-      return find_game_session_response.first;
-    }
-    if (auto player = application_->JoinToGameSession(
-            user_name, find_game_session_response.second->GetId(),
-            map->GenerateRandomPosition(randomize_spawn_points_));
-        player) {
-      return ApiOkRequest(ApiSerializer::SerializeJoinResponse(player),
-                          http_version, keep_alive);
-    } else {
-      return ApiInternalServerError(
-          ApiSerializer::SerializeError(common_response_codes::kServerError,
-                                        "Failed to join to the game"sv),
-          http_version, keep_alive);
-    }
-  } else {
-    return ApiNotFound(
+net::awaitable<ApiHandler::StringResponse> ApiHandler::HandleJoinEndpoint(
+    RequestContext& context) {
+  std::uint32_t http_version = context.http_version;
+  bool keep_alive = context.keep_alive;
+
+  std::string user_name(
+      json_loader::JsonObjectToString(context.data.at("userName"s)));
+  model::Map::Id map_id(
+      json_loader::JsonObjectToString(context.data.at("mapId"s)));
+  auto map = application_->GetMapById(map_id);
+  if (!map) {
+    co_return ApiNotFound(
         ApiSerializer::SerializeError(common_response_codes::kMapNotFound,
                                       "Failed to find the map"sv),
         http_version, keep_alive);
   }
+  if (auto find_player_response = FindPlayerByMapIdAndUsername(
+          map_id, user_name, http_version, keep_alive);
+      find_player_response.first.result() != http::status::bad_request) {
+    co_return ApiOkRequest(
+        ApiSerializer::SerializeJoinResponse(find_player_response.second),
+        http_version, keep_alive);
+  }
+  auto find_game_session_response =
+      FindFirstGameSessionByMapId(map_id, http_version, keep_alive);
+  if (find_game_session_response.first.result() ==
+      http::status::internal_server_error) {
+    co_return std::move(find_game_session_response.first);
+  }
+  if (auto player = co_await application_->AsyncJoinToGameSession(
+          std::move(user_name), find_game_session_response.second->GetId(),
+          map->GenerateRandomPosition(randomize_spawn_points_),
+          net::use_awaitable)) {
+    co_return ApiOkRequest(ApiSerializer::SerializeJoinResponse(player),
+                           http_version, keep_alive);
+  }
+  co_return ApiInternalServerError(
+      ApiSerializer::SerializeError(common_response_codes::kServerError,
+                                    "Failed to join to the game"sv),
+      http_version, keep_alive);
 }
 
 ApiHandler::StringResponse ApiHandler::HandlePlayersEndpoint(
-    ApiHandler::StringRequest&& req) {
-  std::uint32_t http_version = req.version();
-  bool keep_alive = req.keep_alive();
-
-  if (auto check_http_method_response = CheckHttpMethod(
-          req.method(),
-          std::vector<http::verb>{http::verb::get, http::verb::head},
-          http_version, keep_alive);
-      check_http_method_response.result() == http::status::method_not_allowed) {
-    return check_http_method_response;
-  }
-  auto player = CheckToken(req);
-  if (player.first.result() == http::status::unauthorized) {
-    return player.first;
-  }
-  if (auto game_session =
-          application_->GetGameSessionById(player.second->GetGameSessionId())) {
+    RequestContext& context) {
+  if (auto game_session = application_->GetGameSessionById(
+          context.player->GetGameSessionId())) {
     auto players =
         application_->GetPlayersByGameSessionId(game_session->GetId());
-    return ApiOkRequest(
-        ApiSerializer::SerializePlayersInGameSession(game_session, players),
-        http_version, keep_alive);
+    return ApiNegotiatedOkRequest(
+        context,
+        [&] {
+          return ApiSerializer::SerializePlayersInGameSession(game_session,
+                                                              players);
+        },
+        [&] {
+          return ApiSerializer::SerializePlayersInGameSessionBinary(
+              game_session, players);
+        });
   }
   return ApiNotFound(
       ApiSerializer::SerializeError(common_response_codes::kNotFound,
                                     "Failed to find a game session"sv),
-      http_version, keep_alive);
+      context.http_version, context.keep_alive);
 }
 
 ApiHandler::StringResponse ApiHandler::HandleStateEndpoint(
-    ApiHandler::StringRequest&& req) {
-  std::uint32_t http_version = req.version();
-  bool keep_alive = req.keep_alive();
-
-  if (auto check_http_method_response = CheckHttpMethod(
-          req.method(),
-          std::vector<http::verb>{http::verb::get, http::verb::head},
-          http_version, keep_alive);
-      check_http_method_response.result() == http::status::method_not_allowed) {
-    return check_http_method_response;
-  }
-  auto player = CheckToken(req);
-  if (player.first.result() == http::status::unauthorized) {
-    return player.first;
-  }
+    RequestContext& context) {
   auto game_session =
-      application_->GetGameSessionById(player.second->GetGameSessionId());
+      application_->GetGameSessionById(context.player->GetGameSessionId());
   if (game_session) {
     auto players =
         application_->GetPlayersByGameSessionId(game_session->GetId());
-    return ApiOkRequest(ApiSerializer::SerializeState(game_session, players),
-                        http_version, keep_alive);
+    std::optional<ApiSerializer::ViewArea> view_area;
+    if (view_radius_ > 0) {
+      if (auto dog = game_session->GetDogById(context.player->GetDogId())) {
+        view_area = {dog->GetCurrentPosition(), view_radius_};
+      }
+    }
+    return ApiNegotiatedOkRequest(
+        context,
+        [&] {
+          return ApiSerializer::SerializeState(game_session, players,
+                                               view_area);
+        },
+        [&] {
+          return ApiSerializer::SerializeStateBinary(game_session, players,
+                                                     view_area);
+        });
   }
   return ApiNotFound(
       ApiSerializer::SerializeError(common_response_codes::kNotFound,
                                     "Failed to find a game session"sv),
-      http_version, keep_alive);
+      context.http_version, context.keep_alive);
 }
 
-ApiHandler::StringResponse ApiHandler::HandleActionEndpoint(
-    ApiHandler::StringRequest&& req) {
-  std::uint32_t http_version = req.version();
-  bool keep_alive = req.keep_alive();
+net::awaitable<ApiHandler::StringResponse> ApiHandler::HandleActionEndpoint(
+    RequestContext& context) {
+  if (co_await application_->AsyncMovePlayer(
+          context.player->GetGameSessionId(), context.player->GetDogId(),
+          context.action.direction, net::use_awaitable)) {
+    co_return ApiOkRequest(json::serialize(json::object()),
+                           context.http_version, context.keep_alive);
+  }
+  co_return ApiInternalServerError(
+      ApiSerializer::SerializeError(common_response_codes::kServerError,
+                                    "Failed to move player"sv),
+      context.http_version, context.keep_alive);
+}
 
-  if (auto check_http_method_response = CheckHttpMethod(
-          req.method(), std::vector<http::verb>{http::verb::post}, http_version,
-          keep_alive);
-      check_http_method_response.result() == http::status::method_not_allowed) {
-    return check_http_method_response;
+net::awaitable<ApiHandler::StringResponse>
+ApiHandler::HandleBatchActionEndpoint(RequestContext& context) {
+  // Номер группы команд игровой сессии в sessions по id сессии.
+  using SessionIndices =
+      std::unordered_map<model::GameSession::Id, std::size_t,
+                         util::TaggedHasher<model::GameSession::Id>>;
+
+  const auto& batch_actions = context.batch_actions;
+  std::vector<std::size_t> failed;
+  std::vector<app::Application::SessionMovements> sessions;
+  // Индексы команд каждой группы в запросе.
+  std::vector<std::vector<std::size_t>> action_indices;
+  SessionIndices session_indices;
+  for (std::size_t i = 0; i < batch_actions.size(); ++i) {
+    const auto* player =
+        application_->GetPlayerByToken(app::Token(batch_actions[i].token));
+    if (!player) {
+      failed.push_back(i);
+      continue;
+    }
+    auto [it, inserted] = session_indices.try_emplace(
+        player->GetGameSessionId(), sessions.size());
+    if (inserted) {
+      sessions.push_back({player->GetGameSessionId(), {}});
+      action_indices.emplace_back();
+    }
+    sessions[it->second].movements.push_back(
+        {player->GetDogId(), batch_actions[i].action.direction});
+    action_indices[it->second].push_back(i);
+  }
+
+  // Группы всех сессий запускаются сразу и обрабатываются параллельно.
+  auto results = co_await application_->AsyncMovePlayers(std::move(sessions),
+                                                         net::use_awaitable);
+  std::size_t applied = 0;
+  for (std::size_t group = 0; group < action_indices.size(); ++group) {
+    const auto& indices = action_indices[group];
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+      if (group < results.size() && i < results[group].size() &&
+          results[group][i]) {
+        ++applied;
+      } else {
+        failed.push_back(indices[i]);
+      }
+    }
   }
-  auto player = CheckToken(req);
-  if (player.first.result() == http::status::unauthorized) {
-    return player.first;
+  std::sort(failed.begin(), failed.end());
+  json::array failed_indices;
+  for (auto index : failed) {
+    failed_indices.emplace_back(index);
   }
-  auto parse_action_data_response =
-      ParseActionData(req, http_version, keep_alive);
-  if (parse_action_data_response.first.result() == http::status::bad_request) {
-    return parse_action_data_response.first;
+  co_return ApiOkRequest(
+      json::serialize(json::object{{"applied"s, applied},
+                                   {"failed"s, std::move(failed_indices)}}),
+      context.http_version, context.keep_alive);
+}
+
+net::awaitable<ApiHandler::StringResponse> ApiHandler::HandleRecordsEndpoint(
+    RequestContext& context) {
+  const auto& request_data = context.data.as_object();
+  const auto start_param = request_data.contains("start"s)
+                               ? request_data.at("start"s).as_int64()
+                               : 0;
+  const auto max_items_param = request_data.contains("maxItems"s)
+                                   ? request_data.at("maxItems"s).as_int64()
+                                   : 50;
+
+  auto retired_dogs = co_await application_->AsyncGetRetiredPlayers(
+      start_param, max_items_param, net::use_awaitable);
+  co_return ApiOkRequest(
+      ApiSerializer::SerializeRecordsResponse(retired_dogs),
+      context.http_version, context.keep_alive);
+}
+
+net::awaitable<ApiHandler::StringResponse> ApiHandler::HandleTickEndpoint(
+    RequestContext& context) {
+  std::chrono::milliseconds time_delta(
+      context.data.at("timeDelta"s).as_int64());
+  if (co_await application_->AsyncUpdateAllGameSessions(time_delta,
+                                                         net::use_awaitable) &&
+      co_await application_->AsyncSaveGameState(net::use_awaitable)) {
+    co_return ApiOkRequest(json::serialize(json::object()),
+                           context.http_version, context.keep_alive);
+  }
+  co_return ApiInternalServerError(
+      ApiSerializer::SerializeError(common_response_codes::kServerError,
+                                    "Failed to update game state"sv),
+      context.http_version, context.keep_alive);
+}
+
+ApiHandler::StringResponse ApiHandler::ApplyLogSettings(
+    const StringRequest& req, std::uint32_t http_version,
+    bool keep_alive) const {
+  auto bad_request = [this, http_version, keep_alive](std::string_view text) {
+    return ApiBadRequest(
+        ApiSerializer::SerializeError(common_response_codes::kInvalidArgument,
+                                      text),
+        http_version, keep_alive);
+  };
+  sys::error_code ec;
+  json::value settings = json::parse(req.body(), ec);
+  if (ec || !settings.is_object()) {
+    return bad_request("Failed to parse log settings JSON"sv);
   }
-  std::string movement(json_loader::JsonObjectToString(
-      parse_action_data_response.second.at("move"s)));
-  if (application_->MovePlayer(player.second->GetGameSessionId(),
-                               player.second->GetDogId(), movement)) {
-    return ApiOkRequest(json::serialize(json::object()), http_version,
-                        keep_alive);
+
+  std::optional<logger::LogLevel> level;
+  if (auto level_value = settings.as_object().if_contains("level"s)) {
+    if (level_value->is_string()) {
+      level = logger::ParseLogLevel(level_value->as_string());
+    }
+    if (!level) {
+      return bad_request("Invalid log level"sv);
+    }
   }
-  return ApiInternalServerError(
-      ApiSerializer::SerializeError(common_response_codes::kServerError,
-                                    "Failed to move player"sv),
-      http_version, keep_alive);
+
+  std::vector<std::pair<logger::LogEvent, double>> rates;
+  if (auto sampling = settings.as_object().if_contains("sampling"s)) {
+    if (!sampling->is_object()) {
+      return bad_request("Invalid log sampling"sv);
+    }
+    for (const auto& [name, rate] : sampling->as_object()) {
+      auto event = logger::ParseLogEvent(name);
+      if (!event || !rate.is_number() || rate.to_number<double>() < 0 ||
+          rate.to_number<double>() > 1) {
+        return bad_request("Invalid log sampling"sv);
+      }
+      rates.emplace_back(*event, rate.to_number<double>());
+    }
+  }
+
+  if (level) {
+    logger::SetLogLevel(*level);
+  }
+  for (auto [event, rate] : rates) {
+    logger::SetSamplingRate(event, rate);
+  }
+  return {};
 }
 
-ApiHandler::StringResponse ApiHandler::HandleRecordsEndpoint(
-    StringRequest&& req) {
-  std::uint32_t http_version = req.version();
-  bool keep_alive = req.keep_alive();
+ApiHandler::StringResponse ApiHandler::HandleAdminLogEndpoint(
+    RequestContext& context) {
+  if (context.req.method() == http::verb::post) {
+    if (auto apply_response = ApplyLogSettings(
+            context.req, context.http_version, context.keep_alive);
+        apply_response.result() == http::status::bad_request) {
+      return apply_response;
+    }
+  }
+  return ApiOkRequest(ApiSerializer::SerializeLogSettings(),
+                      context.http_version, context.keep_alive);
+}
 
-  if (auto check_http_method_response = CheckHttpMethod(
-          req.method(),
-          std::vector<http::verb>{http::verb::get, http::verb::head},
+ApiHandler::StringResponse ApiHandler::HandleAdminProfilerEndpoint(
+    RequestContext& context) {
+  const auto& req = context.req;
+  std::uint32_t http_version = context.http_version;
+  bool keep_alive = context.keep_alive;
+
+  auto& profiler = application_->GetTickProfiler();
+  if (req.method() == http::verb::post) {
+    sys::error_code ec;
+    json::value settings = json::parse(req.body(), ec);
+    const json::value* tracing = nullptr;
+    if (!ec && settings.is_object()) {
+      tracing = settings.as_object().if_contains("tracing"s);
+    }
+    if (!tracing || !tracing->is_bool()) {
+      return ApiBadRequest(
+          ApiSerializer::SerializeError(common_response_codes::kInvalidArgument,
+                                        "Invalid profiler settings"sv),
           http_version, keep_alive);
-      check_http_method_response.result() == http::status::method_not_allowed) {
-    return check_http_method_response;
-  }
-  auto parse_records_data_response =
-      ParseRecordsData(req, http_version, keep_alive);
-  if (parse_records_data_response.first.result() == http::status::bad_request) {
-    return parse_records_data_response.first;
-  }
-  const auto start_param =
-      parse_records_data_response.second.contains("start"s)
-          ? parse_records_data_response.second.at("start"s).as_int64()
-          : 0;
-  const auto max_items_param =
-      parse_records_data_response.second.contains("maxItems"s)
-          ? parse_records_data_response.second.at("maxItems"s).as_int64()
-          : 50;
-
-  auto retired_dogs =
-      application_->GetRetiredPlayers(start_param, max_items_param);
-  return ApiOkRequest(ApiSerializer::SerializeRecordsResponse(retired_dogs),
-                      http_version, keep_alive);
-}
-
-ApiHandler::StringResponse ApiHandler::HandleTickEndpoint(
-    ApiHandler::StringRequest&& req) {
-  std::uint32_t http_version = req.version();
-  bool keep_alive = req.keep_alive();
-
-  if (auto check_http_method_response = CheckHttpMethod(
-          req.method(), std::vector<http::verb>{http::verb::post}, http_version,
-          keep_alive);
-      check_http_method_response.result() == http::status::method_not_allowed) {
-    return check_http_method_response;
-  }
-  auto parse_tick_data_response = ParseTickData(req, http_version, keep_alive);
-  if (parse_tick_data_response.first.result() == http::status::bad_request) {
-    return parse_tick_data_response.first;
-  }
-  std::chrono::milliseconds time_delta(
-      parse_tick_data_response.second.at("timeDelta"s).as_int64());
-  if (application_->UpdateAllGameSessions(time_delta) &&
-      application_->SaveGameState()) {
-    return ApiOkRequest(json::serialize(json::object()), http_version,
-                        keep_alive);
+    }
+    profiler.SetTracing(tracing->as_bool());
+  } else if (FindParam(req.target(), "format"s) == "trace"s) {
+    return ApiOkRequest(profiler.GetChromeTrace(), http_version, keep_alive);
   }
-  return ApiInternalServerError(
-      ApiSerializer::SerializeError(common_response_codes::kServerError,
-                                    "Failed to update game state"sv),
-      http_version, keep_alive);
+  return ApiOkRequest(json::serialize(profiler.GetSummary()), http_version,
+                      keep_alive);
 }
 
-ApiHandler::StringResponse ApiHandler::ApiOkRequest(std::string&& message,
-                                                    std::uint32_t http_version,
-                                                    bool keep_alive) const {
+ApiHandler::StringResponse ApiHandler::ApiOkRequest(
+    std::string&& message, std::uint32_t http_version, bool keep_alive,
+    std::string_view content_type) const {
   return OkRequest<http::string_body>(std::move(message), http_version,
-                                      keep_alive,
-                                      ContentType::kApplicationJson);
+                                      keep_alive, content_type);
 }
 
 ApiHandler::StringResponse ApiHandler::ApiBadRequest(std::string&& message,
@@ -569,4 +826,46 @@ ApiHandler::StringResponse ApiHandler::ApiInternalServerError(
                                                 ContentType::kApplicationJson);
 }
 
+ApiHandler::CachedBodyResponse ApiHandler::ApiCachedResponse(
+    const CachedResponse& response, const StringRequest& req) const {
+  auto encoding =
+      util::NegotiateContentEncoding(req[http::field::accept_encoding]);
+  if (response.IsNotModified(req[http::field::if_none_match], encoding)) {
+    return NotModified<http::span_body<const char>>(
+        response.GetEtag(encoding), req.version(), req.keep_alive());
+  }
+  const auto& body = response.GetBody(encoding);
+  auto result = OkRequest<http::span_body<const char>>(
+      beast::span<const char>(body.data(), body.size()), req.version(),
+      req.keep_alive(), ContentType::kApplicationJson);
+  result.set(http::field::etag, response.GetEtag(encoding));
+  result.set(http::field::vary, "Accept-Encoding"sv);
+  if (encoding != util::ContentEncoding::kIdentity) {
+    result.set(http::field::content_encoding, util::ToString(encoding));
+  }
+  return result;
+}
+
+ApiHandler::StringResponse ApiHandler::CompressResponse(
+    StringResponse&& response, util::ContentEncoding encoding) const {
+  if (response.body().size() < compression_threshold_ ||
+      response.count(http::field::content_encoding)) {
+    return std::move(response);
+  }
+  // Тело ответа зависит от Accept-Encoding, даже если клиент не принимает
+  // сжатые ответы.
+  if (auto vary = response[http::field::vary]; vary.empty()) {
+    response.set(http::field::vary, "Accept-Encoding"sv);
+  } else {
+    response.set(http::field::vary, std::string(vary) + ", Accept-Encoding"s);
+  }
+  if (encoding == util::ContentEncoding::kIdentity) {
+    return std::move(response);
+  }
+  response.body() = CompressBody(response.body(), encoding);
+  response.set(http::field::content_encoding, util::ToString(encoding));
+  response.prepare_payload();
+  return std::move(response);
+}
+
 }  // namespace http_handler
@@ -1,10 +1,20 @@
 #pragma once
 
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/use_awaitable.hpp>
 #include <boost/beast/http.hpp>
+#include <array>
 #include <boost/json.hpp>
-#include <regex>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
 #include <string>
 #include <utility>
+#include <variant>
+#include <vector>
 
 #include "../../lib/json_loader/json_loader.h"
 #include "../../lib/model/model.h"
@@ -12,8 +22,11 @@
 #include "../app/player.h"
 #include "../app/players_table.h"
 #include "../logger/logger.h"
+#include "action_parser.h"
 #include "api_serializer.h"
+#include "cached_response.h"
 #include "response_generators.h"
+#include "route_table.h"
 
 namespace http_handler {
 
@@ -36,11 +49,73 @@ inline constexpr std::string_view kApiV1GamePlayers = "/api/v1/game/players"sv;
 inline constexpr std::string_view kApiV1GameState = "/api/v1/game/state"sv;
 inline constexpr std::string_view kApiV1GamePlayerAction =
     "/api/v1/game/player/action"sv;
+inline constexpr std::string_view kApiV1GamePlayerActions =
+    "/api/v1/game/player/actions"sv;
 inline constexpr std::string_view kApiV1GameRecords = "/api/v1/game/records"sv;
 inline constexpr std::string_view kApiV1GameTick = "/api/v1/game/tick"sv;
 
+inline constexpr std::string_view kApiV1AdminLog = "/api/v1/admin/log"sv;
+inline constexpr std::string_view kApiV1AdminProfiler =
+    "/api/v1/admin/profiler"sv;
+
 }  // namespace endpoint_storage
 
+// Конечные точки API. Порядок совпадает с порядком путей в kEndpointPaths.
+enum class Endpoint : std::uint8_t {
+  kMaps,
+  kMap,
+  kGameJoin,
+  kGamePlayers,
+  kGameState,
+  kGamePlayerAction,
+  kGamePlayerActions,
+  kGameRecords,
+  kGameTick,
+  kAdminLog,
+  kAdminProfiler,
+};
+
+inline constexpr std::array<std::string_view, 11> kEndpointPaths{
+    endpoint_storage::kApiV1Maps,
+    endpoint_storage::kApiV1Map,
+    endpoint_storage::kApiV1GameJoin,
+    endpoint_storage::kApiV1GamePlayers,
+    endpoint_storage::kApiV1GameState,
+    endpoint_storage::kApiV1GamePlayerAction,
+    endpoint_storage::kApiV1GamePlayerActions,
+    endpoint_storage::kApiV1GameRecords,
+    endpoint_storage::kApiV1GameTick,
+    endpoint_storage::kApiV1AdminLog,
+    endpoint_storage::kApiV1AdminProfiler,
+};
+
+inline constexpr std::size_t kNumOfEndpoints = kEndpointPaths.size();
+
+inline constexpr PerfectHashTable kEndpointTable(kEndpointPaths);
+
+// Конечная точка, найденная по target запроса.
+struct RouteMatch {
+  Endpoint endpoint;
+  // Параметр пути: для kMap - id карты, для остальных точек пуст.
+  std::string_view path_param;
+};
+
+// Находит конечную точку по target запроса. Параметры запроса (после '?')
+// не учитываются. Возвращаемый path_param ссылается на target.
+// Не выделяет память.
+constexpr std::optional<RouteMatch> MatchRoute(
+    std::string_view target) noexcept {
+  auto path = target.substr(0, target.find('?'));
+  if (auto index = kEndpointTable.Find(path)) {
+    return RouteMatch{static_cast<Endpoint>(*index), {}};
+  }
+  if (path.starts_with(endpoint_storage::kApiV1Map)) {
+    return RouteMatch{Endpoint::kMap,
+                      path.substr(endpoint_storage::kApiV1Map.size())};
+  }
+  return std::nullopt;
+}
+
 namespace common_response_codes {
 
 inline constexpr std::string_view kBadRequest = "badRequest"sv;
@@ -55,58 +130,218 @@ inline constexpr std::string_view kServerError = "serverError"sv;
 }  // namespace common_response_codes
 
 // Обрабатывает запросы клиентов к API.
+//
+// Каждой конечной точке соответствует маршрут (Route): цепочка
+// промежуточных обработчиков (Middleware) и сам обработчик. Промежуточные
+// обработчики проверяют HTTP-метод и токен авторизации и разбирают данные
+// запроса, дополняя ими RequestContext. Если проверка не пройдена, ответ с
+// ошибкой отправляется сразу, и обработчик не вызывается.
+//
+// Обработчики, которым нужно дождаться strand игровой сессии или базы данных,
+// являются корутинами (net::awaitable) и запускаются через net::co_spawn на
+// executor. Пока корутина ждет, поток не блокируется. Остальные обработчики
+// выполняются сразу, без co_spawn, чтобы не тратить на них лишний переход
+// через очередь executor.
 class ApiHandler {
  public:
   using StringRequest = http::request<http::string_body>;
   using StringResponse = http::response<http::string_body>;
-
-  // Заполняет словарь handler_storage_ связками конечных точек с их
-  // обработчиками (кроме kApiV1Map, так как эта точка обрабатывается отдельно).
-  explicit ApiHandler(std::shared_ptr<app::Application> application,
-                      bool randomize_spawn_points, bool is_ticker_set);
+  // Ответ, тело которого ссылается на тело CachedResponse без копирования.
+  // CachedResponse хранятся в ApiHandler, который живет дольше сервера.
+  using CachedBodyResponse = http::response<http::span_body<const char>>;
+
+  // Заполняет словарь routes_ маршрутами конечных точек.
+  // Карты не меняются после загрузки игры, поэтому ответы kApiV1Maps и
+  // kApiV1Map сериализуются и сжимаются один раз при конструировании.
+  // Административные конечные точки добавляются, только если задан
+  // admin_token. Если view_radius > 0, в состояние игры попадают только
+  // объекты на расстоянии не больше view_radius от собаки игрока.
+  // Ответы обработчиков размером от compression_threshold байт сжимаются
+  // кодировкой, выбранной по заголовку Accept-Encoding.
+  explicit ApiHandler(net::any_io_executor executor,
+                      std::shared_ptr<app::Application> application,
+                      bool randomize_spawn_points, bool is_ticker_set,
+                      std::string admin_token, model::Dimension view_radius,
+                      std::size_t compression_threshold);
   ApiHandler(const ApiHandler&) = delete;
   ApiHandler& operator=(const ApiHandler&) = delete;
 
-  // Исходя из значения req.target() находит соответствующий обработчик запроса
-  // и вызывает его в случае успеха.
-  // Если такой обработчик не найден, проверят req.target() на соответствие
-  // конченой точке kApiV1Map и вызывает соответствующий обработчик в случае
-  // успеха.
-  // Иначе отправляет BadRequest.
+  // Возвращает имя конечной точки для метрик: путь без параметров запроса
+  // для известных конечных точек, "/api/v1/maps/{id}" для kApiV1Map и
+  // "other" для остальных. Так число значений метки остается ограниченным.
+  std::string_view GetEndpointName(std::string_view target) const;
+
+  // Возвращает допустимый размер тела запроса к конечной точке target.
+  // Вызывается сервером после чтения заголовков, до чтения тела.
+  std::uint64_t GetBodyLimit(std::string_view target) const noexcept;
+
+  // Исходя из значения req.target() находит соответствующий маршрут (см.
+  // MatchRoute), пропускает запрос через его промежуточные обработчики и
+  // вызывает обработчик маршрута. Ответ обработчика сжимается (см.
+  // CompressResponse).
+  // Если маршрут не найден или отключен, отправляет BadRequest.
   template <typename Send>
   void operator()(StringRequest&& req, Send&& send) {
+    RequestContext context(req);
     try {
-      std::string target = ClearTarget(req.target());
-      if (auto it = handler_storage_.find(target);
-          it != handler_storage_.end()) {
-        auto handler = it->second;
-        return send(std::move((this->*handler)(std::move(req))));
-      } else if (target.starts_with(endpoint_storage::kApiV1Map)) {
-        auto handler =
-            handler_storage_[std::string(endpoint_storage::kApiV1Map)];
-        return send(std::move((this->*handler)(std::move(req))));
+      auto encoding = util::NegotiateContentEncoding(
+          context.req[http::field::accept_encoding]);
+      auto match = MatchRoute(context.req.target());
+      if (!match || !routes_[static_cast<std::size_t>(match->endpoint)]) {
+        return send(std::move(ApiBadRequest(
+            ApiSerializer::SerializeError(common_response_codes::kBadRequest,
+                                          "Invalid endpoint"sv),
+            context.http_version, context.keep_alive)));
+      }
+      context.path_param = match->path_param;
+      const Route& route = *routes_[static_cast<std::size_t>(match->endpoint)];
+      for (const auto& middleware : route.middlewares) {
+        if (auto response = middleware(context)) {
+          return send(std::move(*response));
+        }
+      }
+      if (auto handler = std::get_if<HandlerPointer>(&route.handler)) {
+        return send(
+            CompressResponse((this->*(*handler))(context), encoding));
+      }
+      if (auto handler = std::get_if<CachedHandlerPointer>(&route.handler)) {
+        auto result = (this->*(*handler))(context);
+        if (auto response = std::get_if<CachedBodyResponse>(&result)) {
+          return send(std::move(*response));
+        }
+        return send(CompressResponse(
+            std::get<StringResponse>(std::move(result)), encoding));
       }
-      return send(std::move(ApiBadRequest(
-          ApiSerializer::SerializeError(common_response_codes::kBadRequest,
-                                        "Invalid endpoint"sv),
-          req.version(), req.keep_alive())));
+      auto http_version = context.http_version;
+      auto keep_alive = context.keep_alive;
+      // Корутина может пережить этот вызов, поэтому получает свою копию
+      // запроса. Запрос сессии остается на месте, и его буферы используются
+      // для следующего запроса соединения.
+      net::co_spawn(
+          executor_,
+          RunCoroutineHandler(std::get<CoroutineHandlerPointer>(route.handler),
+                              StringRequest(context.req), std::move(context)),
+          [this, send, http_version, keep_alive, encoding](
+              std::exception_ptr exception, StringResponse response) mutable {
+            if (!exception) {
+              return send(CompressResponse(std::move(response), encoding));
+            }
+            try {
+              std::rethrow_exception(exception);
+            } catch (const std::exception& ex) {
+              LogException(ex);
+            }
+            send(ApiInternalServerError(
+                ApiSerializer::SerializeError(
+                    common_response_codes::kServerError, "InternalServerError"),
+                http_version, keep_alive));
+          });
     } catch (std::exception& ex) {
-      logger::Log(
-          json::value{{"code"s, EXIT_FAILURE}, {"exception"s, ex.what()}},
-          "Internel Server Error"sv);
+      LogException(ex);
       return send(std::move(ApiInternalServerError(
           ApiSerializer::SerializeError(common_response_codes::kServerError,
                                         "InternalServerError"),
-          req.version(), req.keep_alive())));
+          context.http_version, context.keep_alive)));
     }
   }
 
  private:
-  using HandlerPointer = StringResponse (ApiHandler::*)(StringRequest&&);
-  using HandlerStorage = std::unordered_map<std::string, HandlerPointer>;
+  // Данные запроса, которые обработчик получает от промежуточных
+  // обработчиков. Ссылается на запрос сессии, не копируя его.
+  struct RequestContext {
+    explicit RequestContext(const StringRequest& request)
+        : req(request),
+          http_version(req.version()),
+          keep_alive(req.keep_alive()) {}
+
+    // Переносит данные context в контекст запроса request - копии
+    // context.req.
+    RequestContext(const StringRequest& request, RequestContext&& context)
+        : req(request),
+          http_version(context.http_version),
+          keep_alive(context.keep_alive),
+          player(context.player),
+          data(std::move(context.data)),
+          action(context.action),
+          batch_actions(std::move(context.batch_actions)) {
+      if (!context.path_param.empty()) {
+        auto offset = static_cast<std::size_t>(context.path_param.data() -
+                                               context.req.target().data());
+        path_param = req.target().substr(offset, context.path_param.size());
+      }
+    }
 
-  // Возвращает URL, очищенный от параметров запроса.
-  std::string ClearTarget(std::string_view target);
+    const StringRequest& req;
+    std::uint32_t http_version;
+    bool keep_alive;
+    // Игрок, чей токен проверен RequirePlayerToken.
+    const app::Player* player = nullptr;
+    // Данные запроса, разобранные ParseRequestData.
+    json::value data;
+    // Команда движения, разобранная ParsePlayerAction.
+    PlayerAction action;
+    // Команды пакетного запроса, разобранные ParseBatchActions.
+    std::vector<BatchAction> batch_actions;
+    // Параметр пути из RouteMatch. Ссылается на req.target().
+    std::string_view path_param;
+  };
+
+  using HandlerPointer = StringResponse (ApiHandler::*)(RequestContext&);
+  using CoroutineHandlerPointer =
+      net::awaitable<StringResponse> (ApiHandler::*)(RequestContext&);
+  // Обработчик, который отдает готовый ответ из кеша (CachedBodyResponse)
+  // или сформированный ответ, например, с ошибкой.
+  using CachedResult = std::variant<StringResponse, CachedBodyResponse>;
+  using CachedHandlerPointer = CachedResult (ApiHandler::*)(RequestContext&);
+  // Промежуточный обработчик. Возвращает ответ с ошибкой, если запрос не
+  // прошел проверку, и std::nullopt, если обработку можно продолжать.
+  using Middleware =
+      std::function<std::optional<StringResponse>(RequestContext&)>;
+  using ParserPointer = std::pair<StringResponse, json::value> (
+      ApiHandler::*)(const StringRequest&, std::uint32_t, bool) const;
+
+  // Размеры тела запроса: по умолчанию и для конечных точек, которые
+  // принимают короткий JSON (kGamePlayerAction, kGameTick) или не принимают
+  // тело совсем (неизвестные и отключенные конечные точки).
+  static constexpr std::uint64_t kDefaultBodyLimit = 16 * 1024;
+  static constexpr std::uint64_t kSmallBodyLimit = 256;
+  // Размер тела пакетного запроса с kMaxBatchActions командами.
+  static constexpr std::uint64_t kBatchBodyLimit = 128 * 1024;
+
+  struct Route {
+    std::vector<Middleware> middlewares;
+    std::variant<HandlerPointer, CoroutineHandlerPointer, CachedHandlerPointer>
+        handler;
+    std::uint64_t body_limit = kDefaultBodyLimit;
+  };
+
+  // Маршруты, индексируемые Endpoint. Отключенные конечные точки пусты.
+  using Routes = std::array<std::optional<Route>, kNumOfEndpoints>;
+  using MapResponses =
+      std::unordered_map<model::Map::Id, CachedResponse,
+                         util::TaggedHasher<model::Map::Id>>;
+
+  // Промежуточные обработчики.
+  // Проверяет, что HTTP-метод запроса входит в methods.
+  Middleware AllowMethods(MethodSet methods) const;
+  // Проверяет токен игрока и записывает найденного игрока в context.player.
+  Middleware RequirePlayerToken() const;
+  // Проверяет токен администратора.
+  Middleware RequireAdminToken() const;
+  // Разбирает данные запроса функцией parser и записывает их в context.data.
+  Middleware ParseRequestData(ParserPointer parser) const;
+  // Разбирает команду движения и записывает ее в context.action.
+  Middleware ParsePlayerAction() const;
+  // Разбирает команды пакетного запроса и записывает их в
+  // context.batch_actions.
+  Middleware ParseBatchActions() const;
+
+  // Хранит context в кадре корутины, пока его использует handler.
+  net::awaitable<StringResponse> RunCoroutineHandler(
+      CoroutineHandlerPointer handler, StringRequest request,
+      RequestContext context);
+
+  static void LogException(const std::exception& ex);
 
   // Проверяет тип токена авторизации игрока и его длину.
   // Если токен авторизации неверен, возвращает ответ со статусом
@@ -114,14 +349,19 @@ class ApiHandler {
   std::pair<StringResponse, const app::Player*> CheckToken(
       const StringRequest& req) const;
 
+  // Проверяет токен администратора в заголовке Authorization.
+  // Если токен неверен, возвращает ответ со статусом
+  // http::status::unauthorized.
+  StringResponse CheckAdminToken(const StringRequest& req) const;
+
   // Проверяет, удовлетворяет ли HTTP-метод запроса ожидаемым HTTP-методам
   // определенного endpoint.
   // В случае ошибки, возвращает ответ со статуcом
   // http::status::method_not_allowed.
-  StringResponse CheckHttpMethod(
-      http::verb received_method,
-      const std::vector<http::verb>& expected_methods,
-      std::uint32_t http_version, bool keep_alive) const;
+  StringResponse CheckHttpMethod(http::verb received_method,
+                                 MethodSet expected_methods,
+                                 std::uint32_t http_version,
+                                 bool keep_alive) const;
 
   // Парсят данные запросов в формате JSON.
   // В случае неверных данных возвращают ответ со статусом
@@ -129,15 +369,25 @@ class ApiHandler {
   std::pair<StringResponse, json::value> ParseJoinData(
       const StringRequest& req, std::uint32_t http_version,
       bool keep_alive) const;
-  std::pair<StringResponse, json::value> ParseActionData(
+  std::pair<StringResponse, json::value> ParseRecordsData(
       const StringRequest& req, std::uint32_t http_version,
       bool keep_alive) const;
-  std::pair<StringResponse, json::object> ParseRecordsData(
+  std::pair<StringResponse, json::value> ParseTickData(
       const StringRequest& req, std::uint32_t http_version,
       bool keep_alive) const;
-  std::pair<StringResponse, json::value> ParseTickData(
+  // Разбирает тело запроса действия игрока без построения json::value, если
+  // тело имеет канонический вид.
+  std::pair<StringResponse, PlayerAction> ParseActionData(
+      const StringRequest& req, std::uint32_t http_version,
+      bool keep_alive) const;
+  std::pair<StringResponse, std::vector<BatchAction>> ParseBatchActionData(
       const StringRequest& req, std::uint32_t http_version,
       bool keep_alive) const;
+  // Разбирает и применяет настройки логирования. Настройки применяются,
+  // только если все они корректны.
+  StringResponse ApplyLogSettings(const StringRequest& req,
+                                  std::uint32_t http_version,
+                                  bool keep_alive) const;
 
   // Находит игровую сессию с id карты равным map_id. Если такой сессии нет,
   // создает новую сессию.
@@ -167,7 +417,9 @@ class ApiHandler {
   //  - Content-Length: <body_size>;
   //  - Тело ответа:  JSON-описание карты с указанным id, семантически
   //    эквивалентное представлению карты из конфигурационного файла.
-  StringResponse HandleMapEndpoint(StringRequest&& req);
+  //
+  // Ответ отдается из кеша (см. ApiCachedResponse).
+  CachedResult HandleMapEndpoint(RequestContext& context);
 
   // Обрабатывает конечную точку kApiV1Maps для получения информации о картах.
   // Параметры запроса:
@@ -182,7 +434,9 @@ class ApiHandler {
   //                 полями:
   //    > id - идентификатор карты;
   //    > name - название карты
-  StringResponse HandleMapsEndpoint(StringRequest&& req);
+  //
+  // Ответ отдается из кеша (см. ApiCachedResponse).
+  CachedResult HandleMapsEndpoint(RequestContext& context);
 
   // Обрабатывает конечную точку kApiV1GameJoin для присоединения к игре.
   //
@@ -203,7 +457,7 @@ class ApiHandler {
   //    > playerId - целое число, задающее id игрока;
   //    > authToken - токен для авторизации в игре - строка, состоящая из
   //    32 случайных шестнадцатеричных цифр.
-  StringResponse HandleJoinEndpoint(StringRequest&& req);
+  net::awaitable<StringResponse> HandleJoinEndpoint(RequestContext& context);
 
   // Обрабатывает конечную точку kApiV1GamePlayers для получения информации об
   // игроках.
@@ -223,7 +477,11 @@ class ApiHandler {
   //    карте. Значение каждого из этих ключей - JSON-объект с единственным
   //    полем name, задающим имя пользователя, под которым он вошёл в
   //    игру.
-  StringResponse HandlePlayersEndpoint(StringRequest&& req);
+  //
+  // Если заголовок Accept предпочитает application/vnd.dog-story.binary,
+  // тело передается в двоичном формате (см.
+  // ApiSerializer::SerializePlayersInGameSessionBinary).
+  StringResponse HandlePlayersEndpoint(RequestContext& context);
 
   // Обрабатывает конечную точку kApiV1GameState для получении информации об
   // состоянии игровой сессии, в которой находится игрок.
@@ -254,7 +512,14 @@ class ApiHandler {
   //                    игровой сессии и не являются собранными:
   //      > type - тип потерянного предмета;
   //      > pos - позиция потерянного предмета.
-  StringResponse HandleStateEndpoint(StringRequest&& req);
+  //
+  // Если задан view_radius_, players и lostObjects содержат только объекты
+  // на расстоянии не больше view_radius_ от собаки игрока.
+  //
+  // Если заголовок Accept предпочитает application/vnd.dog-story.binary,
+  // тело передается в двоичном формате (см.
+  // ApiSerializer::SerializeStateBinary).
+  StringResponse HandleStateEndpoint(RequestContext& context);
 
   // Обрабатывает конечную точку kApiV1GamePlayerAction для изменения
   // направления игрока.
@@ -279,7 +544,40 @@ class ApiHandler {
   //  - Content-Length: <body_size>;
   //  - Cache-Control: no-cache;
   //  - Тело ответа: пустой JSON-объект.
-  StringResponse HandleActionEndpoint(StringRequest&& req);
+  net::awaitable<StringResponse> HandleActionEndpoint(
+      RequestContext& context);
+
+  // Обрабатывает конечную точку kApiV1GamePlayerActions для изменения
+  // направления нескольких игроков одним запросом (боты, нагрузочные тесты,
+  // воспроизведение записанных игр).
+  //
+  // Параметры запроса:
+  //  - HTTP-методы: POST;
+  //  - Headers:
+  //    > Content-Type: application/json.
+  //  - Тело запроса: JSON-массив (не более kMaxBatchActions элементов)
+  //                  JSON-объектов с полями:
+  //    > token - токен авторизации игрока;
+  //    > move - направление, как в kApiV1GamePlayerAction.
+  //  Команды не привязываются ко времени: объект с полем time отклоняется.
+  //
+  // Команды группируются по игровым сессиям. Команды одной сессии
+  // применяются в порядке запроса за один переход в strand сессии, поэтому
+  // из нескольких команд одного игрока действует последняя. Группы разных
+  // сессий обрабатываются параллельно.
+  //
+  // В случае успеха должен возвращаться ответ, обладающий следующими
+  // свойствами:
+  //  - Статус-код: 200 OK;
+  //  - Content-Type: application/json;
+  //  - Content-Length: <body_size>;
+  //  - Cache-Control: no-cache;
+  //  - Тело ответа: JSON-объект:
+  //    > applied - количество примененных команд;
+  //    > failed - JSON-массив индексов команд, которые не удалось применить
+  //               (неизвестный токен или собака уже покинула игру).
+  net::awaitable<StringResponse> HandleBatchActionEndpoint(
+      RequestContext& context);
 
   // Обрабатывает конечную точку kApiV1GameRecords для получения списка
   // рекордсменов.
@@ -306,7 +604,8 @@ class ApiHandler {
   //    > score - число, задающее количество очков игрока;
   //    > playTime - время в секундах, которое игрок провёл в игре с момента
   //                 входа до момента выхода из игры.
-  StringResponse HandleRecordsEndpoint(StringRequest&& req);
+  net::awaitable<StringResponse> HandleRecordsEndpoint(
+      RequestContext& context);
 
   // Обрабатывает конечную точку kApiV1GameTick для обновления состояния всех
   // игровых сессий.
@@ -325,11 +624,80 @@ class ApiHandler {
   //  - Content-Length: <body_size>;
   //  - Cache-Control: no-cache;
   //  - Тело ответа: пустой JSON-объект.
-  StringResponse HandleTickEndpoint(StringRequest&& req);
+  net::awaitable<StringResponse> HandleTickEndpoint(RequestContext& context);
+
+  // Обрабатывает конечную точку kApiV1AdminLog для просмотра и изменения
+  // настроек логирования во время работы сервера.
+  //
+  // Параметры запроса:
+  //  - HTTP-методы: GET, HEAD, POST;
+  //  - Headers:
+  //    > Authorization: Bearer <admin_token>.
+  //  - Тело POST-запроса: JSON-объект с необязательными полями:
+  //    > level - минимальный уровень сообщений: "debug", "info", "warning",
+  //              "error" или "off";
+  //    > sampling - JSON-объект, ключами которого являются типы сообщений
+  //                 ("request", "response", "error", "server"), а
+  //                 значениями - доли выводимых сообщений от 0 до 1.
+  //
+  // В случае успеха должен возвращаться ответ, обладающий следующими
+  // свойствами:
+  //  - Статус-код: 200 OK;
+  //  - Content-Type: application/json;
+  //  - Cache-Control: no-cache;
+  //  - Тело ответа: JSON-объект с текущими настройками в том же формате.
+  StringResponse HandleAdminLogEndpoint(RequestContext& context);
+
+  // Обрабатывает конечную точку kApiV1AdminProfiler для получения статистики
+  // профилировщика тиков.
+  //
+  // Параметры запроса:
+  //  - HTTP-методы: GET, HEAD, POST;
+  //  - Headers:
+  //    > Authorization: Bearer <admin_token>.
+  //  - Query Parameters:
+  //    > format - если равен "trace", возвращаются события, записанные при
+  //               включенной трассировке, в формате Chrome trace-event JSON.
+  //  - Тело POST-запроса: JSON-объект с полем tracing (bool), включающим или
+  //                       выключающим запись trace-событий.
+  //
+  // В случае успеха должен возвращаться ответ, обладающий следующими
+  // свойствами:
+  //  - Статус-код: 200 OK;
+  //  - Content-Type: application/json;
+  //  - Cache-Control: no-cache;
+  //  - Тело ответа: JSON-объект:
+  //    > tracing - включена ли запись trace-событий;
+  //    > sessions - JSON-объект, ключами которого являются идентификаторы
+  //                 игровых сессий:
+  //      > tick - длительность всего тика сессии;
+  //      > phases - JSON-объект с длительностями отдельных фаз тика.
+  //      Длительности описываются полями count, p50, p90, p99 и max (в
+  //      миллисекундах) за последние 256 тиков.
+  StringResponse HandleAdminProfilerEndpoint(RequestContext& context);
 
   // Функции, отвечающие за формирование ответов для запросов к API.
-  StringResponse ApiOkRequest(std::string&& message, std::uint32_t http_version,
-                              bool keep_alive) const;
+  StringResponse ApiOkRequest(
+      std::string&& message, std::uint32_t http_version, bool keep_alive,
+      std::string_view content_type = ContentType::kApplicationJson) const;
+  // Возвращает ответ с телом в формате, выбранном по заголовку Accept:
+  // serialize_binary() для двоичного формата, иначе serialize_json().
+  template <typename SerializeJson, typename SerializeBinary>
+  StringResponse ApiNegotiatedOkRequest(
+      const RequestContext& context, SerializeJson&& serialize_json,
+      SerializeBinary&& serialize_binary) const {
+    auto response =
+        ContentType::IsPreferredOverJson(
+            context.req[http::field::accept],
+            ContentType::kApplicationDogStoryBinary)
+            ? ApiOkRequest(serialize_binary(), context.http_version,
+                           context.keep_alive,
+                           ContentType::kApplicationDogStoryBinary)
+            : ApiOkRequest(serialize_json(), context.http_version,
+                           context.keep_alive);
+    response.set(http::field::vary, "Accept"sv);
+    return response;
+  }
   StringResponse ApiBadRequest(std::string&& message,
                                std::uint32_t http_version,
                                bool keep_alive) const;
@@ -346,11 +714,32 @@ class ApiHandler {
                                         std::uint32_t http_version,
                                         bool keep_alive) const;
 
+  // Формирует ответ из заранее подготовленного тела без его копирования.
+  // Выбирает кодировку тела по заголовку Accept-Encoding. Если ETag тела в
+  // этой кодировке совпадает со значением If-None-Match, возвращает
+  // 304 Not Modified.
+  CachedBodyResponse ApiCachedResponse(const CachedResponse& response,
+                                       const StringRequest& req) const;
+
+  // Сжимает тело ответа кодировкой encoding. Ответы меньше
+  // compression_threshold_ байт не сжимаются: выигрыш в размере не окупает
+  // затрат на сжатие. Уже сжатые ответы (ApiCachedResponse) не меняются.
+  StringResponse CompressResponse(StringResponse&& response,
+                                  util::ContentEncoding encoding) const;
+
+  net::any_io_executor executor_;
   std::shared_ptr<app::Application> application_;
-  HandlerStorage handler_storage_;
+  Routes routes_;
+  CachedResponse maps_response_;
+  MapResponses map_responses_;
   const std::uint16_t kAuthTokenMinSize = 7;
   bool randomize_spawn_points_;
   bool is_ticker_set_;
+  // Ожидаемое значение заголовка Authorization для административных
+  // запросов ("Bearer <token>"). Пустое, если токен не задан.
+  std::string admin_authorization_;
+  model::Dimension view_radius_;
+  std::size_t compression_threshold_;
 };
 
 }  // namespace http_handler
@@ -1,7 +1,87 @@
 #include "api_serializer.h"
 
+#include "binary_writer.h"
+#include "json_writer.h"
+
 namespace http_handler {
 
+namespace {
+
+// Передает write Writer (JsonWriter или BinaryWriter), пишущий в буфер
+// потока, и возвращает копию результата. Буфер переиспользуется между
+// вызовами, поэтому при сериализации он не растет заново.
+template <typename Writer, typename Fn>
+std::string Write(Fn&& write) {
+  thread_local std::string buffer;
+  buffer.clear();
+  Writer writer(buffer);
+  write(writer);
+  return buffer;
+}
+
+template <typename Fn>
+std::string WriteJson(Fn&& write) {
+  return Write<JsonWriter>(std::forward<Fn>(write));
+}
+
+template <typename Fn>
+std::string WriteBinary(Fn&& write) {
+  return Write<BinaryWriter>([&write](BinaryWriter& writer) {
+    writer.Byte(ApiSerializer::kBinaryFormatVersion);
+    write(writer);
+  });
+}
+
+// Игроки и потерянные вещи, которые попадают в ответ с состоянием игры.
+struct VisibleObjects {
+  std::vector<std::pair<const app::Player*, const model::Dog*>> dogs;
+  std::vector<const model::LostObject*> loot;
+};
+
+// Собирает объекты, попадающие в view_area, в буфер потока. Без view_area
+// видны все объекты сессии. Потерянные вещи ищутся по пространственному
+// индексу сессии.
+const VisibleObjects& CollectVisibleObjects(
+    const model::GameSession* game_session,
+    const app::PlayersTable::Players& players,
+    const std::optional<ApiSerializer::ViewArea>& view_area) {
+  thread_local VisibleObjects visible;
+  visible.dogs.clear();
+  visible.loot.clear();
+  for (const auto& player : players) {
+    const auto dog = game_session->GetDogById(player->GetDogId());
+    if (view_area) {
+      auto dx = dog->GetCurrentPosition().x - view_area->center.x;
+      auto dy = dog->GetCurrentPosition().y - view_area->center.y;
+      if (dx * dx + dy * dy > view_area->radius * view_area->radius) {
+        continue;
+      }
+    }
+    visible.dogs.emplace_back(player, dog);
+  }
+  if (view_area) {
+    game_session->ForEachLootInRadius(
+        view_area->center, view_area->radius,
+        [](const model::LostObject& lost_object) {
+          visible.loot.push_back(&lost_object);
+        });
+  } else {
+    for (const auto& lost_object : game_session->GetLoot()) {
+      visible.loot.push_back(&lost_object);
+    }
+  }
+  return visible;
+}
+
+void WritePair(JsonWriter& writer, double first, double second) {
+  writer.BeginArray();
+  writer.Double(first);
+  writer.Double(second);
+  writer.EndArray();
+}
+
+}  // namespace
+
 json::array ApiSerializer::GetJsonRoads(const model::Map::Roads& roads) {
   json::array roads_info;
   for (const auto& road : roads) {
@@ -46,56 +126,6 @@ json::array ApiSerializer::GetJsonOffices(const model::Map::Offices& offices) {
   return offices_info;
 }
 
-json::array ApiSerializer::GetJsonDogBag(const model::Dog::Bag& dog_bag) {
-  json::array dog_bag_info;
-  for (auto& lost_object : dog_bag) {
-    json::object lost_object_info;
-    lost_object_info["id"s] = *lost_object.GetId();
-    lost_object_info["type"s] = lost_object.GetType();
-    dog_bag_info.push_back(lost_object_info);
-  }
-  return dog_bag_info;
-}
-
-json::object ApiSerializer::GetJsonLoot(const model::GameSession::Loot& loot) {
-  json::object loot_info;
-  for (const auto& lost_object : loot) {
-    json::object lost_object_info;
-    model::Point lost_object_position = lost_object.GetPosition();
-    lost_object_info["type"s] = lost_object.GetType();
-    lost_object_info["pos"s] =
-        json::array{lost_object_position.x, lost_object_position.y};
-
-    auto lost_object_id = std::to_string(*lost_object.GetId());
-    loot_info[lost_object_id] = lost_object_info;
-  }
-  return loot_info;
-}
-
-json::object ApiSerializer::GetJsonPlayers(
-    const model::GameSession* game_session,
-    const app::PlayersTable::Players& players) {
-  json::object players_info;
-  for (const auto& player : players) {
-    const auto player_dog = game_session->GetDogById(player->GetDogId());
-    model::Point dog_position = player_dog->GetCurrentPosition();
-    model::Speed dog_speed = player_dog->GetSpeed();
-    model::Direction dog_direction = player_dog->GetDirection();
-
-    json::object player_dog_info;
-    player_dog_info["pos"s] = json::array{dog_position.x, dog_position.y};
-    player_dog_info["speed"s] = json::array{dog_speed.sx, dog_speed.sy};
-    player_dog_info["dir"s] = std::string{static_cast<char>(dog_direction)};
-
-    json::array dog_bag_info = GetJsonDogBag(player_dog->GetBag());
-    player_dog_info["bag"s] = dog_bag_info;
-    player_dog_info["score"s] = player_dog->GetScore();
-    auto player_id = std::to_string(*player->GetId());
-    players_info[player_id] = player_dog_info;
-  }
-  return players_info;
-}
-
 std::string ApiSerializer::SerializeMap(const model::Map* map) {
   json::object map_info;
   map_info["id"s] = *map->GetId();
@@ -103,12 +133,23 @@ std::string ApiSerializer::SerializeMap(const model::Map* map) {
   map_info["roads"s] = GetJsonRoads(map->GetRoads());
   map_info["buildings"s] = GetJsonBuildings(map->GetBuildings());
   map_info["offices"s] = GetJsonOffices(map->GetOffices());
-  auto loot_types =
-      json_loader::LootTypesStorage::GetTypesOfLoots(map->GetId());
-  if (loot_types) {
-    map_info["lootTypes"s] = *loot_types;
+  auto result = json::serialize(map_info);
+  const auto& loot_types = map->GetLootTypes();
+  if (loot_types.empty()) {
+    return result;
   }
-  return json::serialize(map_info);
+  // Типы потерянных предметов сериализованы при загрузке конфига, поэтому
+  // дописываем их готовые байты перед закрывающей скобкой объекта.
+  result.pop_back();
+  result += R"(,"lootTypes":[)"sv;
+  for (size_t i = 0; i < loot_types.size(); ++i) {
+    if (i != 0) {
+      result += ',';
+    }
+    result += loot_types[i].GetJsonFragment();
+  }
+  result += "]}"sv;
+  return result;
 }
 
 std::string ApiSerializer::SerializeMaps(const model::Game::Maps& maps) {
@@ -133,58 +174,178 @@ std::string ApiSerializer::SerializePlayer(const app::Player* player) {
 std::string ApiSerializer::SerializePlayersInGameSession(
     const model::GameSession* game_session,
     const app::PlayersTable::Players& players) {
-  json::object players_info;
-  for (const auto& player : players) {
-    json::object player_info;
-    player_info["name"s] =
-        game_session->GetDogById(player->GetDogId())->GetName();
-
-    auto player_id = std::to_string(*player->GetId());
-    players_info[player_id] = player_info;
-  }
-  return json::serialize(players_info);
+  return WriteJson([&](JsonWriter& writer) {
+    writer.BeginObject();
+    for (const auto& player : players) {
+      writer.Key(*player->GetId());
+      writer.BeginObject();
+      writer.Key("name"sv);
+      writer.String(game_session->GetDogById(player->GetDogId())->GetName());
+      writer.EndObject();
+    }
+    writer.EndObject();
+  });
 }
 
 std::string ApiSerializer::SerializeState(
+    const model::GameSession* game_session,
+    const app::PlayersTable::Players& players,
+    const std::optional<ViewArea>& view_area) {
+  const auto& visible =
+      CollectVisibleObjects(game_session, players, view_area);
+  return WriteJson([&visible](JsonWriter& writer) {
+    writer.BeginObject();
+    writer.Key("players"sv);
+    writer.BeginObject();
+    for (const auto& [player, player_dog] : visible.dogs) {
+      model::Point dog_position = player_dog->GetCurrentPosition();
+      model::Speed dog_speed = player_dog->GetSpeed();
+      auto dog_direction = static_cast<char>(player_dog->GetDirection());
+
+      writer.Key(*player->GetId());
+      writer.BeginObject();
+      writer.Key("pos"sv);
+      WritePair(writer, dog_position.x, dog_position.y);
+      writer.Key("speed"sv);
+      WritePair(writer, dog_speed.sx, dog_speed.sy);
+      writer.Key("dir"sv);
+      writer.String({&dog_direction, 1});
+      writer.Key("bag"sv);
+      writer.BeginArray();
+      for (const auto& lost_object : player_dog->GetBag()) {
+        writer.BeginObject();
+        writer.Key("id"sv);
+        writer.Uint(*lost_object.GetId());
+        writer.Key("type"sv);
+        writer.Uint(lost_object.GetType());
+        writer.EndObject();
+      }
+      writer.EndArray();
+      writer.Key("score"sv);
+      writer.Uint(player_dog->GetScore());
+      writer.EndObject();
+    }
+    writer.EndObject();
+
+    writer.Key("lostObjects"sv);
+    writer.BeginObject();
+    for (const auto& lost_object : visible.loot) {
+      model::Point lost_object_position = lost_object->GetPosition();
+      writer.Key(*lost_object->GetId());
+      writer.BeginObject();
+      writer.Key("type"sv);
+      writer.Uint(lost_object->GetType());
+      writer.Key("pos"sv);
+      WritePair(writer, lost_object_position.x, lost_object_position.y);
+      writer.EndObject();
+    }
+    writer.EndObject();
+    writer.EndObject();
+  });
+}
+
+std::string ApiSerializer::SerializePlayersInGameSessionBinary(
     const model::GameSession* game_session,
     const app::PlayersTable::Players& players) {
-  json::object game_session_info;
+  return WriteBinary([&](BinaryWriter& writer) {
+    writer.Uint(players.size());
+    for (const auto& player : players) {
+      writer.Uint(*player->GetId());
+      writer.String(game_session->GetDogById(player->GetDogId())->GetName());
+    }
+  });
+}
+
+std::string ApiSerializer::SerializeStateBinary(
+    const model::GameSession* game_session,
+    const app::PlayersTable::Players& players,
+    const std::optional<ViewArea>& view_area) {
+  const auto& visible =
+      CollectVisibleObjects(game_session, players, view_area);
+  return WriteBinary([&visible](BinaryWriter& writer) {
+    writer.Uint(visible.dogs.size());
+    for (const auto& [player, player_dog] : visible.dogs) {
+      model::Point dog_position = player_dog->GetCurrentPosition();
+      model::Speed dog_speed = player_dog->GetSpeed();
 
-  json::object players_info = GetJsonPlayers(game_session, players);
-  game_session_info["players"s] = players_info;
+      writer.Uint(*player->GetId());
+      writer.Fixed(dog_position.x);
+      writer.Fixed(dog_position.y);
+      writer.Fixed(dog_speed.sx);
+      writer.Fixed(dog_speed.sy);
+      writer.Byte(static_cast<std::uint8_t>(player_dog->GetDirection()));
+      const auto& bag = player_dog->GetBag();
+      writer.Uint(bag.size());
+      for (const auto& lost_object : bag) {
+        writer.Uint(*lost_object.GetId());
+        writer.Uint(lost_object.GetType());
+      }
+      writer.Uint(player_dog->GetScore());
+    }
 
-  json::object loot_info = GetJsonLoot(game_session->GetLoot());
-  game_session_info["lostObjects"s] = loot_info;
-  return json::serialize(game_session_info);
+    writer.Uint(visible.loot.size());
+    for (const auto& lost_object : visible.loot) {
+      model::Point lost_object_position = lost_object->GetPosition();
+      writer.Uint(*lost_object->GetId());
+      writer.Uint(lost_object->GetType());
+      writer.Fixed(lost_object_position.x);
+      writer.Fixed(lost_object_position.y);
+    }
+  });
 }
 
 std::string ApiSerializer::SerializeJoinResponse(const app::Player* player) {
-  json::object join_response_info;
-  join_response_info["authToken"s] = *player->GetToken();
-  join_response_info["playerId"s] = *player->GetId();
-  return json::serialize(join_response_info);
+  return WriteJson([player](JsonWriter& writer) {
+    writer.BeginObject();
+    writer.Key("authToken"sv);
+    writer.String(*player->GetToken());
+    writer.Key("playerId"sv);
+    writer.Uint(*player->GetId());
+    writer.EndObject();
+  });
 }
 
 std::string ApiSerializer::SerializeRecordsResponse(
     const model::GameSession::RetiredDogs& retired_dogs) {
-  json::array records_info;
-  for (auto& dog : retired_dogs) {
-    json::object retired_dog_info;
-    retired_dog_info["name"s] = dog.GetName();
-    retired_dog_info["score"s] = dog.GetScore();
-    retired_dog_info["playTime"s] =
-        std::chrono::duration_cast<Seconds>(dog.GetPlayTime()).count();
-    records_info.push_back(retired_dog_info);
-  }
-  return json::serialize(records_info);
+  return WriteJson([&retired_dogs](JsonWriter& writer) {
+    writer.BeginArray();
+    for (auto& dog : retired_dogs) {
+      writer.BeginObject();
+      writer.Key("name"sv);
+      writer.String(dog.GetName());
+      writer.Key("score"sv);
+      writer.Uint(dog.GetScore());
+      writer.Key("playTime"sv);
+      writer.Int(
+          std::chrono::duration_cast<Seconds>(dog.GetPlayTime()).count());
+      writer.EndObject();
+    }
+    writer.EndArray();
+  });
 }
 
 std::string ApiSerializer::SerializeError(std::string_view code,
                                           std::string_view message) {
-  json::object error_info;
-  error_info["code"s] = std::string(code);
-  error_info["message"s] = std::string(message);
-  return json::serialize(error_info);
+  return WriteJson([code, message](JsonWriter& writer) {
+    writer.BeginObject();
+    writer.Key("code"sv);
+    writer.String(code);
+    writer.Key("message"sv);
+    writer.String(message);
+    writer.EndObject();
+  });
+}
+
+std::string ApiSerializer::SerializeLogSettings() {
+  json::object sampling;
+  for (std::size_t i = 0; i < logger::kNumOfLogEvents; ++i) {
+    auto event = static_cast<logger::LogEvent>(i);
+    sampling[logger::ToString(event)] = logger::GetSamplingRate(event);
+  }
+  json::object settings;
+  settings["level"s] = logger::ToString(logger::GetLogLevel());
+  settings["sampling"s] = std::move(sampling);
+  return json::serialize(settings);
 }
 
 }  // namespace http_handler
\ No newline at end of file
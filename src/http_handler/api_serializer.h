@@ -2,11 +2,13 @@
 
 #include <boost/json.hpp>
 #include <chrono>
+#include <optional>
 #include <string>
 
-#include "../../lib/json_loader/loot_types_storage.h"
 #include "../../lib/model/model.h"
-#include "../app/application.h"
+#include "../app/player.h"
+#include "../app/players_table.h"
+#include "../logger/log_filter.h"
 
 namespace http_handler {
 
@@ -18,38 +20,67 @@ using namespace std::literals;
 struct ApiSerializer {
   using Seconds = std::chrono::seconds;
 
+  // Версия двоичного формата, записываемая первым байтом двоичных ответов.
+  static constexpr std::uint8_t kBinaryFormatVersion = 1;
+
+  // Область вокруг собаки игрока. Если она задана, в состояние игры попадают
+  // только собаки и потерянные вещи, находящиеся в ней.
+  struct ViewArea {
+    model::Point center;
+    model::Dimension radius;
+  };
+
   ApiSerializer() = delete;
   ApiSerializer(ApiSerializer&) = delete;
   ApiSerializer& operator=(ApiSerializer&) = delete;
   ApiSerializer(ApiSerializer&&) = delete;
   ApiSerializer& operator=(ApiSerializer&&) = delete;
 
-  // GetJson(Roads|Buildings|Offices|DogBag|Loot|Players) отвечают за приведение
-  // массива объектов (Roads|Buildings|Offices|Players) к json::object или
-  // json::array.
+  // GetJson(Roads|Buildings|Offices) отвечают за приведение массива объектов
+  // (Roads|Buildings|Offices) к json::array.
   static json::array GetJsonRoads(const model::Map::Roads& roads);
   static json::array GetJsonBuildings(const model::Map::Buildings& buildings);
   static json::array GetJsonOffices(const model::Map::Offices& offices);
-  static json::array GetJsonDogBag(const model::Dog::Bag& dog_bag);
-  static json::object GetJsonLoot(const model::GameSession::Loot& loot);
-  static json::object GetJsonPlayers(const model::GameSession* game_session,
-                                     const app::PlayersTable::Players& players);
 
   // Serialized(Map|Maps|Player|Players|JoinResponse|RecordResponse|Error)
   // отвечают за создание сериализованных данных для последующей отправки
-  // клиенту.
+  // клиенту. Ответы на частые запросы (состояние игры, список игроков и
+  // т.д.) пишутся потоково через JsonWriter в буфер потока.
   static std::string SerializeMap(const model::Map* map);
   static std::string SerializeMaps(const model::Game::Maps& maps);
   static std::string SerializePlayer(const app::Player* player);
   static std::string SerializePlayersInGameSession(
       const model::GameSession* game_session,
       const app::PlayersTable::Players& players);
-  static std::string SerializeState(const model::GameSession* game_session,
-                                    const app::PlayersTable::Players& players);
+  static std::string SerializeState(
+      const model::GameSession* game_session,
+      const app::PlayersTable::Players& players,
+      const std::optional<ViewArea>& view_area = std::nullopt);
+
+  // Serialize(PlayersInGameSession|State)Binary сериализуют те же данные в
+  // двоичном формате (см. BinaryWriter). Ответ начинается с байта
+  // kBinaryFormatVersion, объекты перечисляются после их количества (Uint).
+  //
+  // Игрок в списке игроков: id (Uint), name (String).
+  // Состояние игры: игроки, затем потерянные вещи.
+  //  - Игрок: id (Uint), pos (2 Fixed), speed (2 Fixed), dir (Byte с
+  //    символом U, D, L или R), bag (предметы: id и type, оба Uint),
+  //    score (Uint).
+  //  - Потерянная вещь: id (Uint), type (Uint), pos (2 Fixed).
+  static std::string SerializePlayersInGameSessionBinary(
+      const model::GameSession* game_session,
+      const app::PlayersTable::Players& players);
+  static std::string SerializeStateBinary(
+      const model::GameSession* game_session,
+      const app::PlayersTable::Players& players,
+      const std::optional<ViewArea>& view_area = std::nullopt);
+
   static std::string SerializeJoinResponse(const app::Player* player);
   static std::string SerializeRecordsResponse(
       const model::GameSession::RetiredDogs& retired_dogs);
   static std::string SerializeError(std::string_view code,
                                     std::string_view message);
+  // Сериализует текущие уровень логирования и доли выводимых сообщений.
+  static std::string SerializeLogSettings();
 };
 }  // namespace http_handler
\ No newline at end of file
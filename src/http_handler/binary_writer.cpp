@@ -0,0 +1,37 @@
+#include "binary_writer.h"
+
+#include <cmath>
+
+namespace http_handler {
+
+BinaryWriter::BinaryWriter(std::string& out) noexcept : out_(out) {}
+
+void BinaryWriter::Byte(std::uint8_t value) {
+  out_ += static_cast<char>(value);
+}
+
+void BinaryWriter::Uint(std::uint64_t value) {
+  while (value >= 0x80) {
+    out_ += static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  out_ += static_cast<char>(value);
+}
+
+void BinaryWriter::Int(std::int64_t value) {
+  // zigzag: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ..., чтобы небольшие
+  // отрицательные числа занимали мало байт.
+  Uint((static_cast<std::uint64_t>(value) << 1) ^
+       static_cast<std::uint64_t>(value >> 63));
+}
+
+void BinaryWriter::Fixed(double value) {
+  Int(std::llround(value * kFixedPointScale));
+}
+
+void BinaryWriter::String(std::string_view value) {
+  Uint(value.size());
+  out_ += value;
+}
+
+}  // namespace http_handler
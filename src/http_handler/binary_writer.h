@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace http_handler {
+
+// Пишет данные в компактном двоичном формате в переданную строку:
+//  - Uint - беззнаковое целое в формате varint (LEB128): по 7 бит на байт,
+//    начиная с младших, старший бит байта означает продолжение;
+//  - Int - знаковое целое в формате zigzag varint;
+//  - Fixed - число с фиксированной точкой: значение, умноженное на
+//    kFixedPointScale и округленное, записанное как Int;
+//  - String - длина строки (Uint) и ее байты.
+class BinaryWriter {
+ public:
+  // Координаты и скорости передаются с точностью до 0.01.
+  static constexpr double kFixedPointScale = 100.0;
+
+  explicit BinaryWriter(std::string& out) noexcept;
+
+  void Byte(std::uint8_t value);
+  void Uint(std::uint64_t value);
+  void Int(std::int64_t value);
+  void Fixed(double value);
+  void String(std::string_view value);
+
+ private:
+  std::string& out_;
+};
+
+}  // namespace http_handler
@@ -0,0 +1,115 @@
+#include "cached_response.h"
+
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+#include "../metrics/server_metrics.h"
+
+namespace http_handler {
+
+// Строгий ETag строится из CRC-32 и размера тела, поэтому одинаковые тела на
+// разных экземплярах сервера получают одинаковый ETag.
+std::string MakeEtag(std::string_view body) {
+  std::ostringstream etag;
+  etag << '"' << std::hex << std::setfill('0') << std::setw(8)
+       << util::Crc32(body) << '-' << body.size() << '"';
+  return etag.str();
+}
+
+std::string MakeEncodedEtag(std::string_view etag,
+                            util::ContentEncoding encoding) {
+  if (encoding == util::ContentEncoding::kIdentity || etag.size() < 2) {
+    return std::string(etag);
+  }
+  etag.remove_suffix(1);
+  std::string result(etag);
+  result += '-';
+  result += util::ToString(encoding);
+  result += '"';
+  return result;
+}
+
+bool IsEtagMatched(std::string_view if_none_match,
+                   std::string_view etag) noexcept {
+  while (!if_none_match.empty()) {
+    auto comma_pos = if_none_match.find(',');
+    auto tag = if_none_match.substr(0, comma_pos);
+    if_none_match.remove_prefix(comma_pos == std::string_view::npos
+                                    ? if_none_match.size()
+                                    : comma_pos + 1);
+    while (!tag.empty() && tag.front() == ' ') {
+      tag.remove_prefix(1);
+    }
+    while (!tag.empty() && tag.back() == ' ') {
+      tag.remove_suffix(1);
+    }
+    if (tag.starts_with("W/"sv)) {
+      tag.remove_prefix(2);
+    }
+    if (tag == "*"sv || tag == etag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string CompressBody(std::string_view body,
+                         util::ContentEncoding encoding) {
+  assert(encoding != util::ContentEncoding::kIdentity);
+  auto start = std::chrono::steady_clock::now();
+  auto result = encoding == util::ContentEncoding::kGzip
+                    ? util::GzipCompress(body)
+                    : util::DeflateCompress(body);
+  auto duration = std::chrono::steady_clock::now() - start;
+
+  auto& server_metrics = metrics::GetServerMetrics();
+  auto label = util::ToString(encoding);
+  server_metrics.compression_duration.WithLabels({label}).ObserveDuration(
+      duration);
+  server_metrics.compression_input_bytes.WithLabels({label}).Inc(body.size());
+  server_metrics.compression_output_bytes.WithLabels({label}).Inc(
+      result.size());
+  return result;
+}
+
+CachedResponse::CachedResponse(std::string body)
+    : body_(std::move(body)),
+      gzip_body_(CompressBody(body_, util::ContentEncoding::kGzip)),
+      deflate_body_(CompressBody(body_, util::ContentEncoding::kDeflate)),
+      etag_(MakeEtag(body_)),
+      gzip_etag_(MakeEncodedEtag(etag_, util::ContentEncoding::kGzip)),
+      deflate_etag_(MakeEncodedEtag(etag_, util::ContentEncoding::kDeflate)) {}
+
+const std::string& CachedResponse::GetBody(
+    util::ContentEncoding encoding) const noexcept {
+  switch (encoding) {
+    case util::ContentEncoding::kGzip:
+      return gzip_body_;
+    case util::ContentEncoding::kDeflate:
+      return deflate_body_;
+    default:
+      return body_;
+  }
+}
+
+const std::string& CachedResponse::GetEtag(
+    util::ContentEncoding encoding) const noexcept {
+  switch (encoding) {
+    case util::ContentEncoding::kGzip:
+      return gzip_etag_;
+    case util::ContentEncoding::kDeflate:
+      return deflate_etag_;
+    default:
+      return etag_;
+  }
+}
+
+bool CachedResponse::IsNotModified(
+    std::string_view if_none_match,
+    util::ContentEncoding encoding) const noexcept {
+  return IsEtagMatched(if_none_match, GetEtag(encoding));
+}
+
+}  // namespace http_handler
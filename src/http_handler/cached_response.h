@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "../../lib/util/compression.h"
+
+namespace http_handler {
+
+using namespace std::literals;
+
+// Строит строгий ETag для тела ответа.
+std::string MakeEtag(std::string_view body);
+
+// Строит ETag сжатого представления из ETag несжатого тела etag, добавляя
+// кодировку ("...-gzip"). Строгий ETag должен различаться для разных
+// Content-Encoding (RFC 9110, 8.8.3), иначе кеш может ответить 304 на
+// запрос другого представления. Для kIdentity возвращает etag.
+std::string MakeEncodedEtag(std::string_view etag,
+                            util::ContentEncoding encoding);
+
+// Проверяет, совпадает ли etag с одним из перечисленных в заголовке
+// If-None-Match (сравнение слабое, как требует RFC 9110).
+bool IsEtagMatched(std::string_view if_none_match,
+                   std::string_view etag) noexcept;
+
+// Сжимает тело ответа кодировкой encoding (kIdentity не поддерживается) и
+// записывает время сжатия и объем данных в метрики
+// game_server_compression_*.
+std::string CompressBody(std::string_view body, util::ContentEncoding encoding);
+
+// Тело ответа, которое не меняется за время работы сервера. Сериализуется один
+// раз и хранит сжатые варианты и их строгие ETag, чтобы запросы к неизменяемым
+// ресурсам обслуживались без повторной сериализации и сжатия.
+class CachedResponse {
+ public:
+  explicit CachedResponse(std::string body);
+
+  // Возвращает тело ответа в указанной кодировке.
+  const std::string& GetBody(util::ContentEncoding encoding) const noexcept;
+
+  // Возвращает ETag тела ответа в указанной кодировке.
+  const std::string& GetEtag(util::ContentEncoding encoding) const noexcept;
+
+  // Проверяет, совпадает ли ETag тела в кодировке encoding с одним из
+  // перечисленных в заголовке If-None-Match.
+  bool IsNotModified(std::string_view if_none_match,
+                     util::ContentEncoding encoding) const noexcept;
+
+ private:
+  std::string body_;
+  std::string gzip_body_;
+  std::string deflate_body_;
+  std::string etag_;
+  std::string gzip_etag_;
+  std::string deflate_etag_;
+};
+
+}  // namespace http_handler
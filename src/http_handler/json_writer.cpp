@@ -0,0 +1,162 @@
+#include "json_writer.h"
+
+#include <cassert>
+#include <charconv>
+
+namespace http_handler {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::string_view kHexDigits = "0123456789abcdef"sv;
+
+bool NeedsEscape(char c) noexcept {
+  return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+template <typename Integer>
+void AppendInteger(std::string& out, Integer value) {
+  std::array<char, 24> buffer;
+  auto [end, ec] =
+      std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+  out.append(buffer.data(), end);
+}
+
+}  // namespace
+
+JsonWriter::JsonWriter(std::string& out) noexcept : out_(out) {}
+
+void JsonWriter::BeginObject() {
+  BeginValue();
+  assert(depth_ < kMaxDepth);
+  out_ += '{';
+  is_first_[depth_++] = true;
+}
+
+void JsonWriter::EndObject() {
+  assert(depth_ > 0);
+  --depth_;
+  out_ += '}';
+}
+
+void JsonWriter::BeginArray() {
+  BeginValue();
+  assert(depth_ < kMaxDepth);
+  out_ += '[';
+  is_first_[depth_++] = true;
+}
+
+void JsonWriter::EndArray() {
+  assert(depth_ > 0);
+  --depth_;
+  out_ += ']';
+}
+
+void JsonWriter::Key(std::string_view key) {
+  BeginValue();
+  WriteEscaped(key);
+  out_ += ':';
+  is_after_key_ = true;
+}
+
+void JsonWriter::Key(std::uint64_t key) {
+  BeginValue();
+  out_ += '"';
+  AppendInteger(out_, key);
+  out_ += "\":"sv;
+  is_after_key_ = true;
+}
+
+void JsonWriter::String(std::string_view value) {
+  BeginValue();
+  WriteEscaped(value);
+}
+
+void JsonWriter::Int(std::int64_t value) {
+  BeginValue();
+  AppendInteger(out_, value);
+}
+
+void JsonWriter::Uint(std::uint64_t value) {
+  BeginValue();
+  AppendInteger(out_, value);
+}
+
+void JsonWriter::Double(double value) {
+  BeginValue();
+  // Форматирование чисел с плавающей точкой берем у Boost.JSON (Ryu), чтобы
+  // вывод совпадал с json::serialize (например, 1.5E0). Для скалярного
+  // значения сериализатор не выделяет память.
+  thread_local json::serializer serializer;
+  json::value number(value);
+  serializer.reset(&number);
+  std::array<char, 32> buffer;
+  out_ += serializer.read(buffer.data(), buffer.size());
+}
+
+void JsonWriter::Bool(bool value) {
+  BeginValue();
+  out_ += value ? "true"sv : "false"sv;
+}
+
+void JsonWriter::BeginValue() {
+  if (is_after_key_) {
+    is_after_key_ = false;
+    return;
+  }
+  if (depth_ == 0) {
+    return;
+  }
+  if (!is_first_[depth_ - 1]) {
+    out_ += ',';
+  }
+  is_first_[depth_ - 1] = false;
+}
+
+// Экранирует символы так же, как json::serialize: кавычку, обратную косую
+// черту и управляющие символы. Остальные байты копируются кусками.
+void JsonWriter::WriteEscaped(std::string_view value) {
+  out_ += '"';
+  std::size_t begin = 0;
+  for (std::size_t i = 0; i < value.size(); ++i) {
+    char c = value[i];
+    if (!NeedsEscape(c)) {
+      continue;
+    }
+    out_.append(value.data() + begin, i - begin);
+    begin = i + 1;
+    out_ += '\\';
+    switch (c) {
+      case '"':
+        out_ += '"';
+        break;
+      case '\\':
+        out_ += '\\';
+        break;
+      case '\b':
+        out_ += 'b';
+        break;
+      case '\f':
+        out_ += 'f';
+        break;
+      case '\n':
+        out_ += 'n';
+        break;
+      case '\r':
+        out_ += 'r';
+        break;
+      case '\t':
+        out_ += 't';
+        break;
+      default:
+        out_ += "u00"sv;
+        out_ += kHexDigits[static_cast<unsigned char>(c) >> 4];
+        out_ += kHexDigits[static_cast<unsigned char>(c) & 0xf];
+    }
+  }
+  out_.append(value.data() + begin, value.size() - begin);
+  out_ += '"';
+}
+
+}  // namespace http_handler
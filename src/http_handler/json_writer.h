@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <boost/json.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace http_handler {
+
+namespace json = boost::json;
+
+// Потоково пишет JSON в переданную строку, не строя промежуточное дерево
+// json::value. Вывод побайтно совпадает с json::serialize для тех же данных:
+// ключи и значения выводятся в порядке вызовов, без пробелов.
+//
+// Значение внутри объекта записывается вызовом Key, за которым следует
+// значение. Правильность вложенности проверяет вызывающий код.
+class JsonWriter {
+ public:
+  // Максимальная глубина вложенности объектов и массивов.
+  static constexpr std::size_t kMaxDepth = 32;
+
+  explicit JsonWriter(std::string& out) noexcept;
+
+  void BeginObject();
+  void EndObject();
+  void BeginArray();
+  void EndArray();
+
+  void Key(std::string_view key);
+  // Записывает целочисленный ключ без создания временной строки.
+  void Key(std::uint64_t key);
+
+  void String(std::string_view value);
+  void Int(std::int64_t value);
+  void Uint(std::uint64_t value);
+  void Double(double value);
+  void Bool(bool value);
+
+ private:
+  // Дописывает запятую перед очередным элементом, если она нужна.
+  void BeginValue();
+  void WriteEscaped(std::string_view value);
+
+  std::string& out_;
+  std::array<bool, kMaxDepth> is_first_{};
+  std::size_t depth_ = 0;
+  bool is_after_key_ = false;
+};
+
+}  // namespace http_handler
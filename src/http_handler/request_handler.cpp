@@ -2,11 +2,19 @@
 
 namespace http_handler {
 
-RequestHandler::RequestHandler(std::shared_ptr<app::Application> application,
+RequestHandler::RequestHandler(net::any_io_executor executor,
+                               std::shared_ptr<app::Application> application,
                                std::string www_root_path,
-                               bool randomize_spawn_points, bool ticker_is_set)
-    : api_handler_(std::move(application), randomize_spawn_points,
-                   ticker_is_set),
-      www_root_path_(std::move(www_root_path)) {}
+                               bool randomize_spawn_points, bool ticker_is_set,
+                               std::size_t static_cache_size,
+                               std::string admin_token,
+                               model::Dimension view_radius,
+                               std::size_t compression_threshold)
+    : api_handler_(std::move(executor), std::move(application),
+                   randomize_spawn_points, ticker_is_set,
+                   std::move(admin_token), view_radius,
+                   compression_threshold),
+      www_root_path_(std::move(www_root_path)),
+      static_file_cache_(static_cache_size) {}
 
 }  // namespace http_handler
\ No newline at end of file
@@ -2,14 +2,19 @@
 
 #include <boost/date_time.hpp>
 #include <boost/filesystem.hpp>
+#include <charconv>
+#include <chrono>
 #include <string>
 #include <utility>
 
 #include "../../lib/model/model.h"
 #include "../../lib/util/file_handler.h"
 #include "../http_server/http_server.h"
+#include "../metrics/server_metrics.h"
 #include "api_handler.h"
+#include "cached_response.h"
 #include "response_generators.h"
+#include "static_file_cache.h"
 
 // Содержит код, отвечающий за обработку HTTP-запросов клиентов
 namespace http_handler {
@@ -21,28 +26,78 @@ namespace fs = std::filesystem;
 
 // Отвечает за обработку запросов.
 // При обращении к API делегирует обработку запросов ApiHandler.
+// На kMetrics отдает метрики сервера в текстовом формате Prometheus. Время
+// обработки каждого запроса записывается в метрику
+// game_server_http_request_duration_seconds.
 class RequestHandler {
  public:
-  explicit RequestHandler(std::shared_ptr<app::Application> application,
+  explicit RequestHandler(net::any_io_executor executor,
+                          std::shared_ptr<app::Application> application,
                           std::string www_root_path,
-                          bool randomize_spawn_points, bool ticker_is_set);
+                          bool randomize_spawn_points, bool ticker_is_set,
+                          std::size_t static_cache_size,
+                          std::string admin_token,
+                          model::Dimension view_radius,
+                          std::size_t compression_threshold);
 
   RequestHandler(const RequestHandler&) = delete;
   RequestHandler& operator=(const RequestHandler&) = delete;
 
+  // Возвращает допустимый размер тела запроса: для API его задает
+  // ApiHandler, а статические файлы и метрики запрашиваются без тела.
+  std::uint64_t GetBodyLimit(std::string_view target) const noexcept {
+    if (target.starts_with(endpoint_storage::kApi)) {
+      return api_handler_.GetBodyLimit(target);
+    }
+    return 0;
+  }
+
   template <typename Body, typename Allocator, typename Send>
   void operator()(http::request<Body, http::basic_fields<Allocator>>&& req,
                   Send&& send) {
     if (req.target().starts_with(endpoint_storage::kApi)) {
-      return api_handler_(std::forward<decltype(req)>(req),
-                          std::forward<Send>(send));
+      auto endpoint = api_handler_.GetEndpointName(req.target());
+      return api_handler_(
+          std::forward<decltype(req)>(req),
+          MakeMeteredSend(endpoint, std::forward<Send>(send)));
     }
-    return SendStaticData(std::forward<decltype(req)>(req),
-                          std::forward<Send>(send));
+    if (req.target() == kMetrics) {
+      auto metered_send = MakeMeteredSend(kMetrics, std::forward<Send>(send));
+      return metered_send(OkRequest<http::string_body>(
+          metrics::GetServerMetrics().registry.Serialize(), req.version(),
+          req.keep_alive(), ContentType::kTextPrometheus));
+    }
+    return SendStaticData(
+        std::forward<decltype(req)>(req),
+        MakeMeteredSend("static"sv, std::forward<Send>(send)));
   }
 
  private:
+  static constexpr std::string_view kMetrics = "/metrics"sv;
+
+  // Оборачивает send: перед отправкой ответа записывает время обработки
+  // запроса с метками endpoint и кодом ответа.
+  template <typename Send>
+  static auto MakeMeteredSend(std::string_view endpoint, Send&& send) {
+    return [endpoint, start = std::chrono::steady_clock::now(),
+            send = std::forward<Send>(send)](auto&& response) mutable {
+      std::array<char, 8> code;
+      auto [code_end, ec] = std::to_chars(
+          code.data(), code.data() + code.size(), response.result_int());
+      metrics::GetServerMetrics()
+          .http_request_duration
+          .WithLabels({endpoint, std::string_view(code.data(), code_end)})
+          .ObserveDuration(std::chrono::steady_clock::now() - start);
+      send(std::forward<decltype(response)>(response));
+    };
+  }
+
   // SendStaticData отправляет статические файлы: .html, .js, .css, ...
+  // Файлы, уже загруженные в static_file_cache_, отдаются без чтения с
+  // диска. Остальные после всех проверок загружаются в кеш, а если не
+  // помещаются в него, отдаются с диска через sendfile (см.
+  // SendFileFromDisk). Кеш ищется по пути файла, а не по target запроса,
+  // и только после проверки, что путь не выходит за www_root_path_.
   template <typename Body, typename Allocator, typename Send>
   void SendStaticData(http::request<Body, http::basic_fields<Allocator>>&& req,
                       Send&& send) {
@@ -51,31 +106,72 @@ class RequestHandler {
                                   : "/index.html"s;
     fs::path path_to_file(www_root_path_ + decoded_uri);
     if (!util::IsSubPath(www_root_path_, path_to_file)) {
-      send(std::move(BadRequest<http::string_body>(
+      return send(std::move(BadRequest<http::string_body>(
           "Bad request: Incorrect path"s, req.version(), req.keep_alive(),
           ContentType::KTextPlain)));
-    } else if (!fs::exists(path_to_file) || fs::is_directory(path_to_file)) {
+    }
+    auto cache_key = MakeStaticFileKey(www_root_path_, path_to_file);
+    if (auto file = static_file_cache_.Find(cache_key)) {
+      return SendCachedFile(std::move(file), req, std::forward<Send>(send));
+    }
+    if (!fs::exists(path_to_file) || fs::is_directory(path_to_file)) {
       send(std::move(NotFound<http::string_body>(
           "Not found: File "s.append(path_to_file.filename()) + " not found"s,
           req.version(), req.keep_alive(), ContentType::KTextPlain)));
+    } else if (auto cached_file =
+                   static_file_cache_.Load(cache_key, path_to_file)) {
+      SendCachedFile(std::move(cached_file), req, std::forward<Send>(send));
     } else {
-      http::file_body::value_type file;
-      if (sys::error_code ec;
-          file.open(path_to_file.c_str(), beast::file_mode::read, ec), ec) {
-        send(std::move(BadRequest<http::string_body>(
-            "Bad request: Could not open "s.append(path_to_file.filename()),
-            req.version(), req.keep_alive(), ContentType::KTextPlain)));
-      } else {
-        send(std::move(OkRequest<http::file_body>(
-            std::move(file), req.version(), req.keep_alive(),
-            ContentType::ConvertExtensionToMimeType(
-                path_to_file.extension().string()))));
-      }
+      SendFileFromDisk(path_to_file, req, std::forward<Send>(send));
+    }
+  }
+
+  // Отправляет файл, который не помещается в кеш, через sendfile. ETag и
+  // Last-Modified строятся из размера и времени изменения файла, поэтому
+  // условные и частичные запросы обслуживаются без чтения содержимого.
+  template <typename Body, typename Allocator, typename Send>
+  void SendFileFromDisk(
+      const fs::path& path_to_file,
+      const http::request<Body, http::basic_fields<Allocator>>& req,
+      Send&& send) {
+    http_server::SendfileBody::value_type body;
+    sys::error_code ec;
+    body.open(path_to_file.c_str(), ec);
+    std::error_code fs_ec;
+    auto last_write_time = fs::last_write_time(path_to_file, fs_ec);
+    if (ec || fs_ec) {
+      return send(std::move(BadRequest<http::string_body>(
+          "Bad request: Could not open "s.append(path_to_file.filename()),
+          req.version(), req.keep_alive(), ContentType::KTextPlain)));
+    }
+    auto content_type = ContentType::ConvertExtensionToMimeType(
+        path_to_file.extension().string());
+    auto file_size = body.size;
+    auto etag = MakeFileEtag(file_size, last_write_time);
+    auto last_modified = FormatHttpDate(last_write_time);
+
+    auto [status, range] =
+        EvaluatePreconditions(req, etag, last_modified, file_size);
+    if (status == http::status::not_modified) {
+      return send(
+          NotModified<http::empty_body>(etag, req.version(), req.keep_alive()));
+    }
+    if (status == http::status::range_not_satisfiable) {
+      return send(RangeNotSatisfiable<http::string_body>(
+          file_size, req.version(), req.keep_alive(), content_type));
     }
+    body.offset = range.offset;
+    body.size = range.length;
+    auto response = MakeResponse<http_server::SendfileBody>(
+        status, std::move(body), req.version(), req.keep_alive(),
+        content_type);
+    SetFileHeaders(response, etag, last_modified, range, file_size);
+    send(std::move(response));
   }
 
   ApiHandler api_handler_;
   std::string www_root_path_;
+  StaticFileCache static_file_cache_;
 };
 
 }  // namespace http_handler
@@ -1,10 +1,66 @@
 #include "response_generators.h"
 
+#include <charconv>
+
 namespace http_handler {
 
+namespace {
+
+std::string_view Trim(std::string_view str) noexcept {
+  while (!str.empty() && (str.front() == ' ' || str.front() == '\t')) {
+    str.remove_prefix(1);
+  }
+  while (!str.empty() && (str.back() == ' ' || str.back() == '\t')) {
+    str.remove_suffix(1);
+  }
+  return str;
+}
+
+// Возвращает вес q из параметров элемента заголовка Accept.
+double GetQuality(std::string_view params) noexcept {
+  auto q_pos = params.find("q="sv);
+  if (q_pos == std::string_view::npos) {
+    return 1.0;
+  }
+  auto value = Trim(params.substr(q_pos + 2));
+  double quality = 0.0;
+  std::from_chars(value.data(), value.data() + value.size(), quality);
+  return quality;
+}
+
+}  // namespace
+
 std::string_view ContentType::ConvertExtensionToMimeType(
     std::string_view extension) noexcept {
-  return mime_types_[extension];
+  // operator[] здесь не подходит: он вставляет элементы и не потокобезопасен.
+  if (auto it = mime_types_.find(extension); it != mime_types_.end()) {
+    return it->second;
+  }
+  return kApplicationOctetStream;
+}
+
+bool ContentType::IsPreferredOverJson(std::string_view accept,
+                                      std::string_view media_type) noexcept {
+  double media_type_quality = 0.0;
+  double json_quality = 0.0;
+  while (!accept.empty()) {
+    auto comma_pos = accept.find(',');
+    auto item = accept.substr(0, comma_pos);
+    accept.remove_prefix(comma_pos == std::string_view::npos ? accept.size()
+                                                             : comma_pos + 1);
+
+    auto params_pos = item.find(';');
+    auto type = Trim(item.substr(0, params_pos));
+    double quality = params_pos == std::string_view::npos
+                         ? 1.0
+                         : GetQuality(item.substr(params_pos + 1));
+    if (type == media_type) {
+      media_type_quality = quality;
+    } else if (type == kApplicationJson) {
+      json_quality = quality;
+    }
+  }
+  return media_type_quality > 0.0 && media_type_quality >= json_quality;
 }
 
 }  // namespace http_handler
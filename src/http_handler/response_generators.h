@@ -12,7 +12,7 @@ using namespace std::literals;
 
 // Содержит в себе константы для заголовка Content-Type запроса.
 // ConvertExtensionToMimeType выбирает нужный Content-Type исходя из расширения
-// файла.
+// файла. Для неизвестных расширений возвращает kApplicationOctetStream.
 class ContentType {
  public:
   ContentType() = delete;
@@ -24,14 +24,25 @@ class ContentType {
   static std::string_view ConvertExtensionToMimeType(
       std::string_view extension) noexcept;
 
+  // Возвращает true, если заголовок Accept явно перечисляет media_type с
+  // ненулевым весом и не ставит application/json выше него. Шаблоны вида
+  // */* не учитываются, поэтому по умолчанию клиент получает JSON.
+  static bool IsPreferredOverJson(std::string_view accept,
+                                  std::string_view media_type) noexcept;
+
   static constexpr std::string_view kTextHtml = "text/html"sv;
   static constexpr std::string_view kTextCss = "text/css"sv;
   static constexpr std::string_view KTextPlain = "text/plain"sv;
+  static constexpr std::string_view kTextPrometheus =
+      "text/plain; version=0.0.4"sv;
   static constexpr std::string_view kTextJavascript = "text/js"sv;
   static constexpr std::string_view kApplicationJson = "application/json"sv;
   static constexpr std::string_view kApplicationXml = "application/xml"sv;
   static constexpr std::string_view kApplicationOctetStream =
       "application/octet-stream"sv;
+  // Двоичный формат состояния игры (см. ApiSerializer).
+  static constexpr std::string_view kApplicationDogStoryBinary =
+      "application/vnd.dog-story.binary"sv;
   static constexpr std::string_view kImagePng = "image/png"sv;
   static constexpr std::string_view kImageJpeg = "image/jpeg"sv;
   static constexpr std::string_view kImageGif = "image/gif"sv;
@@ -142,4 +153,32 @@ http::response<Body> InternalServerError(ValueType&& message,
                             keep_alive, content_type);
 }
 
+// Формирует ответ 304 Not Modified без тела для ресурса с указанным ETag.
+// Ответы с ETag выбирают представление по Accept-Encoding, а 304 должен
+// содержать тот же Vary, что и ответ 200.
+template <typename Body>
+http::response<Body> NotModified(std::string_view etag,
+                                 std::uint32_t http_version, bool keep_alive) {
+  http::response<Body> response(http::status::not_modified, http_version);
+  response.set(http::field::etag, etag);
+  response.set(http::field::vary, "Accept-Encoding"sv);
+  response.keep_alive(keep_alive);
+  response.set(http::field::cache_control, "no-cache"sv);
+  return response;
+}
+
+// Формирует ответ 416 Range Not Satisfiable для представления размером size.
+template <typename Body>
+http::response<Body> RangeNotSatisfiable(std::size_t size,
+                                         std::uint32_t http_version,
+                                         bool keep_alive,
+                                         std::string_view content_type) {
+  auto response = MakeResponse<Body>(http::status::range_not_satisfiable,
+                                     typename Body::value_type{}, http_version,
+                                     keep_alive, content_type);
+  response.set(http::field::content_range,
+               "bytes */"s + std::to_string(size));
+  return response;
+}
+
 }  // namespace http_handler
@@ -0,0 +1,19 @@
+#include "route_table.h"
+
+namespace http_handler {
+
+std::string MethodSet::ToString() const {
+  std::string result;
+  for (unsigned i = 0; i < 64; ++i) {
+    if ((mask_ & (std::uint64_t{1} << i)) == 0) {
+      continue;
+    }
+    if (!result.empty()) {
+      result += ", ";
+    }
+    result += http::to_string(static_cast<http::verb>(i));
+  }
+  return result;
+}
+
+}  // namespace http_handler
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <boost/beast/http.hpp>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace http_handler {
+
+namespace http = boost::beast::http;
+
+// Набор HTTP-методов в виде битовой маски.
+class MethodSet {
+ public:
+  constexpr MethodSet() = default;
+  constexpr MethodSet(std::initializer_list<http::verb> methods) {
+    for (auto method : methods) {
+      mask_ |= GetBit(method);
+    }
+  }
+
+  constexpr bool Contains(http::verb method) const noexcept {
+    return (mask_ & GetBit(method)) != 0;
+  }
+
+  // Возвращает методы через запятую ("GET, HEAD") для заголовка Allow.
+  std::string ToString() const;
+
+ private:
+  static constexpr std::uint64_t GetBit(http::verb method) noexcept {
+    return std::uint64_t{1} << static_cast<unsigned>(method);
+  }
+
+  std::uint64_t mask_ = 0;
+};
+
+namespace detail {
+
+// FNV-1a с примешанным seed.
+constexpr std::uint32_t HashKey(std::string_view key,
+                                std::uint32_t seed) noexcept {
+  std::uint32_t hash = 2166136261u ^ seed;
+  for (char c : key) {
+    hash ^= static_cast<std::uint8_t>(c);
+    hash *= 16777619u;
+  }
+  // Младшие биты FNV-1a зависят только от младших битов символов и seed,
+  // поэтому старшие биты примешиваются к младшим, по которым выбирается
+  // ячейка.
+  return hash ^ (hash >> 16);
+}
+
+}  // namespace detail
+
+// Сопоставляет N строковым ключам их индексы в массиве keys.
+// Таблица строится на этапе компиляции: seed хеш-функции подбирается так,
+// чтобы все ключи попали в разные ячейки. Поэтому поиск - это одно
+// вычисление хеша и одно сравнение строк, без выделения памяти.
+template <std::size_t N>
+class PerfectHashTable {
+ public:
+  static constexpr std::size_t kNumOfSlots = std::bit_ceil(N * 2);
+
+  constexpr explicit PerfectHashTable(
+      const std::array<std::string_view, N>& keys)
+      : keys_(keys) {
+    for (std::uint32_t seed = 0; seed < kMaxSeed; ++seed) {
+      if (TryBuild(seed)) {
+        seed_ = seed;
+        return;
+      }
+    }
+    throw std::logic_error("Failed to build a perfect hash table");
+  }
+
+  // Возвращает индекс ключа key или std::nullopt, если такого ключа нет.
+  constexpr std::optional<std::size_t> Find(
+      std::string_view key) const noexcept {
+    auto index = slots_[GetSlot(key, seed_)];
+    if (index == kEmptySlot || keys_[index] != key) {
+      return std::nullopt;
+    }
+    return index;
+  }
+
+ private:
+  static constexpr std::uint32_t kMaxSeed = 1 << 16;
+  static constexpr std::size_t kEmptySlot = N;
+
+  static constexpr std::size_t GetSlot(std::string_view key,
+                                       std::uint32_t seed) noexcept {
+    return detail::HashKey(key, seed) & (kNumOfSlots - 1);
+  }
+
+  constexpr bool TryBuild(std::uint32_t seed) {
+    slots_.fill(kEmptySlot);
+    for (std::size_t i = 0; i < N; ++i) {
+      auto& slot = slots_[GetSlot(keys_[i], seed)];
+      if (slot != kEmptySlot) {
+        return false;
+      }
+      slot = i;
+    }
+    return true;
+  }
+
+  std::array<std::string_view, N> keys_;
+  std::array<std::size_t, kNumOfSlots> slots_{};
+  std::uint32_t seed_ = 0;
+};
+
+}  // namespace http_handler
@@ -0,0 +1,176 @@
+#include "static_file_cache.h"
+
+#include <charconv>
+#include <chrono>
+#include <ctime>
+#include <sstream>
+
+#include "../../lib/util/file_handler.h"
+
+namespace http_handler {
+
+namespace {
+
+// Сжатый вариант хранится, только если он меньше оригинала хотя бы на 10%.
+constexpr std::size_t kMinCompressionRatioPercent = 90;
+
+bool ParseNumber(std::string_view str, std::size_t& number) noexcept {
+  if (str.empty()) {
+    return false;
+  }
+  auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), number);
+  return ec == std::errc() && ptr == str.data() + str.size();
+}
+
+}  // namespace
+
+// Форматирует время в виде HTTP-date (RFC 9110), например
+// "Sun, 06 Nov 1994 08:49:37 GMT".
+std::string FormatHttpDate(fs::file_time_type file_time) {
+  auto sys_time = std::chrono::file_clock::to_sys(file_time);
+  std::time_t time = std::chrono::system_clock::to_time_t(
+      std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+          sys_time));
+  std::tm tm{};
+  gmtime_r(&time, &tm);
+  char buffer[32];
+  auto size = std::strftime(buffer, sizeof(buffer),
+                            "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  return std::string(buffer, size);
+}
+
+// ETag строится как у nginx: из времени изменения и размера файла в
+// шестнадцатеричном виде.
+std::string MakeFileEtag(std::uint64_t size, fs::file_time_type file_time) {
+  std::ostringstream etag;
+  etag << '"' << std::hex << file_time.time_since_epoch().count() << '-'
+       << size << '"';
+  return etag.str();
+}
+
+StaticFileCache::StaticFileCache(std::size_t max_size) noexcept
+    : max_size_(max_size) {}
+
+std::string MakeStaticFileKey(const fs::path& root, const fs::path& path) {
+  return path.lexically_normal()
+      .lexically_relative(root.lexically_normal())
+      .generic_string();
+}
+
+StaticFileCache::FilePtr StaticFileCache::Find(std::string_view key) const {
+  std::shared_lock lock(mutex_);
+  if (auto it = files_.find(std::string(key)); it != files_.end()) {
+    return it->second;
+  }
+  return nullptr;
+}
+
+// Файл читается и сжимается без блокировки, поэтому несколько потоков могут
+// одновременно загрузить один и тот же файл. В кеш попадает первый из них.
+StaticFileCache::FilePtr StaticFileCache::Load(std::string_view key,
+                                               const fs::path& path) {
+  std::error_code ec;
+  auto file_size = fs::file_size(path, ec);
+  if (ec) {
+    return nullptr;
+  }
+  auto last_write_time = fs::last_write_time(path, ec);
+  if (ec) {
+    return nullptr;
+  }
+  {
+    // Файл, который не поместится в оставшийся бюджет, не читается и не
+    // сжимается: иначе при заполненном кеше каждый запрос к нему тратил бы
+    // время на чтение и сжатие впустую.
+    std::unique_lock lock(mutex_);
+    if (auto it = files_.find(std::string(key)); it != files_.end()) {
+      return it->second;
+    }
+    if (rejected_.contains(std::string(key))) {
+      return nullptr;
+    }
+    if (file_size > kMaxFileSize || file_size > max_size_ - size_) {
+      rejected_.emplace(key);
+      return nullptr;
+    }
+  }
+
+  auto file = std::make_shared<StaticFile>();
+  try {
+    file->content = util::LoadContentFromFile(path);
+  } catch (const std::exception&) {
+    return nullptr;
+  }
+  if (auto gzip_content =
+          CompressBody(file->content, util::ContentEncoding::kGzip);
+      gzip_content.size() * 100 <
+      file->content.size() * kMinCompressionRatioPercent) {
+    file->gzip_content = std::move(gzip_content);
+  }
+  file->etag = MakeEtag(file->content);
+  if (!file->gzip_content.empty()) {
+    file->gzip_etag =
+        MakeEncodedEtag(file->etag, util::ContentEncoding::kGzip);
+  }
+  file->last_modified = FormatHttpDate(last_write_time);
+  file->content_type =
+      ContentType::ConvertExtensionToMimeType(path.extension().string());
+
+  std::unique_lock lock(mutex_);
+  if (auto it = files_.find(std::string(key)); it != files_.end()) {
+    return it->second;
+  }
+  std::size_t entry_size = file->content.size() + file->gzip_content.size();
+  if (entry_size > max_size_ - size_) {
+    rejected_.emplace(key);
+    return nullptr;
+  }
+  size_ += entry_size;
+  files_.emplace(std::string(key), file);
+  return file;
+}
+
+std::pair<RangeStatus, ByteRange> ParseRange(std::string_view range,
+                                             std::size_t size) noexcept {
+  constexpr std::string_view kBytesUnit = "bytes="sv;
+  if (!range.starts_with(kBytesUnit) ||
+      range.find(',') != std::string_view::npos) {
+    return {RangeStatus::kNone, {}};
+  }
+  range.remove_prefix(kBytesUnit.size());
+  auto dash_pos = range.find('-');
+  if (dash_pos == std::string_view::npos) {
+    return {RangeStatus::kNone, {}};
+  }
+  auto first_str = range.substr(0, dash_pos);
+  auto last_str = range.substr(dash_pos + 1);
+
+  std::size_t first = 0;
+  std::size_t last = 0;
+  if (first_str.empty()) {
+    // Суффиксный диапазон: последние last байт файла.
+    if (!ParseNumber(last_str, last)) {
+      return {RangeStatus::kNone, {}};
+    }
+    if (last == 0 || size == 0) {
+      return {RangeStatus::kUnsatisfiable, {}};
+    }
+    last = std::min(last, size);
+    return {RangeStatus::kSatisfiable, {size - last, last}};
+  }
+  if (!ParseNumber(first_str, first)) {
+    return {RangeStatus::kNone, {}};
+  }
+  if (last_str.empty()) {
+    last = size == 0 ? 0 : size - 1;
+  } else if (!ParseNumber(last_str, last) || last < first) {
+    return {RangeStatus::kNone, {}};
+  }
+  if (first >= size) {
+    return {RangeStatus::kUnsatisfiable, {}};
+  }
+  last = std::min(last, size - 1);
+  return {RangeStatus::kSatisfiable, {first, last - first + 1}};
+}
+
+}  // namespace http_handler
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/optional.hpp>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "../../lib/util/compression.h"
+#include "cached_response.h"
+#include "response_generators.h"
+
+namespace http_handler {
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace fs = std::filesystem;
+
+using namespace std::literals;
+
+// Содержимое статического файла, загруженное в память, и его метаданные.
+struct StaticFile {
+  std::string content;
+  // Сжатое в gzip содержимое. Пустое, если сжатие не дает выигрыша.
+  std::string gzip_content;
+  // Строгие ETag несжатого и gzip-представлений (см. MakeEncodedEtag).
+  std::string etag;
+  std::string gzip_etag;
+  std::string last_modified;
+  std::string_view content_type;
+};
+
+// Кеш статических файлов из --www-root. Файл загружается в память при первом
+// обращении и после этого отдается без обращений к файловой системе. Записи
+// не удаляются: если файл не помещается в оставшийся бюджет или больше
+// kMaxFileSize, он не кешируется и отдается с диска. Такой файл запоминается
+// и больше не читается при следующих обращениях.
+//
+// Ключ записи - путь файла относительно --www-root (см. MakeStaticFileKey),
+// поэтому разные target одного файла ("/a.js", "//a.js", "/%61.js") делят
+// одну запись.
+//
+// Потокобезопасен: поиск выполняется под разделяемой блокировкой, вставка -
+// под эксклюзивной.
+class StaticFileCache {
+ public:
+  using FilePtr = std::shared_ptr<const StaticFile>;
+
+  // Файлы больше этого размера дешевле отдавать через sendfile из кеша
+  // страниц ядра, чем держать их копию в памяти процесса.
+  static constexpr std::size_t kMaxFileSize = 16 * 1024 * 1024;
+
+  explicit StaticFileCache(std::size_t max_size) noexcept;
+
+  StaticFileCache(const StaticFileCache&) = delete;
+  StaticFileCache& operator=(const StaticFileCache&) = delete;
+
+  // Ищет файл по ключу key. Если файла нет в кеше, возвращает nullptr.
+  FilePtr Find(std::string_view key) const;
+
+  // Загружает файл path и кладет его в кеш под ключом key. Возвращает
+  // nullptr, если файл не удалось прочитать или он не помещается в кеш.
+  // Размер файла сверяется с оставшимся бюджетом до чтения.
+  FilePtr Load(std::string_view key, const fs::path& path);
+
+ private:
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, FilePtr> files_;
+  // Ключи файлов, которые не поместились в кеш.
+  std::unordered_set<std::string> rejected_;
+  std::size_t max_size_;
+  std::size_t size_ = 0;
+};
+
+// Строит ключ кеша для файла path из каталога root: путь относительно root
+// после нормализации ("//", "." и ".." схлопываются). path должен быть уже
+// декодирован и проверен IsSubPath.
+std::string MakeStaticFileKey(const fs::path& root, const fs::path& path);
+
+// Форматирует время изменения файла в виде HTTP-date (RFC 9110).
+std::string FormatHttpDate(fs::file_time_type file_time);
+
+// Строит строгий ETag файла на диске из его размера и времени изменения, не
+// читая содержимое.
+std::string MakeFileEtag(std::uint64_t size, fs::file_time_type file_time);
+
+// Диапазон байт из заголовка Range.
+struct ByteRange {
+  std::size_t offset = 0;
+  std::size_t length = 0;
+};
+
+enum class RangeStatus { kNone, kSatisfiable, kUnsatisfiable };
+
+// Разбирает заголовок Range вида "bytes=<first>-<last>", "bytes=<first>-" или
+// "bytes=-<suffix>" для файла размером size. Несколько диапазонов и другие
+// единицы измерения не поддерживаются: в этом случае возвращается kNone и
+// файл отдается целиком, как разрешает RFC 9110.
+std::pair<RangeStatus, ByteRange> ParseRange(std::string_view range,
+                                             std::size_t size) noexcept;
+
+// Проверяет условные (If-None-Match, If-Modified-Since) и частичные (Range,
+// If-Range) заголовки запроса req к представлению файла с ETag etag и
+// размером size. Возвращает статус ответа: 304, 416, 206 с диапазоном байт
+// или 200 с диапазоном, покрывающим все представление.
+template <typename Request>
+std::pair<http::status, ByteRange> EvaluatePreconditions(
+    const Request& req, std::string_view etag, std::string_view last_modified,
+    std::size_t size) {
+  auto if_none_match = req[http::field::if_none_match];
+  if ((!if_none_match.empty() && IsEtagMatched(if_none_match, etag)) ||
+      (if_none_match.empty() && !last_modified.empty() &&
+       req[http::field::if_modified_since] == last_modified)) {
+    return {http::status::not_modified, {}};
+  }
+  auto range = req[http::field::range];
+  auto if_range = req[http::field::if_range];
+  if (!range.empty() && (if_range.empty() || if_range == etag ||
+                         if_range == last_modified)) {
+    auto [range_status, byte_range] = ParseRange(range, size);
+    if (range_status == RangeStatus::kUnsatisfiable) {
+      return {http::status::range_not_satisfiable, {}};
+    }
+    if (range_status == RangeStatus::kSatisfiable) {
+      return {http::status::partial_content, byte_range};
+    }
+  }
+  return {http::status::ok, {0, size}};
+}
+
+// Устанавливает заголовки ответа 200 или 206 с частью range представления
+// файла размером size.
+template <typename Body, typename Fields>
+void SetFileHeaders(http::response<Body, Fields>& response,
+                    std::string_view etag, std::string_view last_modified,
+                    const ByteRange& range, std::size_t size) {
+  if (!etag.empty()) {
+    response.set(http::field::etag, etag);
+  }
+  if (!last_modified.empty()) {
+    response.set(http::field::last_modified, last_modified);
+  }
+  response.set(http::field::accept_ranges, "bytes"sv);
+  response.set(http::field::vary, "Accept-Encoding"sv);
+  if (response.result() == http::status::partial_content) {
+    response.set(http::field::content_range,
+                 "bytes "s + std::to_string(range.offset) + "-"s +
+                     std::to_string(range.offset + range.length - 1) + "/"s +
+                     std::to_string(size));
+  }
+}
+
+// Тело HTTP-ответа, ссылающееся на часть закешированного файла. Хранит
+// указатель на файл, поэтому данные живут, пока ответ не будет отправлен.
+struct StaticFileBody {
+  struct value_type {
+    StaticFileCache::FilePtr file;
+    std::string_view data;
+  };
+
+  static std::uint64_t size(const value_type& body) noexcept {
+    return body.data.size();
+  }
+
+  class writer {
+   public:
+    using const_buffers_type = net::const_buffer;
+
+    template <bool isRequest, class Fields>
+    writer(const http::header<isRequest, Fields>&, const value_type& body)
+        : body_(body) {}
+
+    void init(beast::error_code& ec) { ec = {}; }
+
+    boost::optional<std::pair<const_buffers_type, bool>> get(
+        beast::error_code& ec) {
+      ec = {};
+      if (is_sent_) {
+        return boost::none;
+      }
+      is_sent_ = true;
+      return std::make_pair(
+          net::const_buffer(body_.data.data(), body_.data.size()), false);
+    }
+
+   private:
+    const value_type& body_;
+    bool is_sent_ = false;
+  };
+};
+
+// Отправляет закешированный файл. Выбирает gzip-вариант файла, если клиент
+// его принимает, и проверяет условные и частичные заголовки по ETag
+// выбранного представления: диапазоны Range относятся к нему же.
+template <typename Request, typename Send>
+void SendCachedFile(StaticFileCache::FilePtr file, const Request& req,
+                    Send&& send) {
+  std::string_view content = file->content;
+  std::string_view etag = file->etag;
+  auto encoding = util::ContentEncoding::kIdentity;
+  if (!file->gzip_content.empty() &&
+      util::NegotiateContentEncoding(req[http::field::accept_encoding]) ==
+          util::ContentEncoding::kGzip) {
+    encoding = util::ContentEncoding::kGzip;
+    content = file->gzip_content;
+    etag = file->gzip_etag;
+  }
+
+  auto [status, range] =
+      EvaluatePreconditions(req, etag, file->last_modified, content.size());
+  if (status == http::status::not_modified) {
+    return send(
+        NotModified<http::empty_body>(etag, req.version(), req.keep_alive()));
+  }
+  if (status == http::status::range_not_satisfiable) {
+    return send(RangeNotSatisfiable<http::string_body>(
+        content.size(), req.version(), req.keep_alive(), file->content_type));
+  }
+
+  auto content_type = file->content_type;
+  auto size = content.size();
+  const auto& cached_file = *file;
+  auto response = MakeResponse<StaticFileBody>(
+      status,
+      StaticFileBody::value_type{std::move(file),
+                                 content.substr(range.offset, range.length)},
+      req.version(), req.keep_alive(), content_type);
+  SetFileHeaders(response, etag, cached_file.last_modified, range, size);
+  if (encoding != util::ContentEncoding::kIdentity) {
+    response.set(http::field::content_encoding, util::ToString(encoding));
+  }
+  send(std::move(response));
+}
+
+}  // namespace http_handler
@@ -0,0 +1,179 @@
+#include "admission_control.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "../metrics/server_metrics.h"
+
+namespace http_server {
+
+using namespace std::literals;
+
+AdmissionControl::AdmissionControl(AdmissionLimits limits) : limits_(limits) {
+  if (limits_.burst <= 0.0) {
+    limits_.burst = std::max(limits_.requests_per_second, 1.0);
+  }
+}
+
+Admission AdmissionControl::TryAcquireConnection(
+    const net::ip::address& address) {
+  auto& server_metrics = metrics::GetServerMetrics();
+  if (limits_.max_connections > 0 &&
+      connections_.fetch_add(1, std::memory_order_relaxed) >=
+          limits_.max_connections) {
+    connections_.fetch_sub(1, std::memory_order_relaxed);
+    server_metrics.admission_rejections.WithLabels({"max_connections"sv})
+        .Inc();
+    return Admission::kServerBusy;
+  }
+  if (!TracksClients()) {
+    server_metrics.http_connections.Add(1);
+    return Admission::kAccepted;
+  }
+
+  auto key = ToKey(address);
+  auto& shard = GetShard(key);
+  {
+    std::lock_guard lock(shard.mutex);
+    auto [it, inserted] = shard.clients.try_emplace(key);
+    auto& client = it->second;
+    if (inserted) {
+      client.tokens = limits_.burst;
+      client.updated = Clock::now();
+    }
+    if (limits_.max_connections_per_ip == 0 ||
+        client.connections < limits_.max_connections_per_ip) {
+      ++client.connections;
+      server_metrics.http_connections.Add(1);
+      return Admission::kAccepted;
+    }
+  }
+  if (limits_.max_connections > 0) {
+    connections_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  server_metrics.admission_rejections.WithLabels({"max_connections_per_ip"sv})
+      .Inc();
+  return Admission::kTooManyConnections;
+}
+
+void AdmissionControl::ReleaseConnection(const net::ip::address& address) {
+  if (limits_.max_connections > 0) {
+    connections_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  metrics::GetServerMetrics().http_connections.Add(-1);
+  if (!TracksClients()) {
+    return;
+  }
+
+  auto key = ToKey(address);
+  auto& shard = GetShard(key);
+  std::lock_guard lock(shard.mutex);
+  auto it = shard.clients.find(key);
+  if (it == shard.clients.end()) {
+    return;
+  }
+  --it->second.connections;
+  auto now = Clock::now();
+  if (IsIdle(it->second, now)) {
+    shard.clients.erase(it);
+  } else if (shard.clients.size() > kMaxIdleClientsPerShard) {
+    EraseIdleClients(shard, now);
+  }
+}
+
+bool AdmissionControl::TryAcquireRequest(const net::ip::address& address,
+                                         Clock::time_point now) {
+  if (!IsRateLimited()) {
+    return true;
+  }
+  auto key = ToKey(address);
+  auto& shard = GetShard(key);
+  std::lock_guard lock(shard.mutex);
+  auto [it, inserted] = shard.clients.try_emplace(key);
+  auto& client = it->second;
+  if (inserted) {
+    client.tokens = limits_.burst;
+    client.updated = now;
+  } else {
+    Refill(client, now);
+  }
+  if (client.tokens >= 1.0) {
+    client.tokens -= 1.0;
+    return true;
+  }
+  metrics::GetServerMetrics().admission_rejections.WithLabels({"rate_limit"sv})
+      .Inc();
+  return false;
+}
+
+AdmissionControl::Key AdmissionControl::ToKey(
+    const net::ip::address& address) {
+  if (address.is_v4()) {
+    return net::ip::make_address_v6(net::ip::v4_mapped, address.to_v4())
+        .to_bytes();
+  }
+  return address.to_v6().to_bytes();
+}
+
+AdmissionControl::Shard& AdmissionControl::GetShard(const Key& key) noexcept {
+  return shards_[KeyHash{}(key) % kNumOfShards];
+}
+
+void AdmissionControl::Refill(Client& client,
+                              Clock::time_point now) const noexcept {
+  if (now <= client.updated) {
+    return;
+  }
+  double elapsed = std::chrono::duration<double>(now - client.updated).count();
+  client.tokens = std::min(
+      limits_.burst, client.tokens + elapsed * limits_.requests_per_second);
+  client.updated = now;
+}
+
+bool AdmissionControl::IsIdle(Client& client,
+                              Clock::time_point now) const noexcept {
+  if (client.connections > 0) {
+    return false;
+  }
+  if (!IsRateLimited()) {
+    return true;
+  }
+  Refill(client, now);
+  return client.tokens >= limits_.burst;
+}
+
+void AdmissionControl::EraseIdleClients(Shard& shard, Clock::time_point now) {
+  for (auto it = shard.clients.begin(); it != shard.clients.end();) {
+    it = IsIdle(it->second, now) ? shard.clients.erase(it) : std::next(it);
+  }
+}
+
+ConnectionSlot::ConnectionSlot(
+    std::shared_ptr<AdmissionControl> admission_control,
+    net::ip::address address) noexcept
+    : admission_control_(std::move(admission_control)),
+      address_(std::move(address)) {}
+
+ConnectionSlot& ConnectionSlot::operator=(ConnectionSlot&& other) noexcept {
+  if (this != &other) {
+    if (admission_control_) {
+      admission_control_->ReleaseConnection(address_);
+    }
+    admission_control_ = std::move(other.admission_control_);
+    address_ = std::move(other.address_);
+  }
+  return *this;
+}
+
+ConnectionSlot::~ConnectionSlot() {
+  if (admission_control_) {
+    admission_control_->ReleaseConnection(address_);
+  }
+}
+
+bool ConnectionSlot::TryAcquireRequest() {
+  return !admission_control_ ||
+         admission_control_->TryAcquireRequest(address_);
+}
+
+}  // namespace http_server
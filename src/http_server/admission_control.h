@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <boost/asio/ip/address.hpp>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace http_server {
+
+namespace net = boost::asio;
+
+// Ограничения на соединения и запросы клиентов. Значение 0 снимает
+// соответствующее ограничение.
+struct AdmissionLimits {
+  // Число открытых соединений со всеми клиентами.
+  std::size_t max_connections = 0;
+  // Число открытых соединений с одного IP-адреса.
+  std::size_t max_connections_per_ip = 0;
+  // Средняя частота запросов с одного IP-адреса.
+  double requests_per_second = 0.0;
+  // Число запросов, которые клиент может отправить разом после простоя. Если
+  // 0, равно requests_per_second.
+  double burst = 0.0;
+};
+
+// Результат проверки нового соединения.
+enum class Admission {
+  kAccepted,
+  // Исчерпан общий лимит соединений: сервер отвечает 503.
+  kServerBusy,
+  // Исчерпан лимит соединений с IP-адреса клиента: сервер отвечает 429.
+  kTooManyConnections
+};
+
+// Следит за числом соединений и частотой запросов клиентов.
+// Частота запросов ограничивается алгоритмом token bucket: у каждого
+// IP-адреса есть корзина на burst жетонов, которая пополняется со скоростью
+// requests_per_second, а каждый запрос забирает один жетон.
+// Клиенты распределены по шардам по хешу адреса, поэтому потоки,
+// обслуживающие разных клиентов, редко ждут один мьютекс.
+class AdmissionControl {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit AdmissionControl(AdmissionLimits limits);
+  AdmissionControl(const AdmissionControl&) = delete;
+  AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+  // Занимает место для соединения с адреса address. Если соединение
+  // отклонено, место не занимается.
+  Admission TryAcquireConnection(const net::ip::address& address);
+  void ReleaseConnection(const net::ip::address& address);
+
+  // Забирает жетон из корзины клиента. Возвращает false, если корзина пуста.
+  bool TryAcquireRequest(const net::ip::address& address,
+                         Clock::time_point now = Clock::now());
+
+  bool IsRateLimited() const noexcept {
+    return limits_.requests_per_second > 0.0;
+  }
+
+ private:
+  // IP-адрес в формате IPv6 (IPv4-адреса отображаются в ::ffff:a.b.c.d).
+  using Key = std::array<unsigned char, 16>;
+
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const noexcept {
+      return std::hash<std::string_view>{}(std::string_view(
+          reinterpret_cast<const char*>(key.data()), key.size()));
+    }
+  };
+
+  struct Client {
+    std::size_t connections = 0;
+    double tokens = 0.0;
+    Clock::time_point updated;
+  };
+
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::unordered_map<Key, Client, KeyHash> clients;
+  };
+
+  static constexpr std::size_t kNumOfShards = 16;
+  // Число клиентов в шарде, после которого из него удаляются клиенты без
+  // соединений с полной корзиной.
+  static constexpr std::size_t kMaxIdleClientsPerShard = 4096;
+
+  // Проверяет, нужны ли записи о клиентах. Без ограничения соединений с
+  // IP-адреса и частоты запросов соединения учитываются только общим
+  // счетчиком, без мьютексов шардов.
+  bool TracksClients() const noexcept {
+    return limits_.max_connections_per_ip > 0 || IsRateLimited();
+  }
+
+  static Key ToKey(const net::ip::address& address);
+  Shard& GetShard(const Key& key) noexcept;
+
+  // Пополняет корзину клиента за время, прошедшее с прошлого обновления.
+  void Refill(Client& client, Clock::time_point now) const noexcept;
+  // Проверяет, можно ли забыть клиента, не меняя поведения ограничений.
+  bool IsIdle(Client& client, Clock::time_point now) const noexcept;
+  void EraseIdleClients(Shard& shard, Clock::time_point now);
+
+  AdmissionLimits limits_;
+  std::atomic<std::size_t> connections_{0};
+  std::array<Shard, kNumOfShards> shards_;
+};
+
+// Место соединения в AdmissionControl. Освобождается при разрушении.
+// Пустое место (без AdmissionControl) не ограничивает клиента.
+class ConnectionSlot {
+ public:
+  ConnectionSlot() = default;
+  ConnectionSlot(std::shared_ptr<AdmissionControl> admission_control,
+                 net::ip::address address) noexcept;
+  ConnectionSlot(ConnectionSlot&& other) noexcept = default;
+  ConnectionSlot& operator=(ConnectionSlot&& other) noexcept;
+  ~ConnectionSlot();
+
+  // Проверяет, не превысил ли клиент частоту запросов.
+  bool TryAcquireRequest();
+
+ private:
+  std::shared_ptr<AdmissionControl> admission_control_;
+  net::ip::address address_;
+};
+
+}  // namespace http_server
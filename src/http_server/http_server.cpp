@@ -1,49 +1,393 @@
 #include "http_server.h"
 
+#ifdef __linux__
+#include <sys/sendfile.h>
+
+#include <cerrno>
+#endif
+
 namespace http_server {
 
+namespace {
+
+// Сериализует ответ с ошибкой в формате API вместе с заголовками, чтобы
+// отклонять запросы без сериализации на каждый отказ.
+std::string SerializeRejection(http::status status, std::string_view code,
+                               std::string_view message, bool keep_alive) {
+  http::response<http::string_body> response(status, 11);
+  response.set(http::field::content_type, "application/json"sv);
+  response.set(http::field::cache_control, "no-cache"sv);
+  response.set(http::field::retry_after, "1"sv);
+  response.body() =
+      json::serialize(json::object{{"code"s, code}, {"message"s, message}});
+  response.keep_alive(keep_alive);
+  response.prepare_payload();
+
+  std::string result;
+  http::response_serializer<http::string_body> serializer(response);
+  beast::error_code ec;
+  while (!ec && !serializer.is_done()) {
+    serializer.next(ec, [&result, &serializer](beast::error_code& ec,
+                                               const auto& buffers) {
+      for (auto buffer : beast::buffers_range_ref(buffers)) {
+        result.append(static_cast<const char*>(buffer.data()), buffer.size());
+      }
+      serializer.consume(beast::buffer_bytes(buffers));
+    });
+  }
+  return result;
+}
+
+const std::string& GetTooManyRequestsResponse(bool keep_alive) {
+  static const std::string keep_alive_response =
+      SerializeRejection(http::status::too_many_requests, "tooManyRequests"sv,
+                         "Too many requests"sv, true);
+  static const std::string close_response =
+      SerializeRejection(http::status::too_many_requests, "tooManyRequests"sv,
+                         "Too many requests"sv, false);
+  return keep_alive ? keep_alive_response : close_response;
+}
+
+const std::string& GetPayloadTooLargeResponse() {
+  static const std::string response =
+      SerializeRejection(http::status::payload_too_large,
+                         "payloadTooLarge"sv, "Request body is too large"sv,
+                         false);
+  return response;
+}
+
+const std::string& GetHeaderFieldsTooLargeResponse() {
+  static const std::string response = SerializeRejection(
+      http::status::request_header_fields_too_large, "headerTooLarge"sv,
+      "Request header is too large"sv, false);
+  return response;
+}
+
+const std::string& GetServiceUnavailableResponse() {
+  static const std::string response =
+      SerializeRejection(http::status::service_unavailable,
+                         "serviceUnavailable"sv, "Server is busy"sv, false);
+  return response;
+}
+
+}  // namespace
+
 void LogError(beast::error_code ec, std::string_view where) {
+  metrics::GetServerMetrics().network_errors.WithLabels({where}).Inc();
+  if (!logger::ShouldLog(logger::LogEvent::kError)) {
+    return;
+  }
   logger::Log(
       json::value{
           {"code"s, ec.value()}, {"text"s, ec.message()}, {"where"s, where}},
       "error"sv);
 }
 
-SessionBase::SessionBase(tcp::socket&& socket) : stream_(std::move(socket)) {}
+bool IsReusePortSupported() noexcept {
+#ifdef SO_REUSEPORT
+  return true;
+#else
+  return false;
+#endif
+}
+
+void SetReusePort([[maybe_unused]] tcp::acceptor& acceptor) {
+#ifdef SO_REUSEPORT
+  using ReusePort =
+      net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+  acceptor.set_option(ReusePort(true));
+#endif
+}
+
+void RejectConnection(tcp::socket&& socket, Admission admission) {
+  const auto& response = admission == Admission::kServerBusy
+                             ? GetServiceUnavailableResponse()
+                             : GetTooManyRequestsResponse(false);
+  auto safe_socket = std::make_shared<tcp::socket>(std::move(socket));
+  net::async_write(*safe_socket, net::buffer(response),
+                   [safe_socket](beast::error_code ec, std::size_t) {
+                     safe_socket->shutdown(tcp::socket::shutdown_send, ec);
+                   });
+}
+
+SessionBase::SessionBase(tcp::socket&& socket, ConnectionSlot&& connection_slot,
+                         const SessionOptions& options,
+                         std::shared_ptr<TimerWheel> timer_wheel)
+    : stream_(std::move(socket)),
+      connection_slot_(std::move(connection_slot)),
+      options_(options),
+      timer_wheel_(std::move(timer_wheel)) {}
 
 void SessionBase::Run() {
+  if (timer_wheel_) {
+    // Таймер не продлевает жизнь сессии: сессия живет, пока у нее есть
+    // незавершенные операции.
+    timer_ = std::make_shared<WheelTimer>(
+        timer_wheel_, [weak_self = std::weak_ptr(GetSharedThis())]() {
+          if (auto self = weak_self.lock()) {
+            net::post(self->stream_.get_executor(),
+                      [self]() { self->OnTimeout(); });
+          }
+        });
+  }
   net::dispatch(stream_.get_executor(),
                 beast::bind_front_handler(&SessionBase::Read, GetSharedThis()));
 }
 
-void SessionBase::Read() {
+void SessionBase::Write(StringResponse&& response,
+                        const Clock::time_point response_start) {
+  LogResponse(response, response_start);
+
+  bool close = response.need_eof();
+  if (!close && pending_responses_ < kMaxPipelinedResponses &&
+      ParseBufferedRequest()) {
+    // Следующий запрос уже прочитан: откладываем ответ и обрабатываем его.
+    // Обработка запускается через post, чтобы не увеличивать глубину стека.
+    response_ = std::move(response);
+    http::response_serializer<http::string_body> serializer(response_);
+    beast::error_code ec;
+    while (!ec && !serializer.is_done()) {
+      serializer.next(ec, [this, &serializer](beast::error_code& ec,
+                                              const auto& buffers) {
+        for (auto buffer : beast::buffers_range_ref(buffers)) {
+          pending_write_.append(static_cast<const char*>(buffer.data()),
+                                buffer.size());
+        }
+        serializer.consume(beast::buffer_bytes(buffers));
+      });
+    }
+    ++pending_responses_;
+    return net::post(stream_.get_executor(),
+                     beast::bind_front_handler(&SessionBase::ProcessRequest,
+                                               GetSharedThis()));
+  }
+
+  response_ = std::move(response);
+  FlushPendingThen([self = GetSharedThis(), close]() {
+    http::async_write(self->stream_, self->response_,
+                      [self, close](beast::error_code ec,
+                                    std::size_t bytes_written) {
+                        self->OnWrite(close, ec, bytes_written);
+                      });
+  });
+}
+
+void SessionBase::FlushPendingThen(std::function<void()>&& next) {
+  if (pending_write_.empty()) {
+    return next();
+  }
+  net::async_write(
+      stream_, net::buffer(pending_write_),
+      [self = GetSharedThis(), next = std::move(next)](
+          beast::error_code ec, std::size_t bytes_written) {
+        self->pending_write_.clear();
+        self->pending_responses_ = 0;
+        if (ec) {
+          return self->OnWrite(true, ec, bytes_written);
+        }
+        next();
+      });
+}
+
+void SessionBase::PrepareParser() {
   request_.clear();
   request_.body().clear();
-  stream_.expires_after(30s);
+  parser_.emplace(std::move(request_));
+  parser_->header_limit(options_.header_limit);
+}
+
+bool SessionBase::ApplyBodyLimit() {
+  auto body_limit = GetBodyLimit(parser_->get().target());
+  if (auto length = parser_->content_length(); length && *length > body_limit) {
+    return false;
+  }
+  parser_->body_limit(body_limit);
+  return true;
+}
+
+bool SessionBase::ParseBufferedRequest() {
+  if (buffer_.size() == 0) {
+    return false;
+  }
+  PrepareParser();
+  beast::error_code ec;
+  bool is_body_limit_applied = false;
+  while (!parser_->is_done()) {
+    auto bytes_parsed = parser_->put(buffer_.data(), ec);
+    buffer_.consume(bytes_parsed);
+    if (ec || bytes_parsed == 0) {
+      break;
+    }
+    if (!is_body_limit_applied && parser_->is_header_done()) {
+      is_body_limit_applied = true;
+      if (!ApplyBodyLimit()) {
+        ec = http::error::body_limit;
+        break;
+      }
+    }
+  }
+  if (ec && ec != http::error::need_more) {
+    // Ошибка будет обработана в Read после отправки отложенных ответов.
+    parse_error_ = ec;
+    return false;
+  }
+  if (!parser_->is_done()) {
+    // Запрос прочитан не полностью: parser_ дочитает его из сокета в Read.
+    return false;
+  }
+  request_ = parser_->release();
+  parser_.reset();
+  return true;
+}
+
+void SessionBase::SetDeadline(Phase phase) {
+  phase_ = phase;
+  if (!timer_) {
+    return;
+  }
+  switch (phase) {
+    case Phase::kIdle:
+      return timer_->ExpiresAfter(options_.idle_timeout);
+    case Phase::kHeader:
+      return timer_->ExpiresAfter(options_.header_timeout);
+    case Phase::kBody:
+      return timer_->ExpiresAfter(options_.body_timeout);
+    case Phase::kResponse:
+      return timer_->ExpiresAfter(options_.response_timeout);
+  }
+}
+
+void SessionBase::OnTimeout() {
+  // Срок мог быть отложен после срабатывания колеса.
+  if (is_timed_out_ || !timer_->IsExpired()) {
+    return;
+  }
+  is_timed_out_ = true;
+  constexpr std::array<std::string_view, 4> kReasons{
+      "idle_timeout"sv, "header_timeout"sv, "body_timeout"sv,
+      "response_timeout"sv};
+  metrics::GetServerMetrics()
+      .http_connection_closes
+      .WithLabels({kReasons[static_cast<std::size_t>(phase_)]})
+      .Inc();
+  // Незавершенные операции сессии завершатся с ошибкой, и сессия будет
+  // разрушена.
+  beast::error_code ec;
+  stream_.socket().close(ec);
+}
+
+void SessionBase::Read() {
+  if (parse_error_) {
+    return OnRead(std::exchange(parse_error_, {}), 0);
+  }
+  if (!parser_) {
+    PrepareParser();
+  }
+  if (buffer_.size() != 0) {
+    return ReadHeader();
+  }
+  SetDeadline(Phase::kIdle);
+  stream_.socket().async_wait(
+      tcp::socket::wait_read,
+      [self = GetSharedThis()](beast::error_code ec) {
+        if (ec) {
+          return self->OnRead(ec, 0);
+        }
+        self->ReadHeader();
+      });
+}
+
+void SessionBase::ReadHeader() {
+  SetDeadline(Phase::kHeader);
+  http::async_read_header(
+      stream_, buffer_, *parser_,
+      beast::bind_front_handler(&SessionBase::OnReadHeader, GetSharedThis()));
+}
+
+void SessionBase::OnReadHeader(beast::error_code ec, std::size_t bytes_read) {
+  if (ec || parser_->is_done()) {
+    return OnRead(ec, bytes_read);
+  }
+  if (!ApplyBodyLimit()) {
+    return OnRead(http::error::body_limit, bytes_read);
+  }
+  SetDeadline(Phase::kBody);
   http::async_read(
-      stream_, buffer_, request_,
+      stream_, buffer_, *parser_,
       beast::bind_front_handler(&SessionBase::OnRead, GetSharedThis()));
 }
 
-// Логирует получаение запроса
 void SessionBase::OnRead(beast::error_code ec,
                          [[maybe_unused]] std::size_t bytes_read) {
+  if (is_timed_out_) {
+    return;
+  }
   if (ec == http::error::end_of_stream) {
     return Close();
   }
+  if (ec == http::error::body_limit || ec == http::error::header_limit) {
+    bool is_body_limit = ec == http::error::body_limit;
+    metrics::GetServerMetrics()
+        .admission_rejections
+        .WithLabels({is_body_limit ? "body_limit"sv : "header_limit"sv})
+        .Inc();
+    parser_.reset();
+    return SendRejection(is_body_limit ? GetPayloadTooLargeResponse()
+                                       : GetHeaderFieldsTooLargeResponse(),
+                         true);
+  }
   if (ec) {
     return LogError(ec, "read"sv);
   }
-  logger::Log(
-      json::value{
-          {"ip"s, stream_.socket().remote_endpoint().address().to_string()},
-          {"URI"s, request_.target()},
-          {"method"s, request_.method_string()}},
-      "request received"sv);
+  request_ = parser_->release();
+  parser_.reset();
+  ProcessRequest();
+}
+
+// Логирует получаение запроса
+void SessionBase::ProcessRequest() {
+  if (logger::ShouldLog(logger::LogEvent::kRequestReceived)) {
+    beast::error_code ec;
+    auto endpoint = stream_.socket().remote_endpoint(ec);
+    logger::Log(json::value{{"ip"s, endpoint.address().to_string()},
+                            {"URI"s, request_.target()},
+                            {"method"s, request_.method_string()}},
+                "request received"sv);
+  }
+  SetDeadline(Phase::kResponse);
+  if (options_.max_requests_per_connection > 0 &&
+      ++num_of_requests_ >= options_.max_requests_per_connection &&
+      request_.keep_alive()) {
+    // Ответ на последний разрешенный запрос закроет соединение.
+    request_.keep_alive(false);
+    metrics::GetServerMetrics()
+        .http_connection_closes.WithLabels({"max_requests"sv})
+        .Inc();
+  }
+  if (!connection_slot_.TryAcquireRequest()) {
+    return SendRejection(GetTooManyRequestsResponse(request_.keep_alive()),
+                         !request_.keep_alive());
+  }
   HandleRequest(std::move(request_));
 }
 
+void SessionBase::SendRejection(const std::string& response, bool close) {
+  pending_write_ += response;
+  if (!close && pending_responses_ < kMaxPipelinedResponses &&
+      ParseBufferedRequest()) {
+    ++pending_responses_;
+    return net::post(stream_.get_executor(),
+                     beast::bind_front_handler(&SessionBase::ProcessRequest,
+                                               GetSharedThis()));
+  }
+  FlushPendingThen(
+      [self = GetSharedThis(), close]() { self->OnWrite(close, {}, 0); });
+}
+
 void SessionBase::Close() {
+  if (timer_) {
+    timer_->Cancel();
+  }
   beast::error_code ec;
   stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
   if (ec) {
@@ -51,11 +395,82 @@ void SessionBase::Close() {
   }
 }
 
+#ifdef __linux__
+void SessionBase::SendFile(int file_fd, std::uint64_t offset,
+                           std::uint64_t size, SendFileHandler&& handler) {
+  beast::error_code ec;
+  stream_.socket().native_non_blocking(true, ec);
+  if (ec) {
+    return handler({}, true);
+  }
+  DoSendFile(file_fd, offset, offset + size, false, std::move(handler));
+}
+
+void SessionBase::DoSendFile(int file_fd, std::uint64_t offset,
+                             std::uint64_t end, bool is_started,
+                             SendFileHandler&& handler) {
+  // Ограничение одного вызова sendfile. После каждой порции отправка
+  // продолжается через очередь исполнителя, чтобы большой файл не занимал
+  // рабочий поток до конца отправки.
+  constexpr std::uint64_t kMaxChunkSize = 1 << 20;
+  auto& socket = stream_.socket();
+  while (offset < end) {
+    auto file_offset = static_cast<off_t>(offset);
+    ssize_t bytes_sent =
+        ::sendfile(socket.native_handle(), file_fd, &file_offset,
+                   static_cast<std::size_t>(
+                       std::min(end - offset, kMaxChunkSize)));
+    if (bytes_sent > 0) {
+      offset += static_cast<std::uint64_t>(bytes_sent);
+      if (offset == end) {
+        break;
+      }
+      return net::post(
+          stream_.get_executor(),
+          [self = GetSharedThis(), file_fd, offset, end,
+           handler = std::move(handler)]() mutable {
+            self->DoSendFile(file_fd, offset, end, true, std::move(handler));
+          });
+    }
+    if (bytes_sent == 0) {
+      // Файл стал короче, чем было объявлено в Content-Length.
+      return handler(net::error::eof, false);
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      socket.async_wait(
+          tcp::socket::wait_write,
+          [self = GetSharedThis(), file_fd, offset, end, is_started,
+           handler = std::move(handler)](beast::error_code ec) mutable {
+            if (ec) {
+              return handler(ec, false);
+            }
+            self->DoSendFile(file_fd, offset, end, is_started,
+                             std::move(handler));
+          });
+      return;
+    }
+    if ((errno == EINVAL || errno == ENOSYS) && !is_started) {
+      return handler({}, true);
+    }
+    return handler(beast::error_code(errno, sys::system_category()), false);
+  }
+  handler({}, false);
+}
+#endif
+
 void SessionBase::OnWrite(bool close, beast::error_code ec,
                           [[maybe_unused]] std::size_t bytes_written) {
+  if (is_timed_out_) {
+    return;
+  }
   if (ec) {
     return LogError(ec, "write"sv);
   }
+  pending_write_.clear();
+  pending_responses_ = 0;
   if (close) {
     return Close();
   }
@@ -7,9 +7,15 @@
 #include <boost/json.hpp>
 #include <boost/thread.hpp>
 #include <chrono>
+#include <functional>
+#include <optional>
 
 #include "../../lib/util/sdk.h"
 #include "../logger/logger.h"
+#include "../metrics/server_metrics.h"
+#include "admission_control.h"
+#include "sendfile_body.h"
+#include "timer_wheel.h"
 
 // Содержит ядро асинхронного сервера
 namespace http_server {
@@ -27,8 +33,88 @@ using namespace std::literals;
 // Логирует сетевые ошибки.
 void LogError(beast::error_code ec, std::string_view where);
 
+// Параметры слушающих сокетов и соединений.
+struct SocketOptions {
+  // Число слушающих сокетов на одном адресе. Если больше 1, сокеты
+  // открываются с SO_REUSEPORT, и ядро само распределяет между ними новые
+  // соединения, так что прием соединений не упирается в strand одного
+  // акцептора. Там, где SO_REUSEPORT нет, открывается один сокет.
+  std::size_t num_of_acceptors = 1;
+  // Размер очереди соединений, еще не принятых сервером.
+  int backlog = net::socket_base::max_listen_connections;
+  // Отключает алгоритм Нейгла, чтобы небольшие ответы отправлялись сразу.
+  bool tcp_nodelay = false;
+  // Размеры буферов сокета (SO_SNDBUF и SO_RCVBUF). 0 - значение системы.
+  // Задаются слушающему сокету, и принятые соединения наследуют их до
+  // установления соединения, когда согласуется размер окна TCP.
+  int send_buffer_size = 0;
+  int receive_buffer_size = 0;
+};
+
+// Шаг и число слотов колеса таймеров сессий: сроки проверяются с точностью
+// до 100 мс, а оборот колеса покрывает 102,4 с.
+inline constexpr std::chrono::milliseconds kTimerWheelResolution = 100ms;
+inline constexpr std::size_t kTimerWheelSlots = 1024;
+
+// Ограничения времени и числа запросов одного соединения. Сроки
+// отсчитываются от начала соответствующего этапа.
+struct SessionOptions {
+  using Milliseconds = std::chrono::milliseconds;
+
+  // Ожидание первого байта следующего запроса.
+  Milliseconds idle_timeout = 30s;
+  // Чтение заголовков запроса.
+  Milliseconds header_timeout = 10s;
+  // Чтение тела запроса.
+  Milliseconds body_timeout = 30s;
+  // Формирование и отправка ответа.
+  Milliseconds response_timeout = 30s;
+  // Число запросов, после которого соединение закрывается. 0 - без
+  // ограничения.
+  std::size_t max_requests_per_connection = 0;
+  // Размер заголовков запроса. На запрос с заголовками больше клиент сразу
+  // получает ответ 431, и соединение закрывается.
+  std::uint32_t header_limit = 8 * 1024;
+};
+
+// Размер тела запроса для обработчиков, которые не задают его сами (см.
+// Session::GetBodyLimit). Совпадает со значением Beast по умолчанию.
+inline constexpr std::uint64_t kDefaultBodyLimit = 1024 * 1024;
+
+// Разрешает нескольким сокетам слушать один адрес (SO_REUSEPORT).
+bool IsReusePortSupported() noexcept;
+void SetReusePort(tcp::acceptor& acceptor);
+
+// Отправляет клиенту заранее сериализованный ответ 503 (kServerBusy) или 429
+// (kTooManyConnections) и закрывает соединение.
+void RejectConnection(tcp::socket&& socket, Admission admission);
+
 // Является каркасом для класса Session.
 // Создан для уменьшения машинного кода и содержит только нешаблонные параметры.
+//
+// Запрос и строковый ответ хранятся в сессии и переиспользуются между
+// запросами одного keep-alive соединения, поэтому их буферы не выделяются
+// заново на каждый запрос.
+//
+// Поддерживает конвейерную обработку (HTTP pipelining): если в buffer_ уже
+// лежит следующий полный запрос, строковый ответ на текущий сериализуется в
+// pending_write_, а ответы на всю пачку запросов отправляются одной записью.
+//
+// Перед обработкой каждого запроса проверяется частота запросов клиента
+// (см. AdmissionControl). Запросы сверх лимита не доходят до обработчика:
+// клиент сразу получает заранее сериализованный ответ 429.
+//
+// Размер тела запроса ограничивается обработчиком в зависимости от target
+// (GetBodyLimit) сразу после чтения заголовков. Если Content-Length больше,
+// тело не читается: клиент получает заранее сериализованный ответ 413, и
+// соединение закрывается. Тело без Content-Length (chunked) читается, пока не
+// превысит ограничение. Данные соединения читаются в buffer_, размер
+// которого ограничен kMaxReadBufferSize.
+//
+// Сроки этапов (SessionOptions) отслеживает общее для всех сессий колесо
+// таймеров, а не отдельный таймер каждого сокета: сессия только сдвигает
+// срок своего WheelTimer. Если срок истек, сокет закрывается. Без колеса
+// сроки не ограничены.
 class SessionBase {
  public:
   using Milliseconds = std::chrono::milliseconds;
@@ -42,13 +128,115 @@ class SessionBase {
  protected:
   using HttpRequest = http::request<http::string_body>;
 
-  explicit SessionBase(tcp::socket&& socket);
+  SessionBase(tcp::socket&& socket, ConnectionSlot&& connection_slot,
+              const SessionOptions& options,
+              std::shared_ptr<TimerWheel> timer_wheel);
   virtual ~SessionBase() = default;
 
+  using StringResponse = http::response<http::string_body>;
+
+  // Передает ответ в Write через исполнитель сессии. Ответ может быть
+  // сформирован в другом потоке (например, в strand игровой сессии), а
+  // состояние сессии меняется только ее исполнителем.
+  template <typename Response>
+  void Send(Response&& response, const Clock::time_point response_start) {
+    net::dispatch(stream_.get_executor(),
+                  [self = GetSharedThis(),
+                   response = std::forward<Response>(response),
+                   response_start]() mutable {
+                    self->Write(std::move(response), response_start);
+                  });
+  }
+
   // Отправляет клиенту ответ. Логирует об окончании формирования ответа.
   template <typename Body, typename Fields>
   void Write(http::response<Body, Fields>&& response,
              const Clock::time_point response_start) {
+    LogResponse(response, response_start);
+
+    auto safe_response =
+        std::make_shared<http::response<Body, Fields>>(std::move(response));
+    FlushPendingThen([safe_response, self = GetSharedThis()]() {
+      http::async_write(self->stream_, *safe_response,
+                        [safe_response, self](beast::error_code ec,
+                                              std::size_t bytes_written) {
+                          self->OnWrite(safe_response->need_eof(), ec,
+                                        bytes_written);
+                        });
+    });
+  }
+
+  // Отправляет клиенту строковый ответ без выделения памяти под него: ответ
+  // переносится в response_. Если следующий запрос уже прочитан, ответ
+  // откладывается в pending_write_ (см. описание класса).
+  void Write(StringResponse&& response, const Clock::time_point response_start);
+
+#ifdef __linux__
+  // Отправляет клиенту файл. Заголовки сериализует Beast, а тело передается
+  // через sendfile(2). Если ядро не поддерживает sendfile для этого файла,
+  // тело дописывается буферизованным writer из SendfileBody.
+  template <typename Fields>
+  void Write(http::response<SendfileBody, Fields>&& response,
+             const Clock::time_point response_start) {
+    LogResponse(response, response_start);
+
+    using Response = http::response<SendfileBody, Fields>;
+    using Serializer = http::response_serializer<SendfileBody, Fields>;
+    auto safe_response = std::make_shared<Response>(std::move(response));
+    auto serializer = std::make_shared<Serializer>(*safe_response);
+    FlushPendingThen([safe_response, serializer, self = GetSharedThis()]() {
+      http::async_write_header(
+          self->stream_, *serializer,
+          [safe_response, serializer, self](beast::error_code ec,
+                                            std::size_t bytes_written) {
+            if (ec) {
+              return self->OnWrite(true, ec, bytes_written);
+            }
+            auto& body = safe_response->body();
+            self->SendFile(
+                body.file.native_handle(), body.offset, body.size,
+                [safe_response, serializer, self](beast::error_code ec,
+                                                  bool is_unsupported) {
+                  if (!is_unsupported) {
+                    return self->OnWrite(safe_response->need_eof(), ec,
+                                         safe_response->body().size);
+                  }
+                  http::async_write(
+                      self->stream_, *serializer,
+                      [safe_response, serializer, self](
+                          beast::error_code ec, std::size_t bytes_written) {
+                        self->OnWrite(safe_response->need_eof(), ec,
+                                      bytes_written);
+                      });
+                });
+          });
+    });
+  }
+#endif
+
+ private:
+  using RequestParser = http::request_parser<http::string_body>;
+
+  // Максимальное число ответов, которые копятся в pending_write_, прежде чем
+  // будут отправлены.
+  static constexpr std::size_t kMaxPipelinedResponses = 16;
+  // Максимальный размер буфера чтения соединения. Тело запроса проходит
+  // через буфер частями, поэтому буфер ограничивает только объем
+  // прочитанных, но еще не разобранных данных.
+  static constexpr std::size_t kMaxReadBufferSize = 64 * 1024;
+
+  // Вызывается по завершении SendFile. is_unsupported == true, если
+  // sendfile не поддерживается и ни одного байта не было отправлено.
+  using SendFileHandler =
+      std::function<void(beast::error_code ec, bool is_unsupported)>;
+
+  // Логирует об окончании формирования ответа.
+  template <typename Body, typename Fields>
+  void LogResponse(const http::response<Body, Fields>& response,
+                   const Clock::time_point response_start) {
+    if (!logger::ShouldLog(logger::LogEvent::kResponseSent)) {
+      return;
+    }
     Clock::time_point response_end = Clock::now();
     logger::Log(
         json::value{
@@ -60,34 +248,89 @@ class SessionBase {
                                   ? response[http::field::content_type]
                                   : "null"s}},
         "response sent"sv);
-
-    auto safe_response =
-        std::make_shared<http::response<Body, Fields>>(std::move(response));
-    auto self = GetSharedThis();
-    http::async_write(
-        stream_, *safe_response,
-        [safe_response, self](beast::error_code ec, std::size_t bytes_written) {
-          self->OnWrite(safe_response->need_eof(), ec, bytes_written);
-        });
   }
 
- private:
+#ifdef __linux__
+  // Передает size байт файла file_fd начиная с offset в сокет через
+  // sendfile(2). Когда буфер сокета заполнен, асинхронно ждет готовности
+  // сокета к записи.
+  void SendFile(int file_fd, std::uint64_t offset, std::uint64_t size,
+                SendFileHandler&& handler);
+  // Передает одну порцию байт [offset, end) и продолжает отправку через
+  // очередь исполнителя. is_started == true, если часть файла уже
+  // отправлена.
+  void DoSendFile(int file_fd, std::uint64_t offset, std::uint64_t end,
+                  bool is_started, SendFileHandler&& handler);
+#endif
+
+  // Если в pending_write_ есть отложенные ответы, отправляет их и затем
+  // вызывает next. Иначе вызывает next сразу.
+  void FlushPendingThen(std::function<void()>&& next);
+
+  // Готовит parser_ к чтению нового запроса, передавая ему request_ вместе с
+  // уже выделенными буферами.
+  void PrepareParser();
+
+  // Пытается разобрать следующий запрос из buffer_ без обращения к сокету.
+  // Возвращает true, если запрос разобран полностью.
+  bool ParseBufferedRequest();
+
+  // Задает parser_ ограничение размера тела для разобранных заголовков.
+  // Возвращает false, если Content-Length больше ограничения.
+  bool ApplyBodyLimit();
+
+  // Этап сессии, срок которого отслеживается.
+  enum class Phase { kIdle, kHeader, kBody, kResponse };
+
+  // Назначает срок этапа phase, отсчитывая его от текущего момента.
+  void SetDeadline(Phase phase);
+  // Закрывает сокет, если срок текущего этапа истек.
+  void OnTimeout();
+
+  // Ждет первый байт запроса, затем читает заголовки и, если нужно, тело.
   void Read();
+  void ReadHeader();
+  void OnReadHeader(beast::error_code ec, std::size_t bytes_read);
   void OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read);
+  // Логирует получение запроса и передает его на обработку.
+  void ProcessRequest();
+  // Отправляет заранее сериализованный ответ с ошибкой, не передавая запрос
+  // обработчику. Если close == true, затем закрывает соединение.
+  void SendRejection(const std::string& response, bool close);
   void Close();
   void OnWrite(bool close, beast::error_code ec,
                [[maybe_unused]] std::size_t bytes_written);
 
   virtual void HandleRequest(HttpRequest&& request) = 0;
+  virtual std::uint64_t GetBodyLimit(std::string_view target) = 0;
   virtual std::shared_ptr<SessionBase> GetSharedThis() = 0;
 
   beast::tcp_stream stream_;
-  beast::flat_buffer buffer_;
+  ConnectionSlot connection_slot_;
+  SessionOptions options_;
+  std::shared_ptr<TimerWheel> timer_wheel_;
+  std::shared_ptr<WheelTimer> timer_;
+  Phase phase_ = Phase::kIdle;
+  bool is_timed_out_ = false;
+  std::size_t num_of_requests_ = 0;
+  beast::flat_buffer buffer_{kMaxReadBufferSize};
   HttpRequest request_;
+  std::optional<RequestParser> parser_;
+  StringResponse response_;
+  std::string pending_write_;
+  std::size_t pending_responses_ = 0;
+  beast::error_code parse_error_;
 };
 
 // Наследует класс SessionBase и содержит в себе только шаблонный параметр
-// RequestHandler.
+// RequestHandler. Если у обработчика есть метод GetBodyLimit(target), он
+// задает размер тела запроса, иначе используется kDefaultBodyLimit.
+// Обработчик можно передать через std::ref.
+// Запрос передается обработчику по ссылке на request_ и остается валидным до
+// вызова send. После вызова send обработчик не должен обращаться к запросу:
+// на его месте уже может разбираться следующий конвейерный запрос.
+// send можно вызвать из любого потока: ответ передается в Write через
+// исполнитель сессии.
 // Отвечает за шаги обработки HTTP-сессии:
 //  - Чтение запроса;
 //  - Обработка запроса;
@@ -97,8 +340,12 @@ class Session : public SessionBase,
                 public std::enable_shared_from_this<Session<RequestHandler>> {
  public:
   template <typename Handler>
-  Session(tcp::socket&& socket, Handler&& request_handler)
-      : SessionBase(std::move(socket)),
+  Session(tcp::socket&& socket, Handler&& request_handler,
+          ConnectionSlot connection_slot = {},
+          const SessionOptions& options = {},
+          std::shared_ptr<TimerWheel> timer_wheel = nullptr)
+      : SessionBase(std::move(socket), std::move(connection_slot), options,
+                    std::move(timer_wheel)),
         request_handler_(std::forward<Handler>(request_handler)) {}
 
  private:
@@ -112,30 +359,63 @@ class Session : public SessionBase,
     Clock::time_point start = Clock::now();
     request_handler_(std::move(request),
                      [start, self = this->shared_from_this()](auto&& response) {
-                       self->Write(std::forward<decltype(response)>(response),
-                                   start);
+                       self->Send(std::forward<decltype(response)>(response),
+                                  start);
                      });
   }
 
+  std::uint64_t GetBodyLimit(std::string_view target) override {
+    auto& handler = static_cast<std::unwrap_reference_t<RequestHandler>&>(
+        request_handler_);
+    if constexpr (requires { handler.GetBodyLimit(target); }) {
+      return handler.GetBodyLimit(target);
+    } else {
+      return kDefaultBodyLimit;
+    }
+  }
+
   RequestHandler request_handler_;
 };
 
 // Асинхронно принимает TCP-соединения клиентов с сервером. Приняв соединение,
 // Listener создает экземпляр класса Session, который отвечает за обработку
 // HTTP-сессии.
+// Соединения сверх лимитов AdmissionLimits не получают сессию: клиенту сразу
+// отправляется ответ 503 или 429, и соединение закрывается.
+// Несколько экземпляров Listener могут слушать один адрес (см.
+// SocketOptions::num_of_acceptors) и делить один AdmissionControl.
 template <typename RequestHandler>
 class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
  public:
   template <typename Handler>
   explicit Listener(net::io_context& ioc, const tcp::endpoint& endpoint,
+                    const SocketOptions& options,
+                    const SessionOptions& session_options,
+                    std::shared_ptr<TimerWheel> timer_wheel,
+                    std::shared_ptr<AdmissionControl> admission_control,
                     Handler&& request_handler)
       : ioc_(ioc),
         acceptor_(net::make_strand(ioc)),
+        tcp_nodelay_(options.tcp_nodelay),
+        session_options_(session_options),
+        timer_wheel_(std::move(timer_wheel)),
+        admission_control_(std::move(admission_control)),
         request_handler_(std::forward<Handler>(request_handler)) {
     acceptor_.open(endpoint.protocol());
     acceptor_.set_option(net::socket_base::reuse_address(true));
+    if (options.num_of_acceptors > 1) {
+      SetReusePort(acceptor_);
+    }
+    if (options.send_buffer_size > 0) {
+      acceptor_.set_option(
+          net::socket_base::send_buffer_size(options.send_buffer_size));
+    }
+    if (options.receive_buffer_size > 0) {
+      acceptor_.set_option(
+          net::socket_base::receive_buffer_size(options.receive_buffer_size));
+    }
     acceptor_.bind(endpoint);
-    acceptor_.listen(net::socket_base::max_listen_connections);
+    acceptor_.listen(options.backlog);
   }
 
   void Run() { DoAccept(); }
@@ -151,31 +431,60 @@ class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
     if (ec) {
       return LogError(ec, "accept"sv);
     }
-    AsyncRunSession(std::move(socket));
+    // Если клиент уже отключился, адрес не получить, и соединение просто
+    // закрывается.
+    if (tcp_nodelay_) {
+      socket.set_option(tcp::no_delay(true), ec);
+    }
+    if (auto address = socket.remote_endpoint(ec).address(); !ec) {
+      auto admission = admission_control_->TryAcquireConnection(address);
+      if (admission == Admission::kAccepted) {
+        AsyncRunSession(std::move(socket),
+                        ConnectionSlot(admission_control_, address));
+      } else {
+        RejectConnection(std::move(socket), admission);
+      }
+    }
     DoAccept();
   }
 
-  void AsyncRunSession(tcp::socket&& socket) {
-    std::make_shared<Session<RequestHandler>>(std::move(socket),
-                                              request_handler_)
+  void AsyncRunSession(tcp::socket&& socket, ConnectionSlot&& slot) {
+    std::make_shared<Session<RequestHandler>>(
+        std::move(socket), request_handler_, std::move(slot),
+        session_options_, timer_wheel_)
         ->Run();
   }
 
   net::io_context& ioc_;
   tcp::acceptor acceptor_;
+  bool tcp_nodelay_;
+  SessionOptions session_options_;
+  std::shared_ptr<TimerWheel> timer_wheel_;
+  std::shared_ptr<AdmissionControl> admission_control_;
   RequestHandler request_handler_;
 };
 
 // Создает экземпляры класса Listener для приема соединения от клиентов и
-// асинхронной обработки запросов.
+// асинхронной обработки запросов. Сроки всех сессий отслеживает одно колесо
+// таймеров с шагом kTimerWheelResolution.
 template <typename RequestHandler>
 void ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint,
-               RequestHandler&& handler) {
+               SocketOptions options, const SessionOptions& session_options,
+               const AdmissionLimits& limits, RequestHandler&& handler) {
   using MyListener = Listener<std::decay_t<RequestHandler>>;
 
-  std::make_shared<MyListener>(ioc, endpoint,
-                               std::forward<RequestHandler>(handler))
-      ->Run();
+  if (options.num_of_acceptors == 0 || !IsReusePortSupported()) {
+    options.num_of_acceptors = 1;
+  }
+  auto admission_control = std::make_shared<AdmissionControl>(limits);
+  auto timer_wheel = std::make_shared<TimerWheel>(
+      ioc.get_executor(), kTimerWheelResolution, kTimerWheelSlots);
+  timer_wheel->Start();
+  for (std::size_t i = 0; i < options.num_of_acceptors; ++i) {
+    std::make_shared<MyListener>(ioc, endpoint, options, session_options,
+                                 timer_wheel, admission_control, handler)
+        ->Run();
+  }
 }
 
 }  // namespace http_server
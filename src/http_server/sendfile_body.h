@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/optional.hpp>
+#include <cstdint>
+
+namespace http_server {
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+// Тело HTTP-ответа для отправки файла или его части с диска. SessionBase на
+// Linux отправляет такое тело через sendfile(2) прямо из кеша страниц в
+// сокет, минуя буферы в пространстве пользователя. Если sendfile недоступен
+// (другая ОС, файловая система без поддержки и тд.), тело отправляется
+// буферизованным writer.
+struct SendfileBody {
+  // Открытый файл и отправляемая часть: size байт начиная с offset.
+  struct value_type {
+    beast::file file;
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+
+    // Открывает файл path для чтения целиком.
+    void open(const char* path, beast::error_code& ec) {
+      file.open(path, beast::file_mode::read, ec);
+      if (!ec) {
+        offset = 0;
+        size = file.size(ec);
+      }
+    }
+  };
+
+  static std::uint64_t size(const value_type& body) noexcept {
+    return body.size;
+  }
+
+  class writer {
+   public:
+    using const_buffers_type = net::const_buffer;
+
+    template <bool isRequest, class Fields>
+    writer(http::header<isRequest, Fields>&, value_type& body)
+        : body_(body) {}
+
+    void init(beast::error_code& ec) {
+      remain_ = body_.size;
+      body_.file.seek(body_.offset, ec);
+    }
+
+    boost::optional<std::pair<const_buffers_type, bool>> get(
+        beast::error_code& ec) {
+      if (remain_ == 0) {
+        ec = {};
+        return boost::none;
+      }
+      auto amount = static_cast<std::size_t>(
+          std::min<std::uint64_t>(remain_, sizeof(buffer_)));
+      auto bytes_read = body_.file.read(buffer_, amount, ec);
+      if (ec) {
+        return boost::none;
+      }
+      if (bytes_read == 0) {
+        // Файл стал короче, чем было объявлено в Content-Length.
+        ec = http::error::short_read;
+        return boost::none;
+      }
+      remain_ -= bytes_read;
+      return std::make_pair(net::const_buffer(buffer_, bytes_read),
+                            remain_ > 0);
+    }
+
+   private:
+    static constexpr std::size_t kBufferSize = 4096;
+
+    value_type& body_;
+    std::uint64_t remain_ = 0;
+    char buffer_[kBufferSize];
+  };
+};
+
+}  // namespace http_server
@@ -0,0 +1,110 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+namespace http_server {
+
+TimerWheel::TimerWheel(net::any_io_executor executor,
+                       Clock::duration resolution, std::size_t num_of_slots)
+    : timer_(std::move(executor)),
+      resolution_(resolution),
+      slots_(std::max<std::size_t>(num_of_slots, 2)),
+      current_tick_(ToTick(Clock::now())) {}
+
+void TimerWheel::Start() { Wait(); }
+
+void TimerWheel::Stop() {
+  std::lock_guard lock(mutex_);
+  is_stopped_ = true;
+  timer_.cancel();
+  for (auto& slot : slots_) {
+    slot.clear();
+  }
+}
+
+void TimerWheel::Add(const std::shared_ptr<WheelTimer>& timer,
+                     Clock::time_point deadline) {
+  std::lock_guard lock(mutex_);
+  if (is_stopped_) {
+    return;
+  }
+  // Сроки в прошлом проверяются ближайшим слотом, а сроки за пределами
+  // оборота колеса - последним слотом оборота, после чего таймер
+  // перекладывается.
+  auto num_of_slots = static_cast<Tick>(slots_.size());
+  auto tick = std::clamp(ToTick(deadline), current_tick_,
+                         current_tick_ + num_of_slots - 1);
+  slots_[static_cast<std::size_t>(tick % num_of_slots)].push_back(timer);
+  auto slot_time = (resolution_ * tick).count();
+  if (slot_time < timer->scheduled_.load()) {
+    timer->scheduled_.store(slot_time);
+  }
+}
+
+TimerWheel::Tick TimerWheel::ToTick(Clock::time_point time) const noexcept {
+  auto since_epoch = time.time_since_epoch();
+  return (since_epoch + resolution_ - Clock::duration(1)) / resolution_;
+}
+
+void TimerWheel::Wait() {
+  timer_.expires_at(Clock::time_point(resolution_ * current_tick_));
+  timer_.async_wait([self = shared_from_this()](const auto& ec) {
+    if (!ec) {
+      self->OnTick(Clock::now());
+    }
+  });
+}
+
+void TimerWheel::OnTick(Clock::time_point now) {
+  {
+    std::lock_guard lock(mutex_);
+    if (is_stopped_) {
+      return;
+    }
+    auto num_of_slots = static_cast<Tick>(slots_.size());
+    std::vector<std::weak_ptr<WheelTimer>> expiring;
+    while (Clock::time_point(resolution_ * current_tick_) <= now) {
+      expiring.swap(slots_[static_cast<std::size_t>(current_tick_ %
+                                                    num_of_slots)]);
+      ++current_tick_;
+      for (const auto& weak_timer : expiring) {
+        auto timer = weak_timer.lock();
+        if (!timer) {
+          continue;
+        }
+        // Сначала снимаем отметку о слоте, затем читаем срок: если владелец
+        // одновременно сократит срок, он либо увидит, что таймера нет в
+        // колесе, и добавит его сам, либо колесо прочитает новый срок.
+        timer->scheduled_.store(WheelTimer::kNever);
+        auto deadline = timer->deadline_.load();
+        if (deadline <= now.time_since_epoch().count()) {
+          timer->handler_();
+        } else if (deadline != WheelTimer::kNever) {
+          auto tick = std::min(
+              ToTick(Clock::time_point(Clock::duration(deadline))),
+              current_tick_ + num_of_slots - 1);
+          slots_[static_cast<std::size_t>(tick % num_of_slots)].push_back(
+              timer);
+          timer->scheduled_.store((resolution_ * tick).count());
+        }
+      }
+      expiring.clear();
+    }
+  }
+  Wait();
+}
+
+WheelTimer::WheelTimer(std::shared_ptr<TimerWheel> wheel, Handler handler)
+    : wheel_(std::move(wheel)), handler_(std::move(handler)) {}
+
+void WheelTimer::ExpiresAt(Clock::time_point deadline) {
+  auto value = deadline.time_since_epoch().count();
+  deadline_.store(value);
+  if (value < scheduled_.load()) {
+    wheel_->Add(shared_from_this(), deadline);
+  }
+}
+
+void WheelTimer::Cancel() noexcept { deadline_.store(kNever); }
+
+}  // namespace http_server
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace http_server {
+
+namespace net = boost::asio;
+
+class WheelTimer;
+
+// Хешированное колесо таймеров: один net::steady_timer на все таймеры
+// колеса. Время разбито на интервалы по resolution, и таймер лежит в слоте
+// интервала, в котором истекает его срок. Каждый интервал колесо проверяет
+// один слот, поэтому стоимость не зависит от числа таймеров, которые еще не
+// истекли. Срок срабатывания округляется вверх до resolution.
+//
+// Срок таймера можно часто откладывать (например, на каждый запрос
+// keep-alive соединения), не обращаясь к колесу: таймер переносится в нужный
+// слот, только когда колесо дойдет до старого слота.
+class TimerWheel : public std::enable_shared_from_this<TimerWheel> {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  TimerWheel(net::any_io_executor executor, Clock::duration resolution,
+             std::size_t num_of_slots);
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // Запускает проверку слотов. Колесо живет, пока запущено.
+  void Start();
+  void Stop();
+
+ private:
+  friend class WheelTimer;
+
+  using Tick = std::int64_t;
+
+  // Кладет таймер в слот, соответствующий сроку deadline.
+  void Add(const std::shared_ptr<WheelTimer>& timer,
+           Clock::time_point deadline);
+  Tick ToTick(Clock::time_point time) const noexcept;
+  void Wait();
+  void OnTick(Clock::time_point now);
+
+  net::steady_timer timer_;
+  Clock::duration resolution_;
+  std::mutex mutex_;
+  std::vector<std::vector<std::weak_ptr<WheelTimer>>> slots_;
+  // Номер интервала, слот которого будет проверен следующим.
+  Tick current_tick_;
+  bool is_stopped_ = false;
+};
+
+// Таймер колеса TimerWheel. Вызывает handler в потоке колеса, когда срок
+// истек. Обработчик должен быть быстрым: обычно он только передает событие
+// в исполнитель владельца. Срок мог быть отложен после вызова, поэтому
+// владелец должен перепроверить его через IsExpired.
+class WheelTimer : public std::enable_shared_from_this<WheelTimer> {
+ public:
+  using Clock = TimerWheel::Clock;
+  using Handler = std::function<void()>;
+
+  WheelTimer(std::shared_ptr<TimerWheel> wheel, Handler handler);
+  WheelTimer(const WheelTimer&) = delete;
+  WheelTimer& operator=(const WheelTimer&) = delete;
+
+  void ExpiresAt(Clock::time_point deadline);
+  void ExpiresAfter(Clock::duration duration) {
+    ExpiresAt(Clock::now() + duration);
+  }
+  void Cancel() noexcept;
+
+  bool IsExpired(Clock::time_point now = Clock::now()) const noexcept {
+    return deadline_.load() <= now.time_since_epoch().count();
+  }
+
+ private:
+  friend class TimerWheel;
+
+  static constexpr Clock::rep kNever = Clock::duration::max().count();
+
+  std::shared_ptr<TimerWheel> wheel_;
+  Handler handler_;
+  // Срок срабатывания и срок слота, в котором лежит таймер (kNever, если
+  // таймера нет в колесе). Срок может быть позже срока слота: тогда колесо
+  // переложит таймер, когда дойдет до слота.
+  std::atomic<Clock::rep> deadline_{kNever};
+  std::atomic<Clock::rep> scheduled_{kNever};
+};
+
+}  // namespace http_server
@@ -0,0 +1,145 @@
+#include "async_log_writer.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace logger {
+
+AsyncLogWriter::AsyncLogWriter(std::ostream& out, std::size_t capacity,
+                               OverflowPolicy policy)
+    : out_(out),
+      policy_(policy),
+      mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+      cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+  for (std::size_t i = 0; i <= mask_; ++i) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  writer_ = std::thread([this] { Run(); });
+}
+
+AsyncLogWriter::~AsyncLogWriter() { Stop(); }
+
+bool AsyncLogWriter::Push(std::string&& record) {
+  while (!is_stopped_.load(std::memory_order_relaxed)) {
+    if (TryPush(record)) {
+      // Барьер упорядочивает запись в очередь и чтение is_waiting_ с
+      // аналогичным барьером в Run: либо поток вывода увидит запись, либо
+      // здесь будет видно, что он заснул.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (is_waiting_.load(std::memory_order_relaxed)) {
+        WakeWriter();
+      }
+      return true;
+    }
+    if (policy_ == OverflowPolicy::kDrop) {
+      break;
+    }
+    std::this_thread::yield();
+  }
+  dropped_count_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void AsyncLogWriter::Stop() {
+  if (is_stopped_.exchange(true)) {
+    return;
+  }
+  WakeWriter();
+  writer_.join();
+  // Поток вывода мог завершиться до того, как в очередь попали последние
+  // записи.
+  std::string batch;
+  while (WriteBatch(batch) != 0) {
+  }
+}
+
+std::uint64_t AsyncLogWriter::GetWrittenCount() const noexcept {
+  return written_count_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t AsyncLogWriter::GetDroppedCount() const noexcept {
+  return dropped_count_.load(std::memory_order_relaxed);
+}
+
+bool AsyncLogWriter::TryPush(std::string& record) {
+  std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    Cell& cell = cells_[pos & mask_];
+    std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed)) {
+        cell.record = std::move(record);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      // Ячейка еще не прочитана потоком вывода: очередь заполнена.
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool AsyncLogWriter::TryPop(std::string& record) {
+  Cell& cell = cells_[dequeue_pos_ & mask_];
+  std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+  if (sequence != dequeue_pos_ + 1) {
+    return false;
+  }
+  record.swap(cell.record);
+  cell.record.clear();
+  cell.sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+  ++dequeue_pos_;
+  return true;
+}
+
+bool AsyncLogWriter::HasRecord() const noexcept {
+  return cells_[dequeue_pos_ & mask_].sequence.load(
+             std::memory_order_acquire) == dequeue_pos_ + 1;
+}
+
+void AsyncLogWriter::WakeWriter() noexcept {
+  if (is_waiting_.exchange(false)) {
+    is_waiting_.notify_one();
+  }
+}
+
+void AsyncLogWriter::Run() {
+  std::string batch;
+  while (!is_stopped_.load(std::memory_order_relaxed)) {
+    if (WriteBatch(batch) != 0) {
+      continue;
+    }
+    // Очередь пуста: объявляем о сне и перепроверяем очередь, чтобы не
+    // пропустить запись, добавленную до объявления.
+    is_waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!HasRecord() && !is_stopped_.load(std::memory_order_relaxed)) {
+      is_waiting_.wait(true, std::memory_order_acquire);
+    }
+    is_waiting_.store(false, std::memory_order_relaxed);
+  }
+  while (WriteBatch(batch) != 0) {
+  }
+}
+
+std::size_t AsyncLogWriter::WriteBatch(std::string& batch) {
+  batch.clear();
+  std::size_t count = 0;
+  std::string record;
+  while (batch.size() < kMaxBatchSize && TryPop(record)) {
+    batch += record;
+    ++count;
+  }
+  if (count != 0) {
+    out_.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+    out_.flush();
+    written_count_.fetch_add(count, std::memory_order_relaxed);
+  }
+  return count;
+}
+
+}  // namespace logger
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace logger {
+
+// Поведение при переполнении очереди записей.
+enum class OverflowPolicy {
+  // Запись отбрасывается и учитывается в счетчике отброшенных.
+  kDrop,
+  // Поток, пишущий в лог, ждет освобождения места в очереди.
+  kBlock
+};
+
+// Асинхронно выводит уже отформатированные записи лога.
+// Записи помещаются в ограниченную кольцевую очередь без блокировок (MPSC, по
+// схеме Д. Вьюкова), а отдельный поток забирает их пачками и выводит в out
+// одной операцией записи на пачку. Опустошив очередь, поток вывода засыпает
+// на atomic::wait, и его будит первая следующая запись.
+class AsyncLogWriter {
+ public:
+  // capacity округляется вверх до степени двойки.
+  AsyncLogWriter(std::ostream& out, std::size_t capacity,
+                 OverflowPolicy policy);
+  AsyncLogWriter(const AsyncLogWriter&) = delete;
+  AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+  ~AsyncLogWriter();
+
+  // Помещает запись в очередь. Возвращает false, если запись отброшена или
+  // вывод уже остановлен.
+  bool Push(std::string&& record);
+
+  // Выводит все записи из очереди и останавливает поток вывода.
+  // Вызывается, когда остальные потоки больше не пишут в лог.
+  void Stop();
+
+  std::uint64_t GetWrittenCount() const noexcept;
+  std::uint64_t GetDroppedCount() const noexcept;
+
+ private:
+  // Максимальный размер пачки записей, выводимой за одну операцию.
+  static constexpr std::size_t kMaxBatchSize = 64 * 1024;
+
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    std::string record;
+  };
+
+  bool TryPush(std::string& record);
+  bool TryPop(std::string& record);
+  // Проверяет, есть ли в очереди запись для потока вывода.
+  bool HasRecord() const noexcept;
+  // Будит поток вывода, если он ждет записей.
+  void WakeWriter() noexcept;
+  // Забирает записи из очереди и выводит их, пока не вызван Stop.
+  void Run();
+  // Выводит все записи, которые есть в очереди. Возвращает их число.
+  std::size_t WriteBatch(std::string& batch);
+
+  std::ostream& out_;
+  OverflowPolicy policy_;
+  std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+
+  alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+  alignas(64) std::size_t dequeue_pos_ = 0;
+
+  std::atomic<std::uint64_t> written_count_{0};
+  std::atomic<std::uint64_t> dropped_count_{0};
+  std::atomic<bool> is_stopped_{false};
+  // Поток вывода ждет записей. Сбрасывается тем, кто его будит.
+  alignas(64) std::atomic<bool> is_waiting_{false};
+  std::thread writer_;
+};
+
+}  // namespace logger
@@ -0,0 +1,110 @@
+#include "log_filter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace logger {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::array<std::string_view, 5> kLogLevelNames{
+    "debug"sv, "info"sv, "warning"sv, "error"sv, "off"sv};
+constexpr std::array<std::string_view, kNumOfLogEvents> kLogEventNames{
+    "request"sv, "response"sv, "error"sv, "server"sv};
+
+}  // namespace
+
+namespace detail {
+
+std::uint32_t NextSampleRandom() noexcept {
+  // xorshift32: достаточно для выборки и не требует блокировок.
+  thread_local std::uint32_t state = std::random_device{}() | 1u;
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+}  // namespace detail
+
+void SetLogLevel(LogLevel level) noexcept {
+  detail::min_log_level.store(level, std::memory_order_relaxed);
+}
+
+LogLevel GetLogLevel() noexcept {
+  return detail::min_log_level.load(std::memory_order_relaxed);
+}
+
+void SetSamplingRate(LogEvent event, double rate) noexcept {
+  rate = std::clamp(rate, 0.0, 1.0);
+  detail::sampling_thresholds[static_cast<std::size_t>(event)].store(
+      static_cast<std::uint64_t>(rate *
+                                 static_cast<double>(detail::kAlwaysLog)),
+      std::memory_order_relaxed);
+}
+
+double GetSamplingRate(LogEvent event) noexcept {
+  return static_cast<double>(
+             detail::sampling_thresholds[static_cast<std::size_t>(event)].load(
+                 std::memory_order_relaxed)) /
+         static_cast<double>(detail::kAlwaysLog);
+}
+
+void SetSamplingRates(std::string_view rates) {
+  while (!rates.empty()) {
+    auto item = rates.substr(0, rates.find(','));
+    rates.remove_prefix(std::min(item.size() + 1, rates.size()));
+
+    auto separator = item.find('=');
+    if (separator == std::string_view::npos) {
+      throw std::invalid_argument("Invalid log sampling rate: "s +
+                                  std::string(item));
+    }
+    auto event = ParseLogEvent(item.substr(0, separator));
+    if (!event) {
+      throw std::invalid_argument("Unknown log event: "s +
+                                  std::string(item.substr(0, separator)));
+    }
+    auto value = item.substr(separator + 1);
+    double rate = 0;
+    auto [end, ec] =
+        std::from_chars(value.data(), value.data() + value.size(), rate);
+    if (ec != std::errc() || end != value.data() + value.size() || rate < 0 ||
+        rate > 1) {
+      throw std::invalid_argument("Invalid log sampling rate: "s +
+                                  std::string(item));
+    }
+    SetSamplingRate(*event, rate);
+  }
+}
+
+std::string_view ToString(LogLevel level) noexcept {
+  return kLogLevelNames[static_cast<std::size_t>(level)];
+}
+
+std::string_view ToString(LogEvent event) noexcept {
+  return kLogEventNames[static_cast<std::size_t>(event)];
+}
+
+std::optional<LogLevel> ParseLogLevel(std::string_view level) noexcept {
+  auto it = std::find(kLogLevelNames.begin(), kLogLevelNames.end(), level);
+  if (it == kLogLevelNames.end()) {
+    return std::nullopt;
+  }
+  return static_cast<LogLevel>(it - kLogLevelNames.begin());
+}
+
+std::optional<LogEvent> ParseLogEvent(std::string_view event) noexcept {
+  auto it = std::find(kLogEventNames.begin(), kLogEventNames.end(), event);
+  if (it == kLogEventNames.end()) {
+    return std::nullopt;
+  }
+  return static_cast<LogEvent>(it - kLogEventNames.begin());
+}
+
+}  // namespace logger
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace logger {
+
+// Уровни важности записей лога. kOff отключает вывод всех записей.
+enum class LogLevel : std::uint8_t { kDebug, kInfo, kWarning, kError, kOff };
+
+// Типы сообщений лога. Для каждого типа задается своя доля выводимых записей.
+enum class LogEvent : std::uint8_t {
+  kRequestReceived,
+  kResponseSent,
+  kError,
+  kServer
+};
+
+inline constexpr std::size_t kNumOfLogEvents = 4;
+
+namespace detail {
+
+// Уровни важности сообщений каждого типа.
+inline constexpr std::array<LogLevel, kNumOfLogEvents> kLogEventLevels{
+    LogLevel::kInfo, LogLevel::kInfo, LogLevel::kError, LogLevel::kInfo};
+
+// Доля записей хранится как порог для 32-битного случайного числа: запись
+// выводится, если число меньше порога. kAlwaysLog соответствует доле 1.
+inline constexpr std::uint64_t kAlwaysLog = std::uint64_t{1} << 32;
+
+inline std::atomic<LogLevel> min_log_level{LogLevel::kInfo};
+inline std::array<std::atomic<std::uint64_t>, kNumOfLogEvents>
+    sampling_thresholds{kAlwaysLog, kAlwaysLog, kAlwaysLog, kAlwaysLog};
+
+// Возвращает случайное 32-битное число из генератора текущего потока.
+std::uint32_t NextSampleRandom() noexcept;
+
+}  // namespace detail
+
+// Проверяет, нужно ли выводить сообщение типа event. Вызывается до
+// формирования записи, чтобы отключенные сообщения ничего не стоили.
+inline bool ShouldLog(LogEvent event) noexcept {
+  auto index = static_cast<std::size_t>(event);
+  if (detail::kLogEventLevels[index] <
+      detail::min_log_level.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  auto threshold =
+      detail::sampling_thresholds[index].load(std::memory_order_relaxed);
+  if (threshold >= detail::kAlwaysLog) {
+    return true;
+  }
+  return threshold != 0 && detail::NextSampleRandom() < threshold;
+}
+
+void SetLogLevel(LogLevel level) noexcept;
+LogLevel GetLogLevel() noexcept;
+
+// Задает долю выводимых сообщений типа event. rate ограничивается отрезком
+// [0, 1].
+void SetSamplingRate(LogEvent event, double rate) noexcept;
+double GetSamplingRate(LogEvent event) noexcept;
+
+// Задает доли выводимых сообщений из строки вида "request=0.01,error=1".
+// Выбрасывает std::invalid_argument, если строка некорректна.
+void SetSamplingRates(std::string_view rates);
+
+std::string_view ToString(LogLevel level) noexcept;
+std::string_view ToString(LogEvent event) noexcept;
+std::optional<LogLevel> ParseLogLevel(std::string_view level) noexcept;
+std::optional<LogEvent> ParseLogEvent(std::string_view event) noexcept;
+
+}  // namespace logger
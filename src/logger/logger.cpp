@@ -2,16 +2,28 @@
 
 namespace logger {
 
-void Formatter(const logging::record_view& rec,
-               logging::formatting_ostream& log_stream) {
+namespace {
+
+// Асинхронный вывод записей. Пока он не запущен, записи выводятся
+// синхронно через Boost.Log.
+std::unique_ptr<AsyncLogWriter> async_writer;
+std::atomic<AsyncLogWriter*> active_async_writer{nullptr};
+
+std::string EncodeRecord(const boost::posix_time::ptime& ts,
+                         const json::value& data, std::string_view message) {
   json::object json_log;
+  json_log["timestamp"s] = boost::posix_time::to_iso_extended_string(ts);
+  json_log["data"s] = data;
+  json_log["message"s] = message;
+  return json::serialize(json_log);
+}
 
-  auto ts = rec[timestamp];
-  json_log["timestamp"s] = boost::posix_time::to_iso_extended_string(*ts);
-  json_log["data"s] = *rec[additional_data];
-  json_log["message"s] = *rec[expr::smessage];
+}  // namespace
 
-  log_stream << json::serialize(json_log);
+void Formatter(const logging::record_view& rec,
+               logging::formatting_ostream& log_stream) {
+  log_stream << EncodeRecord(*rec[timestamp], *rec[additional_data],
+                             *rec[expr::smessage]);
 }
 
 // Настраивает фильтры при логировании в консоль.
@@ -22,7 +34,34 @@ void InitLogFilter() {
                            keywords::auto_flush = true);
 }
 
+void InitAsyncLog(std::size_t queue_capacity, OverflowPolicy policy) {
+  StopAsyncLog();
+  async_writer =
+      std::make_unique<AsyncLogWriter>(std::cout, queue_capacity, policy);
+  active_async_writer.store(async_writer.get(), std::memory_order_release);
+}
+
+void StopAsyncLog() {
+  if (auto* writer = active_async_writer.exchange(nullptr)) {
+    writer->Stop();
+  }
+}
+
+LogStatistics GetLogStatistics() {
+  if (!async_writer) {
+    return {};
+  }
+  return {async_writer->GetWrittenCount(), async_writer->GetDroppedCount()};
+}
+
 void Log(const json::value& data, const std::string_view& message) {
+  if (auto* writer = active_async_writer.load(std::memory_order_acquire)) {
+    auto record = EncodeRecord(boost::posix_time::microsec_clock::local_time(),
+                               data, message);
+    record += '\n';
+    writer->Push(std::move(record));
+    return;
+  }
   BOOST_LOG_TRIVIAL(info) << logging::add_value("AdditionalData"s, data)
                           << message;
 }
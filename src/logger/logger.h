@@ -12,6 +12,9 @@
 #include <iostream>
 #include <string>
 
+#include "async_log_writer.h"
+#include "log_filter.h"
+
 namespace logger {
 
 namespace json = boost::json;
@@ -32,7 +35,24 @@ void Formatter(const logging::record_view& rec,
 
 void InitLogFilter();
 
-// Основная логирующая функция.
+// Переключает логирование в асинхронный режим: записи форматируются в
+// вызывающем потоке и выводятся отдельным потоком через очередь размером
+// queue_capacity записей.
+void InitAsyncLog(std::size_t queue_capacity, OverflowPolicy policy);
+
+// Выводит оставшиеся записи и возвращает логирование в синхронный режим.
+void StopAsyncLog();
+
+// Статистика асинхронного логирования.
+struct LogStatistics {
+  std::uint64_t written = 0;
+  std::uint64_t dropped = 0;
+};
+
+LogStatistics GetLogStatistics();
+
+// Основная логирующая функция. Перед формированием записи вызывающий код
+// проверяет ShouldLog, чтобы не строить JSON для отключенных сообщений.
 void Log(const json::value& data, const std::string_view& message);
 
 }  // namespace logger
\ No newline at end of file
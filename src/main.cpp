@@ -1,6 +1,8 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <charconv>
 #include <iostream>
+#include <limits>
 #include <thread>
 
 #include "../lib/json_loader/json_loader.h"
@@ -33,6 +35,24 @@ void RunWorkers(std::uint32_t num_of_workers, const Fn& fn) {
   fn();
 }
 
+// Разбирает значение option целочисленного параметра командной строки.
+// Бросает std::runtime_error, если значение не число, содержит лишние символы
+// (в том числе знак минус) или не входит в [min_value, max_value].
+std::uint64_t ParseUnsignedOption(
+    std::string_view option, const std::string& value,
+    std::uint64_t min_value = 0,
+    std::uint64_t max_value = std::numeric_limits<std::uint64_t>::max()) {
+  std::uint64_t result = 0;
+  const auto* end = value.data() + value.size();
+  auto [ptr, ec] = std::from_chars(value.data(), end, result);
+  if (ec != std::errc{} || ptr != end || result < min_value ||
+      result > max_value) {
+    throw std::runtime_error("Invalid value of "s + std::string(option) +
+                             ": "s + value);
+  }
+  return result;
+}
+
 constexpr const char DB_URL_ENV_NAME[]{"GAME_DB_URL"};
 
 // Считывает переменную окружения GAME_DB_URL и вовращает DatabaseConfig.
@@ -47,6 +67,19 @@ auto GetConfigForDatabase(std::uint32_t connection_count) {
                            " environment variable not found"s);
 }
 
+// Выводит оставшиеся записи асинхронного лога и логирует число выведенных
+// и отброшенных записей.
+void StopAsyncLog() {
+  logger::StopAsyncLog();
+  auto statistics = logger::GetLogStatistics();
+  if ((statistics.written != 0 || statistics.dropped != 0) &&
+      logger::ShouldLog(logger::LogEvent::kServer)) {
+    logger::Log(json::value{{"written"s, statistics.written},
+                            {"dropped"s, statistics.dropped}},
+                "log statistics"sv);
+  }
+}
+
 }  // namespace
 
 int main(int argc, const char* argv[]) {
@@ -58,15 +91,76 @@ int main(int argc, const char* argv[]) {
       // Инициализация фильтра для логера.
       logger::InitLogFilter();
 
-      // Указание порта и ip-адреса, через которые сервер будет слушать запросы.
-      const unsigned port = 8080;
-      const auto address = net::ip::make_address("0.0.0.0"sv);
+      // Установление параметров --log-level <level> и
+      // --log-sampling <event=rate,...>.
+      // --log-level задает минимальный уровень выводимых сообщений
+      // (debug, info, warning, error, off), по умолчанию info.
+      // --log-sampling задает долю выводимых сообщений каждого типа
+      // (request, response, error, server), например "request=0.01".
+      // Оба параметра можно изменить во время работы через
+      // /api/v1/admin/log.
+      if (!args.value().log_level.empty()) {
+        auto log_level = logger::ParseLogLevel(args.value().log_level);
+        if (!log_level) {
+          throw std::runtime_error("Invalid log level "s +
+                                   args.value().log_level);
+        }
+        logger::SetLogLevel(*log_level);
+      }
+      logger::SetSamplingRates(args.value().log_sampling);
+
+      // Установление параметров --log-queue-size <records> и
+      // --log-overflow-policy <drop|block>.
+      // Записи лога выводятся отдельным потоком через очередь заданного
+      // размера (по умолчанию 65536 записей). При переполнении очереди
+      // запись отбрасывается (drop, по умолчанию) или поток ждет
+      // освобождения места (block). Размер 0 включает синхронный вывод.
+      std::size_t log_queue_size =
+          (!args.value().log_queue_size.empty())
+              ? ParseUnsignedOption("--log-queue-size"sv,
+                                    args.value().log_queue_size)
+              : 65536;
+      if (log_queue_size != 0) {
+        logger::InitAsyncLog(log_queue_size,
+                             args.value().log_overflow_policy == "block"s
+                                 ? logger::OverflowPolicy::kBlock
+                                 : logger::OverflowPolicy::kDrop);
+      }
+
+      // Установление параметров --address <ip> и --port <port>.
+      // Задают ip-адрес и порт, через которые сервер будет слушать запросы.
+      // По умолчанию 0.0.0.0:8080.
+      const auto address = net::ip::make_address(
+          (!args.value().address.empty()) ? args.value().address
+                                          : "0.0.0.0"s);
+      const auto port = static_cast<std::uint16_t>(
+          (!args.value().port.empty())
+              ? ParseUnsignedOption("--port"sv, args.value().port, 1,
+                                    std::numeric_limits<std::uint16_t>::max())
+              : 8080);
 
       // Загрузка карты из файла и построение модель игры.
       model::Game game = json_loader::LoadGame(args.value().config_file);
 
-      // Инициализация io_context.
-      const unsigned num_threads = std::thread::hardware_concurrency();
+      // Установление параметра --game-shards <count>.
+      // --game-shards <count> включает режим нескольких реакторов: игровые
+      // сессии распределяются по count io_context, каждый из которых
+      // обслуживается одним потоком, закрепленным за своим ядром. HTTP-
+      // соединения остаются в общем io_context и передают операции с игрой
+      // шарду сессии. По умолчанию 0: все работает в общем io_context.
+      const std::size_t num_game_shards =
+          (!args.value().game_shards.empty())
+              ? ParseUnsignedOption("--game-shards"sv, args.value().game_shards)
+              : 0;
+      util::IoContextPool game_shards(num_game_shards);
+
+      // Инициализация io_context. Потоки шардов занимают свои ядра, поэтому
+      // общий io_context получает оставшиеся.
+      const unsigned num_of_cores = std::thread::hardware_concurrency();
+      const unsigned num_threads =
+          (num_game_shards < num_of_cores)
+              ? num_of_cores - static_cast<unsigned>(num_game_shards)
+              : 1u;
       net::io_context ioc(static_cast<int>(num_threads));
 
       // Добавление асинхронного обработчика сигналов SIGINT, SIGTERM и SIGHUP.
@@ -99,15 +193,21 @@ int main(int argc, const char* argv[]) {
 
       // Инициализация фасада из модуля app.
       auto application = std::make_shared<app::Application>(
-          ioc, game, save_file, is_save_file_set,
-          GetConfigForDatabase(num_threads));
+          ioc, &game_shards, game, save_file, is_save_file_set,
+          GetConfigForDatabase(
+              num_threads + static_cast<std::uint32_t>(num_game_shards)));
 
       // Установление настроек таймера. Если параметр tick_period задан, то
       // создается объект app::Ticker, который будет отвечать за обновление и
-      // сохранения состояния игровых сессий.
+      // сохранения состояния игровых сессий. Период тика и период сохранения
+      // должны быть положительными и не больше kMaxPeriod мс (около 24
+      // суток), чтобы арифметика временной шкалы тиков не переполнялась.
+      constexpr std::uint64_t kMaxPeriod =
+          std::numeric_limits<std::int32_t>::max();
       Milliseconds tick_period =
           (!args.value().tick_period.empty())
-              ? Milliseconds(std::stol(args.value().tick_period))
+              ? Milliseconds(ParseUnsignedOption(
+                    "--tick-period"sv, args.value().tick_period, 1, kMaxPeriod))
               : 30ms;
       bool is_ticker_set = !args.value().tick_period.empty();
       if (is_ticker_set) {
@@ -124,54 +224,220 @@ int main(int argc, const char* argv[]) {
         //     игнорируется.
         Milliseconds save_state_period =
             (!args.value().save_state_period.empty())
-                ? Milliseconds(std::stol(args.value().save_state_period))
+                ? Milliseconds(ParseUnsignedOption(
+                      "--save-state-period"sv, args.value().save_state_period,
+                      1, kMaxPeriod))
                 : 30ms;
         bool is_save_state_period_set =
-            is_save_file_set && !args.value().tick_period.empty();
+            is_save_file_set && !args.value().save_state_period.empty();
+
+        // Установление параметра --tick-mode <fixed-rate|fixed-delay>.
+        // В режиме fixed-rate (по умолчанию) тики идут по фиксированной
+        // временной шкале, в режиме fixed-delay следующий тик планируется
+        // через tick_period после окончания предыдущего.
+        auto tick_mode = args.value().tick_mode == "fixed-delay"s
+                             ? app::Ticker::SchedulingMode::kFixedDelay
+                             : app::Ticker::SchedulingMode::kFixedRate;
 
         auto ticker = std::make_shared<app::Ticker>(
             ioc, tick_period, is_save_state_period_set, save_state_period,
             [application = application->shared_from_this()](
-                Milliseconds time_delta) -> bool {
-              return application->UpdateAllGameSessions(time_delta);
+                Milliseconds time_delta, app::Ticker::DoneHandler done) {
+              application->AsyncUpdateAllGameSessions(
+                  time_delta, [done = std::move(done)](bool) { done(); });
+            },
+            [application = application->shared_from_this()](
+                app::Ticker::DoneHandler done) {
+              application->AsyncSaveGameState(
+                  [done = std::move(done)](bool) { done(); });
             },
-            [application = application->shared_from_this()]() -> bool {
-              return application->SaveGameState();
-            });
+            tick_mode);
         ticker->Start();
       }
 
+      // Установление параметра --static-cache-size <bytes>.
+      // --static-cache-size <bytes> задает объем памяти, который может занять
+      // кеш статических файлов. По умолчанию 64 МиБ.
+      std::size_t static_cache_size =
+          (!args.value().static_cache_size.empty())
+              ? ParseUnsignedOption("--static-cache-size"sv,
+                                    args.value().static_cache_size)
+              : 64 * 1024 * 1024;
+
+      // Установление параметра --view-radius <distance>.
+      // --view-radius <distance> ограничивает ответ /api/v1/game/state
+      // собаками и потерянными вещами на расстоянии не больше distance от
+      // собаки игрока. По умолчанию 0: игрок получает все объекты сессии.
+      const model::Dimension view_radius =
+          (!args.value().view_radius.empty())
+              ? std::stod(args.value().view_radius)
+              : 0.0;
+
+      // Установление параметра --compression-threshold <bytes>.
+      // --compression-threshold <bytes> задает минимальный размер ответа API,
+      // который сжимается по заголовку Accept-Encoding. По умолчанию 1 КиБ:
+      // ответы меньше помещаются в один TCP-сегмент и без сжатия.
+      const std::size_t compression_threshold =
+          (!args.value().compression_threshold.empty())
+              ? ParseUnsignedOption("--compression-threshold"sv,
+                                    args.value().compression_threshold)
+              : 1024;
+
       // Создание обработчика HTTP-запросов и связывание его с моделью игры.
-      http_handler::RequestHandler handler(application, args.value().www_root,
-                                           args.value().randomize_spawn_points,
-                                           is_ticker_set);
+      http_handler::RequestHandler handler(
+          ioc.get_executor(), application, args.value().www_root,
+          args.value().randomize_spawn_points, is_ticker_set,
+          static_cache_size, args.value().admin_token, view_radius,
+          compression_threshold);
+
+      // Установление параметров --max-connections <count>,
+      // --max-connections-per-ip <count>, --rate-limit <requests/s> и
+      // --rate-limit-burst <requests>.
+      // Соединения сверх --max-connections получают 503, сверх
+      // --max-connections-per-ip - 429. Запросы с одного IP-адреса сверх
+      // --rate-limit в секунду (с запасом --rate-limit-burst запросов)
+      // получают 429. По умолчанию ограничений нет.
+      http_server::AdmissionLimits admission_limits;
+      if (!args.value().max_connections.empty()) {
+        admission_limits.max_connections =
+            ParseUnsignedOption("--max-connections"sv,
+                                args.value().max_connections);
+      }
+      if (!args.value().max_connections_per_ip.empty()) {
+        admission_limits.max_connections_per_ip =
+            ParseUnsignedOption("--max-connections-per-ip"sv,
+                                args.value().max_connections_per_ip);
+      }
+      if (!args.value().rate_limit.empty()) {
+        admission_limits.requests_per_second =
+            std::stod(args.value().rate_limit);
+      }
+      if (!args.value().rate_limit_burst.empty()) {
+        admission_limits.burst = std::stod(args.value().rate_limit_burst);
+      }
+
+      // Установление параметров --acceptors <count>, --listen-backlog <count>,
+      // --tcp-nodelay, --socket-send-buffer <bytes> и
+      // --socket-receive-buffer <bytes>.
+      // --acceptors <count> открывает count слушающих сокетов с SO_REUSEPORT,
+      // между которыми ядро распределяет новые соединения. Имеет смысл
+      // задавать его равным числу рабочих потоков, если сервер принимает
+      // много соединений. По умолчанию 1.
+      // Остальные параметры задают соответствующие опции сокетов. По
+      // умолчанию используются значения системы, а алгоритм Нейгла включен.
+      // Значения вне допустимых диапазонов (от 1 до 1024 слушающих сокетов,
+      // положительные размеры) считаются ошибкой запуска.
+      constexpr std::uint64_t kMaxAcceptors = 1024;
+      constexpr std::uint64_t kMaxInt = std::numeric_limits<int>::max();
+      http_server::SocketOptions socket_options;
+      if (!args.value().acceptors.empty()) {
+        socket_options.num_of_acceptors =
+            ParseUnsignedOption("--acceptors"sv, args.value().acceptors, 1,
+                                kMaxAcceptors);
+      }
+      if (!args.value().listen_backlog.empty()) {
+        socket_options.backlog = static_cast<int>(ParseUnsignedOption(
+            "--listen-backlog"sv, args.value().listen_backlog, 1, kMaxInt));
+      }
+      socket_options.tcp_nodelay = args.value().tcp_nodelay;
+      if (!args.value().socket_send_buffer.empty()) {
+        socket_options.send_buffer_size = static_cast<int>(
+            ParseUnsignedOption("--socket-send-buffer"sv,
+                                args.value().socket_send_buffer, 1, kMaxInt));
+      }
+      if (!args.value().socket_receive_buffer.empty()) {
+        socket_options.receive_buffer_size = static_cast<int>(
+            ParseUnsignedOption("--socket-receive-buffer"sv,
+                                args.value().socket_receive_buffer, 1,
+                                kMaxInt));
+      }
+
+      // Установление параметров --idle-timeout, --header-timeout,
+      // --body-timeout, --response-timeout <milliseconds> и
+      // --max-requests-per-connection <count>.
+      // Соединение закрывается, если клиент дольше --idle-timeout не начинает
+      // следующий запрос, дольше --header-timeout передает заголовки или
+      // дольше --body-timeout тело запроса, а также если ответ формируется и
+      // отправляется дольше --response-timeout. После
+      // --max-requests-per-connection запросов соединение закрывается, и
+      // клиент переподключается. По умолчанию 30 с, 10 с, 30 с, 30 с и без
+      // ограничения числа запросов. Таймауты, как и периоды таймера, должны
+      // быть положительными и не больше kMaxPeriod мс.
+      http_server::SessionOptions session_options;
+      if (!args.value().idle_timeout.empty()) {
+        session_options.idle_timeout =
+            Milliseconds(ParseUnsignedOption("--idle-timeout"sv,
+                                             args.value().idle_timeout, 1,
+                                             kMaxPeriod));
+      }
+      if (!args.value().header_timeout.empty()) {
+        session_options.header_timeout =
+            Milliseconds(ParseUnsignedOption("--header-timeout"sv,
+                                             args.value().header_timeout, 1,
+                                             kMaxPeriod));
+      }
+      if (!args.value().body_timeout.empty()) {
+        session_options.body_timeout =
+            Milliseconds(ParseUnsignedOption("--body-timeout"sv,
+                                             args.value().body_timeout, 1,
+                                             kMaxPeriod));
+      }
+      if (!args.value().response_timeout.empty()) {
+        session_options.response_timeout =
+            Milliseconds(ParseUnsignedOption("--response-timeout"sv,
+                                             args.value().response_timeout, 1,
+                                             kMaxPeriod));
+      }
+      if (!args.value().max_requests_per_connection.empty()) {
+        session_options.max_requests_per_connection =
+            ParseUnsignedOption("--max-requests-per-connection"sv,
+                                args.value().max_requests_per_connection);
+      }
 
       // Запуск обработчика HTTP-запросов, делегируя их обработчику запросов.
-      http_server::ServeHttp(ioc, {address, port},
-                             [&handler](auto&& req, auto&& send) {
-                               handler(std::forward<decltype(req)>(req),
-                                       std::forward<decltype(send)>(send));
-                             });
+      // Обработчик передается по ссылке: через него сервер узнает и
+      // допустимый размер тела запроса.
+      http_server::ServeHttp(ioc, {address, port}, socket_options,
+                             session_options, admission_limits,
+                             std::ref(handler));
       // Логирование о том, что сервер запущен и готов обрабатывать
       // запросы.
-      logger::Log(
-          json::value{{"port"s, port}, {"address"s, address.to_string()}},
-          "server started"sv);
+      if (logger::ShouldLog(logger::LogEvent::kServer)) {
+        logger::Log(
+            json::value{{"port"s, port},
+                        {"address"s, address.to_string()},
+                        {"acceptors"s, socket_options.num_of_acceptors}},
+            "server started"sv);
+      }
 
       // Запуск обработки асинхронных операций.
+      if (auto num_of_unpinned = game_shards.Start(true);
+          num_of_unpinned > 0 &&
+          logger::ShouldLog(logger::LogEvent::kServer)) {
+        logger::Log(json::value{{"unpinned_shards"s, num_of_unpinned}},
+                    "failed to pin game shard threads"sv);
+      }
       RunWorkers(std::max(1u, num_threads), [&ioc] { ioc.run(); });
       // Логирование о том, что сервер успешно завершил свою работу.
-      logger::Log(json::value{{"code"s, EXIT_SUCCESS}}, "server exited"sv);
+      if (logger::ShouldLog(logger::LogEvent::kServer)) {
+        logger::Log(json::value{{"code"s, EXIT_SUCCESS}}, "server exited"sv);
+      }
 
       if (is_save_file_set) {
         application->SaveGameState();
       }
+      game_shards.Stop();
+      StopAsyncLog();
     }
     return EXIT_SUCCESS;
   } catch (const std::exception& ex) {
     // Логирование сообщения об ошибке и завершении работы сервера.
-    logger::Log(json::value{{"code"s, EXIT_FAILURE}, {"exception"s, ex.what()}},
-                "server exited"sv);
+    if (logger::ShouldLog(logger::LogEvent::kError)) {
+      logger::Log(
+          json::value{{"code"s, EXIT_FAILURE}, {"exception"s, ex.what()}},
+          "server exited"sv);
+    }
+    StopAsyncLog();
     return EXIT_FAILURE;
   }
 }
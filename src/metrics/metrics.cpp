@@ -0,0 +1,245 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace metrics {
+
+namespace {
+
+template <typename Number>
+void AppendNumber(std::string& out, Number value) {
+  if constexpr (std::is_floating_point_v<Number>) {
+    if (std::isinf(value)) {
+      out += value > 0 ? "+Inf"sv : "-Inf"sv;
+      return;
+    }
+  }
+  std::array<char, 32> buffer;
+  auto [end, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(),
+                                 value);
+  out.append(buffer.data(), end);
+}
+
+void AppendEscapedLabelValue(std::string& out, std::string_view value) {
+  for (char c : value) {
+    switch (c) {
+      case '\\':
+        out += "\\\\"sv;
+        break;
+      case '"':
+        out += "\\\""sv;
+        break;
+      case '\n':
+        out += "\\n"sv;
+        break;
+      default:
+        out += c;
+    }
+  }
+}
+
+// Добавляет метки в формате {name="value",...}. Если extra_name не пуст,
+// добавляет в конец метку extra_name="extra_value".
+void AppendLabels(std::string& out, const std::vector<std::string>& names,
+                  const std::vector<std::string>& values,
+                  std::string_view extra_name = {},
+                  std::string_view extra_value = {}) {
+  if (names.empty() && extra_name.empty()) {
+    return;
+  }
+  out += '{';
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    if (i != 0) {
+      out += ',';
+    }
+    out += names[i];
+    out += "=\""sv;
+    AppendEscapedLabelValue(out, values[i]);
+    out += '"';
+  }
+  if (!extra_name.empty()) {
+    if (!names.empty()) {
+      out += ',';
+    }
+    out += extra_name;
+    out += "=\""sv;
+    out += extra_value;
+    out += '"';
+  }
+  out += '}';
+}
+
+template <typename Number>
+void AppendSample(std::string& out, std::string_view name,
+                  const std::vector<std::string>& label_names,
+                  const std::vector<std::string>& label_values,
+                  Number value) {
+  out += name;
+  AppendLabels(out, label_names, label_values);
+  out += ' ';
+  AppendNumber(out, value);
+  out += '\n';
+}
+
+void AppendHistogram(std::string& out, const std::string& name,
+                     const std::vector<std::string>& label_names,
+                     const std::vector<std::string>& label_values,
+                     const Histogram& histogram) {
+  const auto& buckets = histogram.GetBuckets();
+  auto snapshot = histogram.Collect();
+  std::string bound;
+  for (std::size_t i = 0; i <= buckets.size(); ++i) {
+    bound.clear();
+    AppendNumber(bound, i < buckets.size() ? buckets[i] : INFINITY);
+    out += name;
+    out += "_bucket"sv;
+    AppendLabels(out, label_names, label_values, "le"sv, bound);
+    out += ' ';
+    AppendNumber(out, snapshot.cumulative_counts[i]);
+    out += '\n';
+  }
+  AppendSample(out, name + "_sum"s, label_names, label_values, snapshot.sum);
+  AppendSample(out, name + "_count"s, label_names, label_values,
+               snapshot.cumulative_counts.back());
+}
+
+}  // namespace
+
+std::size_t GetShardIndex() noexcept {
+  static std::atomic<std::size_t> next_index{0};
+  thread_local std::size_t index =
+      next_index.fetch_add(1, std::memory_order_relaxed) % kNumOfShards;
+  return index;
+}
+
+std::uint64_t Counter::GetValue() const noexcept {
+  std::uint64_t result = 0;
+  for (const auto& shard : shards_) {
+    result += shard.value.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+Histogram::Histogram(Buckets buckets) : buckets_(std::move(buckets)) {
+  for (auto& shard : shards_) {
+    shard.counts = std::vector<std::atomic<std::uint64_t>>(buckets_.size() + 1);
+  }
+}
+
+void Histogram::Observe(double value) noexcept {
+  auto bucket = std::lower_bound(buckets_.begin(), buckets_.end(), value) -
+                buckets_.begin();
+  auto& shard = shards_[GetShardIndex()];
+  shard.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+  shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+const Histogram::Buckets& Histogram::GetBuckets() const noexcept {
+  return buckets_;
+}
+
+Histogram::Snapshot Histogram::Collect() const {
+  Snapshot snapshot;
+  snapshot.cumulative_counts.resize(buckets_.size() + 1);
+  for (const auto& shard : shards_) {
+    for (std::size_t i = 0; i < shard.counts.size(); ++i) {
+      snapshot.cumulative_counts[i] +=
+          shard.counts[i].load(std::memory_order_relaxed);
+    }
+    snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+  }
+  for (std::size_t i = 1; i < snapshot.cumulative_counts.size(); ++i) {
+    snapshot.cumulative_counts[i] += snapshot.cumulative_counts[i - 1];
+  }
+  return snapshot;
+}
+
+Histogram::Buckets GetDefaultDurationBuckets() {
+  return {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+          0.025,  0.05,    0.1,    0.25,  0.5,    1,     2.5,
+          5,      10};
+}
+
+Counter& Registry::AddCounter(std::string name, std::string help) {
+  auto& counter = counters_.emplace_back();
+  entries_.push_back({std::move(name), std::move(help), "counter"sv,
+                      [&counter](const std::string& name, std::string& out) {
+                        AppendSample(out, name, {}, {}, counter.GetValue());
+                      }});
+  return counter;
+}
+
+Gauge& Registry::AddGauge(std::string name, std::string help) {
+  auto& gauge = gauges_.emplace_back();
+  entries_.push_back({std::move(name), std::move(help), "gauge"sv,
+                      [&gauge](const std::string& name, std::string& out) {
+                        AppendSample(out, name, {}, {}, gauge.GetValue());
+                      }});
+  return gauge;
+}
+
+Histogram& Registry::AddHistogram(std::string name, std::string help,
+                                  Histogram::Buckets buckets) {
+  auto& histogram = histograms_.emplace_back(std::move(buckets));
+  entries_.push_back({std::move(name), std::move(help), "histogram"sv,
+                      [&histogram](const std::string& name, std::string& out) {
+                        AppendHistogram(out, name, {}, {}, histogram);
+                      }});
+  return histogram;
+}
+
+Family<Counter>& Registry::AddCounterFamily(
+    std::string name, std::string help, std::vector<std::string> label_names) {
+  auto& family = counter_families_.emplace_back(
+      std::move(label_names), [] { return std::make_unique<Counter>(); });
+  entries_.push_back(
+      {std::move(name), std::move(help), "counter"sv,
+       [&family](const std::string& name, std::string& out) {
+         family.ForEach([&](const auto& label_values, const Counter& counter) {
+           AppendSample(out, name, family.GetLabelNames(), label_values,
+                        counter.GetValue());
+         });
+       }});
+  return family;
+}
+
+Family<Histogram>& Registry::AddHistogramFamily(
+    std::string name, std::string help, std::vector<std::string> label_names,
+    Histogram::Buckets buckets) {
+  auto& family = histogram_families_.emplace_back(
+      std::move(label_names),
+      [buckets = std::move(buckets)] {
+        return std::make_unique<Histogram>(buckets);
+      });
+  entries_.push_back(
+      {std::move(name), std::move(help), "histogram"sv,
+       [&family](const std::string& name, std::string& out) {
+         family.ForEach(
+             [&](const auto& label_values, const Histogram& histogram) {
+               AppendHistogram(out, name, family.GetLabelNames(),
+                               label_values, histogram);
+             });
+       }});
+  return family;
+}
+
+std::string Registry::Serialize() const {
+  std::string out;
+  for (const auto& entry : entries_) {
+    out += "# HELP "sv;
+    out += entry.name;
+    out += ' ';
+    out += entry.help;
+    out += "\n# TYPE "sv;
+    out += entry.name;
+    out += ' ';
+    out += entry.type;
+    out += '\n';
+    entry.serialize(entry.name, out);
+  }
+  return out;
+}
+
+}  // namespace metrics
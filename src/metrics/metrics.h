@@ -0,0 +1,214 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace metrics {
+
+using namespace std::literals;
+
+// Число шардов, между которыми распределяются потоки. Каждый поток пишет в
+// свой шард, поэтому потоки не конкурируют за одну кеш-линию.
+inline constexpr std::size_t kNumOfShards = 16;
+
+// Возвращает номер шарда текущего потока.
+std::size_t GetShardIndex() noexcept;
+
+// Монотонно растущий счетчик.
+class Counter {
+ public:
+  Counter() = default;
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+
+  void Inc(std::uint64_t value = 1) noexcept {
+    shards_[GetShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  std::uint64_t GetValue() const noexcept;
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<std::uint64_t> value{0};
+  };
+
+  std::array<Shard, kNumOfShards> shards_;
+};
+
+// Значение, которое может как расти, так и уменьшаться.
+class Gauge {
+ public:
+  Gauge() = default;
+  Gauge(const Gauge&) = delete;
+  Gauge& operator=(const Gauge&) = delete;
+
+  void Set(double value) noexcept {
+    value_.store(value, std::memory_order_relaxed);
+  }
+  void Add(double value) noexcept {
+    value_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  double GetValue() const noexcept {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<double> value_{0};
+};
+
+// Гистограмма с фиксированными границами корзин.
+class Histogram {
+ public:
+  // Верхние границы корзин по возрастанию. Корзина +Inf добавляется сама.
+  using Buckets = std::vector<double>;
+
+  // Данные гистограммы на момент вызова Collect.
+  struct Snapshot {
+    // Накопленное число наблюдений для каждой границы и для +Inf.
+    std::vector<std::uint64_t> cumulative_counts;
+    double sum = 0;
+  };
+
+  explicit Histogram(Buckets buckets);
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  void Observe(double value) noexcept;
+
+  // Добавляет наблюдение длительности в секундах.
+  template <typename Rep, typename Period>
+  void ObserveDuration(std::chrono::duration<Rep, Period> duration) noexcept {
+    Observe(std::chrono::duration<double>(duration).count());
+  }
+
+  const Buckets& GetBuckets() const noexcept;
+  Snapshot Collect() const;
+
+ private:
+  struct alignas(64) Shard {
+    std::vector<std::atomic<std::uint64_t>> counts;
+    std::atomic<double> sum{0};
+  };
+
+  Buckets buckets_;
+  std::array<Shard, kNumOfShards> shards_;
+};
+
+// Границы корзин для длительностей в секундах: от 100 мкс до 10 с.
+Histogram::Buckets GetDefaultDurationBuckets();
+
+// Набор метрик одного вида, различающихся значениями меток.
+template <typename Metric>
+class Family {
+ public:
+  using Factory = std::function<std::unique_ptr<Metric>()>;
+  using LabelValues = std::vector<std::string>;
+
+  Family(std::vector<std::string> label_names, Factory factory)
+      : label_names_(std::move(label_names)), factory_(std::move(factory)) {}
+  Family(const Family&) = delete;
+  Family& operator=(const Family&) = delete;
+
+  // Возвращает метрику с заданными значениями меток, создавая ее при первом
+  // обращении. Для уже созданных метрик берется только разделяемая
+  // блокировка, а ключ собирается в буфере потока без выделения памяти.
+  Metric& WithLabels(std::initializer_list<std::string_view> values) {
+    thread_local std::string key;
+    key.clear();
+    for (auto value : values) {
+      key += value;
+      key += '\0';
+    }
+    {
+      std::shared_lock lock(mutex_);
+      if (auto it = metrics_.find(key); it != metrics_.end()) {
+        return *it->second.metric;
+      }
+    }
+    std::unique_lock lock(mutex_);
+    auto [it, inserted] = metrics_.try_emplace(key);
+    if (inserted) {
+      it->second.label_values.assign(values.begin(), values.end());
+      it->second.metric = factory_();
+    }
+    return *it->second.metric;
+  }
+
+  const std::vector<std::string>& GetLabelNames() const noexcept {
+    return label_names_;
+  }
+
+  // Вызывает fn(label_values, metric) для каждой созданной метрики.
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    std::shared_lock lock(mutex_);
+    for (const auto& [key, entry] : metrics_) {
+      fn(entry.label_values, *entry.metric);
+    }
+  }
+
+ private:
+  struct Entry {
+    LabelValues label_values;
+    std::unique_ptr<Metric> metric;
+  };
+
+  std::vector<std::string> label_names_;
+  Factory factory_;
+  mutable std::shared_mutex mutex_;
+  std::map<std::string, Entry, std::less<>> metrics_;
+};
+
+// Хранит метрики и сериализует их в текстовый формат Prometheus.
+// Метрики регистрируются при запуске сервера, до начала работы потоков.
+// Ссылки на зарегистрированные метрики остаются валидными все время жизни
+// реестра.
+class Registry {
+ public:
+  Registry() = default;
+  Registry(const Registry&) = delete;
+  Registry& operator=(const Registry&) = delete;
+
+  Counter& AddCounter(std::string name, std::string help);
+  Gauge& AddGauge(std::string name, std::string help);
+  Histogram& AddHistogram(std::string name, std::string help,
+                          Histogram::Buckets buckets);
+  Family<Counter>& AddCounterFamily(std::string name, std::string help,
+                                    std::vector<std::string> label_names);
+  Family<Histogram>& AddHistogramFamily(std::string name, std::string help,
+                                        std::vector<std::string> label_names,
+                                        Histogram::Buckets buckets);
+
+  // Возвращает значения всех метрик в текстовом формате Prometheus.
+  std::string Serialize() const;
+
+ private:
+  struct Entry {
+    std::string name;
+    std::string help;
+    std::string_view type;
+    std::function<void(const std::string& name, std::string& out)> serialize;
+  };
+
+  std::deque<Counter> counters_;
+  std::deque<Gauge> gauges_;
+  std::deque<Histogram> histograms_;
+  std::deque<Family<Counter>> counter_families_;
+  std::deque<Family<Histogram>> histogram_families_;
+  std::vector<Entry> entries_;
+};
+
+}  // namespace metrics
@@ -0,0 +1,70 @@
+#include "server_metrics.h"
+
+namespace metrics {
+
+ServerMetrics::ServerMetrics()
+    : http_request_duration(registry.AddHistogramFamily(
+          "game_server_http_request_duration_seconds"s,
+          "HTTP request processing time"s, {"endpoint"s, "code"s},
+          GetDefaultDurationBuckets())),
+      network_errors(registry.AddCounterFamily(
+          "game_server_network_errors_total"s, "Network errors"s,
+          {"where"s})),
+      http_connections(registry.AddGauge("game_server_http_connections"s,
+                                         "Number of open HTTP connections"s)),
+      admission_rejections(registry.AddCounterFamily(
+          "game_server_admission_rejections_total"s,
+          "Connections and requests rejected by limits"s, {"reason"s})),
+      http_connection_closes(registry.AddCounterFamily(
+          "game_server_http_connection_closes_total"s,
+          "Connections closed by timeouts and request limits"s,
+          {"reason"s})),
+      compression_duration(registry.AddHistogramFamily(
+          "game_server_compression_duration_seconds"s,
+          "Time of compressing response bodies"s, {"encoding"s},
+          GetDefaultDurationBuckets())),
+      compression_input_bytes(registry.AddCounterFamily(
+          "game_server_compression_input_bytes_total"s,
+          "Size of response bodies before compression"s, {"encoding"s})),
+      compression_output_bytes(registry.AddCounterFamily(
+          "game_server_compression_output_bytes_total"s,
+          "Size of response bodies after compression"s, {"encoding"s})),
+      tick_duration(registry.AddHistogram(
+          "game_server_tick_duration_seconds"s,
+          "Time of updating all game sessions"s, GetDefaultDurationBuckets())),
+      tick_lag(registry.AddHistogram(
+          "game_server_tick_lag_seconds"s,
+          "Delay of tick start relative to its scheduled time"s,
+          GetDefaultDurationBuckets())),
+      tick_dropped_time(registry.AddHistogram(
+          "game_server_tick_dropped_time_seconds"s,
+          "Game time dropped by the tick catch-up cap"s,
+          GetDefaultDurationBuckets())),
+      tick_overruns(registry.AddCounter(
+          "game_server_tick_overruns_total"s,
+          "Ticks that took longer than the tick period"s)),
+      tick_skipped(registry.AddCounter(
+          "game_server_ticks_skipped_total"s,
+          "Scheduled ticks skipped after overruns"s)),
+      save_state_duration(registry.AddHistogram(
+          "game_server_save_state_duration_seconds"s,
+          "Time of saving the game state"s, GetDefaultDurationBuckets())),
+      db_pool_wait(registry.AddHistogram(
+          "game_server_db_pool_wait_seconds"s,
+          "Time of waiting for a database connection"s,
+          GetDefaultDurationBuckets())),
+      game_sessions(registry.AddGauge("game_server_game_sessions"s,
+                                      "Number of game sessions"s)),
+      sleeping_game_sessions(
+          registry.AddGauge("game_server_sleeping_game_sessions"s,
+                            "Number of game sessions skipped by ticks"s)),
+      dogs(registry.AddGauge("game_server_dogs"s, "Number of dogs"s)),
+      loot_objects(registry.AddGauge("game_server_loot_objects"s,
+                                     "Number of lost objects on maps"s)) {}
+
+ServerMetrics& GetServerMetrics() {
+  static ServerMetrics server_metrics;
+  return server_metrics;
+}
+
+}  // namespace metrics
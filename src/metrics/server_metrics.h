@@ -0,0 +1,52 @@
+#pragma once
+
+#include "metrics.h"
+
+namespace metrics {
+
+// Метрики игрового сервера, которые отдаются на /metrics.
+struct ServerMetrics {
+  ServerMetrics();
+  ServerMetrics(const ServerMetrics&) = delete;
+  ServerMetrics& operator=(const ServerMetrics&) = delete;
+
+  Registry registry;
+
+  // Время обработки HTTP-запроса с метками endpoint и code.
+  Family<Histogram>& http_request_duration;
+  // Число сетевых ошибок с меткой where.
+  Family<Counter>& network_errors;
+  // Число открытых HTTP-соединений и число отклоненных соединений и запросов
+  // с меткой reason.
+  Gauge& http_connections;
+  Family<Counter>& admission_rejections;
+  // Число соединений, закрытых по истечении срока этапа или после
+  // максимального числа запросов, с меткой reason.
+  Family<Counter>& http_connection_closes;
+  // Время сжатия тела ответа и объем данных до и после сжатия с меткой
+  // encoding. Степень сжатия - отношение output_bytes к input_bytes.
+  Family<Histogram>& compression_duration;
+  Family<Counter>& compression_input_bytes;
+  Family<Counter>& compression_output_bytes;
+  Histogram& tick_duration;
+  // Задержка начала тика относительно запланированного момента.
+  Histogram& tick_lag;
+  // Игровое время, отброшенное из-за ограничения Δt после перегрузки.
+  Histogram& tick_dropped_time;
+  // Число тиков, не уложившихся в период, и число пропущенных из-за них
+  // моментов временной шкалы.
+  Counter& tick_overruns;
+  Counter& tick_skipped;
+  Histogram& save_state_duration;
+  Histogram& db_pool_wait;
+  Gauge& game_sessions;
+  // Игровые сессии, которые не обновляются до ближайшего события в них.
+  Gauge& sleeping_game_sessions;
+  Gauge& dogs;
+  Gauge& loot_objects;
+};
+
+// Возвращает метрики сервера. Они создаются при первом обращении.
+ServerMetrics& GetServerMetrics();
+
+}  // namespace metrics
@@ -13,6 +13,117 @@ let pos_arr = [];
 
 const objLoader = new THREE.OBJLoader();
 
+// Binary state format (see ApiSerializer::SerializeStateBinary on the server).
+const binaryMediaType = 'application/vnd.dog-story.binary';
+const binaryFormatVersion = 1;
+const binaryFixedPointScale = 100;
+const textDecoder = new TextDecoder();
+
+class BinaryReader {
+  constructor(buffer) {
+    this.bytes = new Uint8Array(buffer);
+    this.offset = 0;
+  }
+
+  byte() {
+    return this.bytes[this.offset++];
+  }
+
+  // varint; multiplication instead of shifts keeps values above 2^31 exact.
+  uint() {
+    let value = 0;
+    let factor = 1;
+    for (;;) {
+      const b = this.byte();
+      value += (b & 0x7f) * factor;
+      if (b < 0x80) {
+        return value;
+      }
+      factor *= 128;
+    }
+  }
+
+  // zigzag varint
+  int() {
+    const value = this.uint();
+    return value % 2 ? -(value + 1) / 2 : value / 2;
+  }
+
+  fixed() {
+    return this.int() / binaryFixedPointScale;
+  }
+
+  string() {
+    const length = this.uint();
+    const value = textDecoder.decode(this.bytes.subarray(this.offset, this.offset + length));
+    this.offset += length;
+    return value;
+  }
+
+  checkVersion() {
+    const version = this.byte();
+    if (version != binaryFormatVersion) {
+      throw new Error('Unsupported binary format version: ' + version);
+    }
+  }
+}
+
+// Decodes /api/v1/game/players into the same object as the JSON response.
+function decodeBinaryPlayers(buffer) {
+  const reader = new BinaryReader(buffer);
+  reader.checkVersion();
+  const players = {};
+  for (let count = reader.uint(); count > 0; --count) {
+    const id = reader.uint();
+    players[id] = {name: reader.string()};
+  }
+  return players;
+}
+
+// Decodes /api/v1/game/state into the same object as the JSON response.
+function decodeBinaryState(buffer) {
+  const reader = new BinaryReader(buffer);
+  reader.checkVersion();
+  const players = {};
+  for (let count = reader.uint(); count > 0; --count) {
+    const id = reader.uint();
+    const pos = [reader.fixed(), reader.fixed()];
+    const speed = [reader.fixed(), reader.fixed()];
+    const dir = String.fromCharCode(reader.byte());
+    const bag = [];
+    for (let bagSize = reader.uint(); bagSize > 0; --bagSize) {
+      bag.push({id: reader.uint(), type: reader.uint()});
+    }
+    players[id] = {pos: pos, speed: speed, dir: dir, bag: bag, score: reader.uint()};
+  }
+  const lostObjects = {};
+  for (let count = reader.uint(); count > 0; --count) {
+    const id = reader.uint();
+    const type = reader.uint();
+    lostObjects[id] = {type: type, pos: [reader.fixed(), reader.fixed()]};
+  }
+  return {players: players, lostObjects: lostObjects};
+}
+
+// GET request to a game endpoint that prefers the binary format. Falls back to
+// JSON if the server answers with it.
+function getGameData(url, decodeBinary) {
+  return fetch(url, {
+    headers: {
+      'Authorization': 'Bearer ' + Cookies.get('authToken'),
+      'Accept': binaryMediaType + ', application/json;q=0.9'
+    }
+  }).then(function(response) {
+    if (!response.ok) {
+      throw response;
+    }
+    if (response.headers.get('Content-Type') == binaryMediaType) {
+      return response.arrayBuffer().then(decodeBinary);
+    }
+    return response.json();
+  });
+}
+
 function goToRecords() {
   window.location.replace('/hall_of_fame.html');
 }
@@ -265,17 +376,11 @@ class GameState {
   _syncPlayers(then) {
     this.playersSuncInProgress = true;
     let self = this;
-    $.get({
-      url: '/api/v1/game/players',
-      dataType: 'json',
-      beforeSend: function (xhr) {
-        xhr.setRequestHeader ("Authorization", "Bearer " + Cookies.get('authToken'));
-      }
-    }).done(function(x){
+    getGameData('/api/v1/game/players', decodeBinaryPlayers).then(function(x){
       self._updatePlayersList(x);
       then();
-    }).fail(function(xhr, status, err) {
-      if (err!='Unauthorized') return;
+    }).catch(function(response) {
+      if (response.status != 401) return;
       goToRecords();
     })
 
@@ -332,6 +437,21 @@ class GameState {
     self._delPlayerElem(id);
   }
 
+  // Hides a player that left the view radius together with the loot it
+  // carries. The bag is recreated when the player comes back into view.
+  _hidePlayer(id, oldPlayer) {
+    if (this.players[id] === undefined) {
+      return;
+    }
+    this.players[id].object.object.visible = false;
+    if (oldPlayer.data !== undefined) {
+      for (const key in oldPlayer.data.bag) {
+        this.scene.remove(oldPlayer.data.bag[key].object);
+      }
+    }
+    this.players[id].data = undefined;
+  }
+
   _movePlayerTo(id, playerPos) {
     let self = this;
     moveActor(self.players[id].object, playerPos['pos'][0], playerPos['pos'][1], playerPos['converted_dir']);
@@ -411,17 +531,11 @@ class GameState {
 
   _updateState(then) {
     let self = this;
-    $.get({
-      url: '/api/v1/game/state',
-      dataType: 'json',
-      beforeSend: function(xhr) {
-        xhr.setRequestHeader("Authorization", "Bearer " + Cookies.get('authToken'));
-      }
-    }).done(function(x){
+    getGameData('/api/v1/game/state', decodeBinaryState).then(function(x){
       self.desiredState = x;
       self.stateTime = performance.now();
       then();
-    })
+    }).catch(function() {})
   }
 
   _interpolateRotation(old_pos, new_pos) {
@@ -541,6 +655,13 @@ class GameState {
       }
     });
 
+    // With --view-radius the server omits far players from the state.
+    for (const id in old_players) {
+      if (new_players[id] === undefined) {
+        self._hidePlayer(id, old_players[id]);
+      }
+    }
+
     this.currentState['update_time'] = new_update_time;
     this.currentState['players'] = new_players;
     this.currentState['lostObjects'] = this.desiredState['lostObjects'];
@@ -0,0 +1,103 @@
+#include <boost/json.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <regex>
+#include <string>
+
+#include "../src/http_handler/action_parser.h"
+
+using namespace std::literals;
+
+SCENARIO("Player action parsing") {
+  using http_handler::ParseAction;
+  using http_handler::ParseActionFast;
+  using model::Direction;
+
+  GIVEN("canonical bodies") {
+    THEN("they are parsed without the JSON parser") {
+      REQUIRE(ParseActionFast(R"({"move":"L"})"sv)->direction ==
+              Direction::kWest);
+      REQUIRE(ParseActionFast(R"({ "move" : "U" }
+)"sv)->direction == Direction::kNorth);
+      auto stop = ParseActionFast(R"({"move":""})"sv);
+      REQUIRE(stop);
+      REQUIRE_FALSE(stop->direction);
+    }
+  }
+
+  GIVEN("non-canonical bodies") {
+    const auto with_other_field = R"({"tag":1,"move":"R"})"sv;
+    const auto field_after_move = R"({"move":"D","tag":1})"sv;
+
+    THEN("the fast parser rejects them and the JSON parser accepts them") {
+      REQUIRE_FALSE(ParseActionFast(with_other_field));
+      REQUIRE_FALSE(ParseActionFast(field_after_move));
+      REQUIRE(ParseAction(with_other_field)->direction == Direction::kEast);
+      REQUIRE(ParseAction(field_after_move)->direction == Direction::kSouth);
+    }
+  }
+
+  GIVEN("invalid bodies") {
+    THEN("they are rejected") {
+      REQUIRE_FALSE(ParseAction(R"({"move":"X"})"sv));
+      REQUIRE_FALSE(ParseAction(R"({"move":"LR"})"sv));
+      REQUIRE_FALSE(ParseAction(R"({"move":1})"sv));
+      REQUIRE_FALSE(ParseAction(R"({"move":"L"}})"sv));
+      REQUIRE_FALSE(ParseAction(R"({"go":"L"})"sv));
+      REQUIRE_FALSE(ParseAction(R"(["L"])"sv));
+      REQUIRE_FALSE(ParseAction(""sv));
+    }
+  }
+}
+
+SCENARIO("Batch action parsing") {
+  using http_handler::ParseBatchActions;
+  using model::Direction;
+
+  GIVEN("a batch with several moves of one player") {
+    auto batch = ParseBatchActions(
+        R"([{"token":"a","move":"L"},{"token":"b","move":""},)"
+        R"({"token":"a","move":"U"}])"sv);
+
+    THEN("every move is parsed in the request order") {
+      REQUIRE(batch);
+      REQUIRE(batch->size() == 3);
+      CHECK((*batch)[0].token == "a"s);
+      CHECK((*batch)[0].action.direction == Direction::kWest);
+      CHECK((*batch)[1].token == "b"s);
+      CHECK_FALSE((*batch)[1].action.direction);
+      CHECK((*batch)[2].action.direction == Direction::kNorth);
+    }
+  }
+
+  GIVEN("invalid batches") {
+    THEN("the whole batch is rejected") {
+      REQUIRE_FALSE(ParseBatchActions("[]"sv));
+      REQUIRE_FALSE(ParseBatchActions(R"({"token":"a","move":"L"})"sv));
+      REQUIRE_FALSE(ParseBatchActions(
+          R"([{"token":"a","move":"L"},{"token":"b","move":"X"}])"sv));
+      REQUIRE_FALSE(ParseBatchActions(R"([{"move":"L"}])"sv));
+      REQUIRE_FALSE(
+          ParseBatchActions(R"([{"token":"a","move":"L","time":10}])"sv));
+    }
+  }
+}
+
+// Сравнивает разбор тела запроса действия конечным автоматом и прежний
+// разбор через json::parse и std::regex.
+// Запуск: game_server_tests "[benchmark]"
+TEST_CASE("Action request parsing", "[.][benchmark]") {
+  namespace json = boost::json;
+  using http_handler::ParseAction;
+
+  const auto body = R"({"move":"L"})"sv;
+
+  BENCHMARK("json::parse and std::regex") {
+    auto content = json::parse(body);
+    auto movement = content.as_object().at("move"sv).as_string();
+    return std::regex_match(std::string(movement.data(), movement.size()),
+                            std::regex("[LRUD]"s));
+  };
+
+  BENCHMARK("ParseAction") { return ParseAction(body).has_value(); };
+}
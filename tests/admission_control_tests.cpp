@@ -0,0 +1,79 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/http_server/admission_control.h"
+
+using namespace std::literals;
+
+SCENARIO("Admission control") {
+  using http_server::Admission;
+  using http_server::AdmissionControl;
+  using http_server::AdmissionLimits;
+
+  const auto client = http_server::net::ip::make_address("10.0.0.1"sv);
+  const auto other_client = http_server::net::ip::make_address("10.0.0.2"sv);
+
+  GIVEN("connection limits") {
+    AdmissionControl admission_control(AdmissionLimits{
+        .max_connections = 3, .max_connections_per_ip = 2});
+
+    THEN("connections from one IP are limited") {
+      REQUIRE(admission_control.TryAcquireConnection(client) ==
+              Admission::kAccepted);
+      REQUIRE(admission_control.TryAcquireConnection(client) ==
+              Admission::kAccepted);
+      REQUIRE(admission_control.TryAcquireConnection(client) ==
+              Admission::kTooManyConnections);
+
+      AND_THEN("the total number of connections is limited") {
+        REQUIRE(admission_control.TryAcquireConnection(other_client) ==
+                Admission::kAccepted);
+        REQUIRE(admission_control.TryAcquireConnection(other_client) ==
+                Admission::kServerBusy);
+      }
+
+      AND_THEN("a released connection frees its place") {
+        admission_control.ReleaseConnection(client);
+        REQUIRE(admission_control.TryAcquireConnection(client) ==
+                Admission::kAccepted);
+      }
+    }
+  }
+
+  GIVEN("only a total connection limit") {
+    AdmissionControl admission_control(AdmissionLimits{.max_connections = 2});
+
+    THEN("connections are counted without per-client limits") {
+      REQUIRE(admission_control.TryAcquireConnection(client) ==
+              Admission::kAccepted);
+      REQUIRE(admission_control.TryAcquireConnection(client) ==
+              Admission::kAccepted);
+      REQUIRE(admission_control.TryAcquireConnection(other_client) ==
+              Admission::kServerBusy);
+      admission_control.ReleaseConnection(client);
+      REQUIRE(admission_control.TryAcquireConnection(other_client) ==
+              Admission::kAccepted);
+      REQUIRE(admission_control.TryAcquireRequest(client));
+    }
+  }
+
+  GIVEN("a request rate limit") {
+    AdmissionControl admission_control(
+        AdmissionLimits{.requests_per_second = 10.0, .burst = 2.0});
+    const auto start = AdmissionControl::Clock::now();
+
+    THEN("a burst is allowed and then requests are limited") {
+      REQUIRE(admission_control.TryAcquireRequest(client, start));
+      REQUIRE(admission_control.TryAcquireRequest(client, start));
+      REQUIRE_FALSE(admission_control.TryAcquireRequest(client, start));
+      REQUIRE(admission_control.TryAcquireRequest(other_client, start));
+
+      AND_THEN("tokens are refilled over time") {
+        REQUIRE_FALSE(
+            admission_control.TryAcquireRequest(client, start + 50ms));
+        REQUIRE(admission_control.TryAcquireRequest(client, start + 150ms));
+        REQUIRE_FALSE(
+            admission_control.TryAcquireRequest(client, start + 150ms));
+      }
+    }
+  }
+}
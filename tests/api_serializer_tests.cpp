@@ -0,0 +1,343 @@
+#include <boost/json.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/http_handler/api_serializer.h"
+#include "../src/http_handler/binary_writer.h"
+#include "../src/http_handler/json_writer.h"
+#include "../src/http_handler/response_generators.h"
+
+using namespace std::literals;
+
+namespace {
+
+namespace json = boost::json;
+using http_handler::ApiSerializer;
+using http_handler::BinaryWriter;
+using http_handler::ContentType;
+using Catch::Matchers::WithinAbs;
+
+// Погрешность чисел с фиксированной точкой.
+constexpr double kFixedPointError = 0.5 / BinaryWriter::kFixedPointScale;
+using http_handler::JsonWriter;
+
+// Игровая сессия с игроками для сериализации состояния.
+struct GameState {
+  model::Road road{model::Road::HORIZONTAL, {0, 0}, 1000};
+  model::GameSession session{model::GameSession::Id{0}, "session"s,
+                             model::Map::Id{"map"s}};
+  std::vector<std::unique_ptr<app::Player>> players;
+  app::PlayersTable::Players player_pointers;
+
+  GameState(std::uint32_t num_of_dogs, std::uint32_t num_of_loot) {
+    for (std::uint32_t i = 0; i < num_of_dogs; ++i) {
+      model::Point pos{i * 0.37, i % 3 * 0.4 - 0.4};
+      auto dog = session.AddDog("dog\t\""s + std::to_string(i), {pos, &road},
+                                3);
+      dog->SetSpeed({i % 2 * 1.5, -0.25});
+      dog->SetDirection(i % 2 ? model::Direction::kEast
+                              : model::Direction::kNorth);
+      dog->PutInBag(model::LostObject(model::LostObject::Id{i}, i % 4,
+                                      {0, 0}, 10));
+      dog->AddScore(i * 10);
+      players.push_back(std::make_unique<app::Player>(
+          app::Player::Id{i}, app::Token{"token"s},
+          model::GameSession::Id{0}, dog->GetId()));
+      player_pointers.push_back(players.back().get());
+    }
+    for (std::uint32_t i = 0; i < num_of_loot; ++i) {
+      session.LoadLostObject(model::LostObject(
+          model::LostObject::Id{i}, i % 5, {i * 1.25, 1e-7 * i}, 5));
+    }
+  }
+};
+
+// Строит состояние игры через дерево json::value, как делал ApiSerializer
+// до перехода на JsonWriter.
+std::string SerializeStateWithDom(const GameState& state) {
+  json::object players_info;
+  for (const auto& player : state.player_pointers) {
+    const auto dog = state.session.GetDogById(player->GetDogId());
+    json::array bag;
+    for (const auto& lost_object : dog->GetBag()) {
+      bag.push_back(json::object{{"id"s, *lost_object.GetId()},
+                                 {"type"s, lost_object.GetType()}});
+    }
+    json::object dog_info;
+    dog_info["pos"s] = json::array{dog->GetCurrentPosition().x,
+                                   dog->GetCurrentPosition().y};
+    dog_info["speed"s] = json::array{dog->GetSpeed().sx, dog->GetSpeed().sy};
+    dog_info["dir"s] = std::string{static_cast<char>(dog->GetDirection())};
+    dog_info["bag"s] = std::move(bag);
+    dog_info["score"s] = dog->GetScore();
+    players_info[std::to_string(*player->GetId())] = std::move(dog_info);
+  }
+  json::object loot_info;
+  for (const auto& lost_object : state.session.GetLoot()) {
+    json::object lost_object_info;
+    lost_object_info["type"s] = lost_object.GetType();
+    lost_object_info["pos"s] = json::array{lost_object.GetPosition().x,
+                                           lost_object.GetPosition().y};
+    loot_info[std::to_string(*lost_object.GetId())] =
+        std::move(lost_object_info);
+  }
+  return json::serialize(json::object{{"players"s, std::move(players_info)},
+                                      {"lostObjects"s, std::move(loot_info)}});
+}
+
+// Читает данные, записанные BinaryWriter.
+class BinaryReader {
+ public:
+  explicit BinaryReader(std::string_view data) : data_(data) {}
+
+  std::uint8_t Byte() {
+    auto value = static_cast<std::uint8_t>(data_.front());
+    data_.remove_prefix(1);
+    return value;
+  }
+
+  std::uint64_t Uint() {
+    std::uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+      auto byte = Byte();
+      value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+      if (byte < 0x80) {
+        return value;
+      }
+    }
+  }
+
+  std::int64_t Int() {
+    auto value = Uint();
+    return static_cast<std::int64_t>(value >> 1) ^
+           -static_cast<std::int64_t>(value & 1);
+  }
+
+  double Fixed() { return Int() / BinaryWriter::kFixedPointScale; }
+
+  bool IsEmpty() const { return data_.empty(); }
+
+ private:
+  std::string_view data_;
+};
+
+}  // namespace
+
+SCENARIO("JsonWriter output matches json::serialize") {
+  std::string out;
+  JsonWriter writer(out);
+
+  WHEN("numbers are written") {
+    const std::vector<double> doubles{0.0,
+                                      -0.0,
+                                      1.5,
+                                      -2.25,
+                                      0.1,
+                                      1e-7,
+                                      123456789.125,
+                                      1e300,
+                                      std::numeric_limits<double>::min()};
+    writer.BeginArray();
+    json::array expected;
+    for (auto value : doubles) {
+      writer.Double(value);
+      expected.push_back(value);
+    }
+    writer.Int(-42);
+    writer.Uint(std::numeric_limits<std::uint64_t>::max());
+    writer.Bool(false);
+    writer.EndArray();
+    expected.push_back(-42);
+    expected.push_back(std::numeric_limits<std::uint64_t>::max());
+    expected.push_back(false);
+    THEN("they are formatted as by Boost.JSON") {
+      REQUIRE(out == json::serialize(expected));
+    }
+  }
+
+  WHEN("strings and keys need escaping") {
+    const auto text = "quote\" slash\\ tab\t\n\r\b\f \x01\x1f ok/\xd0\xbf"s;
+    writer.BeginObject();
+    writer.Key(text);
+    writer.String(text);
+    writer.Key(std::uint64_t{17});
+    writer.BeginObject();
+    writer.EndObject();
+    writer.Key("empty"sv);
+    writer.BeginArray();
+    writer.EndArray();
+    writer.EndObject();
+    json::object expected;
+    expected[text] = text;
+    expected["17"s] = json::object{};
+    expected["empty"s] = json::array{};
+    THEN("they are escaped as by Boost.JSON") {
+      REQUIRE(out == json::serialize(expected));
+    }
+  }
+}
+
+TEST_CASE("Game state is serialized byte-identically to the json::value tree") {
+  GameState state(20, 20);
+  CHECK(ApiSerializer::SerializeState(&state.session, state.player_pointers) ==
+        SerializeStateWithDom(state));
+}
+
+TEST_CASE("Game state binary format") {
+  GameState state(3, 2);
+  auto data = ApiSerializer::SerializeStateBinary(&state.session,
+                                                  state.player_pointers);
+  BinaryReader reader(data);
+  REQUIRE(reader.Byte() == ApiSerializer::kBinaryFormatVersion);
+  REQUIRE(reader.Uint() == 3);
+  for (std::uint32_t i = 0; i < 3; ++i) {
+    const auto dog = state.session.GetDogById(
+        state.player_pointers[i]->GetDogId());
+    auto pos = dog->GetCurrentPosition();
+    auto speed = dog->GetSpeed();
+    CHECK(reader.Uint() == i);
+    CHECK_THAT(reader.Fixed(), WithinAbs(pos.x, kFixedPointError));
+    CHECK_THAT(reader.Fixed(), WithinAbs(pos.y, kFixedPointError));
+    CHECK_THAT(reader.Fixed(), WithinAbs(speed.sx, kFixedPointError));
+    CHECK_THAT(reader.Fixed(), WithinAbs(speed.sy, kFixedPointError));
+    CHECK(reader.Byte() == static_cast<std::uint8_t>(dog->GetDirection()));
+    REQUIRE(reader.Uint() == 1);
+    CHECK(reader.Uint() == i);
+    CHECK(reader.Uint() == i % 4);
+    CHECK(reader.Uint() == i * 10);
+  }
+  REQUIRE(reader.Uint() == 2);
+  for (std::uint32_t i = 0; i < 2; ++i) {
+    CHECK(reader.Uint() == i);
+    CHECK(reader.Uint() == i % 5);
+    CHECK_THAT(reader.Fixed(), WithinAbs(i * 1.25, kFixedPointError));
+    CHECK_THAT(reader.Fixed(), WithinAbs(0.0, kFixedPointError));
+  }
+  CHECK(reader.IsEmpty());
+}
+
+SCENARIO("Game state limited to the view area") {
+  GameState state(20, 20);
+  auto serialize = [&state](const model::Point& center, double radius) {
+    return json::parse(ApiSerializer::SerializeState(
+        &state.session, state.player_pointers,
+        ApiSerializer::ViewArea{center, radius}));
+  };
+
+  WHEN("the view area covers only part of the session") {
+    auto result = serialize({0, 0}, 2);
+    THEN("only dogs and loot within the radius are sent") {
+      // Собаки стоят в точках (0.37 * i, y), вещи - в (1.25 * i, ~0).
+      const auto& players = result.as_object().at("players"sv).as_object();
+      const auto& loot = result.as_object().at("lostObjects"sv).as_object();
+      CHECK(players.size() == 6);
+      CHECK(players.contains("0"sv));
+      CHECK(players.contains("5"sv));
+      CHECK_FALSE(players.contains("6"sv));
+      CHECK(loot.size() == 2);
+      CHECK(loot.contains("1"sv));
+      CHECK_FALSE(loot.contains("2"sv));
+    }
+  }
+
+  WHEN("the view area moves") {
+    auto result = serialize({6, 0}, 2);
+    THEN("objects enter and leave it") {
+      const auto& players = result.as_object().at("players"sv).as_object();
+      const auto& loot = result.as_object().at("lostObjects"sv).as_object();
+      CHECK_FALSE(players.contains("0"sv));
+      CHECK_FALSE(players.contains("10"sv));
+      CHECK(players.contains("11"sv));
+      CHECK(players.contains("19"sv));
+      CHECK_FALSE(loot.contains("0"sv));
+      CHECK_FALSE(loot.contains("3"sv));
+      CHECK(loot.contains("4"sv));
+    }
+  }
+
+  WHEN("the view area covers the whole session") {
+    THEN("the state is the same as without it") {
+      auto full = json::parse(ApiSerializer::SerializeState(
+          &state.session, state.player_pointers));
+      auto result = serialize({0, 0}, 1e6);
+      CHECK(result.as_object().at("players"sv).as_object().size() == 20);
+      CHECK(result.as_object().at("lostObjects"sv).as_object().size() == 20);
+      CHECK(json::serialize(result.as_object().at("players"sv)) ==
+            json::serialize(full.as_object().at("players"sv)));
+    }
+  }
+}
+
+TEST_CASE("Binary format is used only when explicitly preferred") {
+  constexpr auto kBinary = ContentType::kApplicationDogStoryBinary;
+  CHECK_FALSE(ContentType::IsPreferredOverJson(""sv, kBinary));
+  CHECK_FALSE(ContentType::IsPreferredOverJson("*/*"sv, kBinary));
+  CHECK(ContentType::IsPreferredOverJson(
+      "application/vnd.dog-story.binary, application/json;q=0.9"sv, kBinary));
+  CHECK_FALSE(ContentType::IsPreferredOverJson(
+      "application/vnd.dog-story.binary;q=0.5, application/json"sv, kBinary));
+  CHECK_FALSE(ContentType::IsPreferredOverJson(
+      "application/vnd.dog-story.binary;q=0"sv, kBinary));
+}
+
+// Сравнивает сериализацию состояния игры через дерево json::value, через
+// JsonWriter и в двоичном формате, а также размеры ответов.
+// Запуск: game_server_tests "[benchmark]"
+TEST_CASE("Game state serialization", "[.][benchmark]") {
+  GameState state(1000, 1000);
+
+  WARN("JSON state size: "
+       << ApiSerializer::SerializeState(&state.session, state.player_pointers)
+              .size()
+       << " bytes, binary state size: "
+       << ApiSerializer::SerializeStateBinary(&state.session,
+                                              state.player_pointers)
+              .size()
+       << " bytes");
+
+  BENCHMARK("json::value tree") {
+    return SerializeStateWithDom(state);
+  };
+
+  BENCHMARK("JsonWriter") {
+    return ApiSerializer::SerializeState(&state.session,
+                                         state.player_pointers);
+  };
+
+  BENCHMARK("BinaryWriter") {
+    return ApiSerializer::SerializeStateBinary(&state.session,
+                                               state.player_pointers);
+  };
+}
+
+// Сравнивает состояние игры целиком и только в радиусе обзора игрока.
+// Собаки и вещи стоят вдоль дороги длиной около 1000, радиус 20.
+// Запуск: game_server_tests "[benchmark]"
+TEST_CASE("Game state within the view radius", "[.][benchmark]") {
+  GameState state(3000, 1000);
+  const ApiSerializer::ViewArea view_area{{500, 0}, 20};
+
+  WARN("full state size: "
+       << ApiSerializer::SerializeState(&state.session, state.player_pointers)
+              .size()
+       << " bytes, state within the view radius: "
+       << ApiSerializer::SerializeState(&state.session, state.player_pointers,
+                                        view_area)
+              .size()
+       << " bytes");
+
+  BENCHMARK("full state") {
+    return ApiSerializer::SerializeState(&state.session,
+                                         state.player_pointers);
+  };
+
+  BENCHMARK("state within the view radius") {
+    return ApiSerializer::SerializeState(&state.session,
+                                         state.player_pointers, view_area);
+  };
+}
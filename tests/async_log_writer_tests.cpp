@@ -0,0 +1,62 @@
+#include <catch2/catch_test_macros.hpp>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "../src/logger/async_log_writer.h"
+
+using namespace std::literals;
+
+SCENARIO("Async log writer") {
+  using logger::AsyncLogWriter;
+  using logger::OverflowPolicy;
+
+  GIVEN("a writer with a small queue") {
+    std::ostringstream out;
+    AsyncLogWriter writer(out, 4, OverflowPolicy::kBlock);
+
+    WHEN("several threads write records") {
+      constexpr int kNumOfThreads = 4;
+      constexpr int kNumOfRecords = 1000;
+      std::vector<std::thread> threads;
+      for (int thread = 0; thread < kNumOfThreads; ++thread) {
+        threads.emplace_back([&writer, thread] {
+          for (int i = 0; i < kNumOfRecords; ++i) {
+            writer.Push(std::to_string(thread) + ' ' + std::to_string(i) +
+                        '\n');
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      writer.Stop();
+
+      THEN("all records are written in per-thread order") {
+        CHECK(writer.GetWrittenCount() == kNumOfThreads * kNumOfRecords);
+        CHECK(writer.GetDroppedCount() == 0);
+
+        std::istringstream in(out.str());
+        std::vector<int> next_record(kNumOfThreads, 0);
+        int thread = 0;
+        int record = 0;
+        while (in >> thread >> record) {
+          REQUIRE(record == next_record[thread]);
+          ++next_record[thread];
+        }
+        CHECK(next_record == std::vector<int>(kNumOfThreads, kNumOfRecords));
+      }
+    }
+
+    WHEN("a record is written after stop") {
+      writer.Push("first\n"s);
+      writer.Stop();
+
+      THEN("the record is dropped") {
+        CHECK_FALSE(writer.Push("second\n"s));
+        CHECK(out.str() == "first\n"s);
+        CHECK(writer.GetDroppedCount() == 1);
+      }
+    }
+  }
+}
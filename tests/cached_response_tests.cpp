@@ -0,0 +1,156 @@
+#include <boost/json.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/http_handler/cached_response.h"
+#include "../src/metrics/server_metrics.h"
+
+using namespace std::literals;
+
+namespace {
+
+namespace json = boost::json;
+namespace zlib = boost::beast::zlib;
+
+// Распаковывает данные в формате gzip (без проверки CRC-32).
+std::string GunzipBody(const std::string& data) {
+  constexpr std::size_t kGzipHeaderSize = 10;
+  constexpr std::size_t kGzipTrailerSize = 8;
+  zlib::inflate_stream stream;
+  stream.reset(15);
+  std::string result(data.size() * 16, '\0');
+  zlib::z_params params;
+  params.next_in = data.data() + kGzipHeaderSize;
+  params.avail_in = data.size() - kGzipHeaderSize - kGzipTrailerSize;
+  params.next_out = result.data();
+  params.avail_out = result.size();
+  boost::system::error_code ec;
+  stream.write(params, zlib::Flush::finish, ec);
+  result.resize(params.total_out);
+  return result;
+}
+
+// Формирует JSON-описание карты, похожее по размеру на карты из config.json.
+json::object MakeMapJson(int num_of_roads) {
+  json::array roads;
+  for (int i = 0; i < num_of_roads; ++i) {
+    roads.push_back(json::object{{"x0"s, i}, {"y0"s, i * 2}, {"x1"s, i + 40}});
+  }
+  return json::object{{"id"s, "map1"s}, {"name"s, "Map 1"s}, {"roads"s, roads}};
+}
+
+}  // namespace
+
+SCENARIO("Cached response") {
+  using http_handler::CachedResponse;
+  using util::ContentEncoding;
+
+  GIVEN("a cached JSON body") {
+    const std::string body = json::serialize(MakeMapJson(100));
+    CachedResponse response(body);
+
+    THEN("identity body is returned as is") {
+      REQUIRE(response.GetBody(ContentEncoding::kIdentity) == body);
+    }
+
+    THEN("gzip body is smaller and decompresses to the original") {
+      const auto& gzip_body = response.GetBody(ContentEncoding::kGzip);
+      REQUIRE(gzip_body.size() < body.size());
+      REQUIRE(GunzipBody(gzip_body) == body);
+    }
+
+    THEN("ETag is strong and stable") {
+      CachedResponse same_response(body);
+      const auto& etag = response.GetEtag(ContentEncoding::kIdentity);
+      REQUIRE(etag.front() == '"');
+      REQUIRE(etag == same_response.GetEtag(ContentEncoding::kIdentity));
+      REQUIRE(etag !=
+              CachedResponse("{}"s).GetEtag(ContentEncoding::kIdentity));
+    }
+
+    THEN("each encoding has its own ETag") {
+      const auto& etag = response.GetEtag(ContentEncoding::kIdentity);
+      const auto& gzip_etag = response.GetEtag(ContentEncoding::kGzip);
+      const auto& deflate_etag = response.GetEtag(ContentEncoding::kDeflate);
+      REQUIRE(gzip_etag == etag.substr(0, etag.size() - 1) + "-gzip\""s);
+      REQUIRE(deflate_etag != etag);
+      REQUIRE(deflate_etag != gzip_etag);
+    }
+
+    WHEN("If-None-Match is checked") {
+      const auto& etag = response.GetEtag(ContentEncoding::kIdentity);
+      const auto kIdentity = ContentEncoding::kIdentity;
+      THEN("matching tags are recognized") {
+        REQUIRE(response.IsNotModified(etag, kIdentity));
+        REQUIRE(response.IsNotModified("W/"s + etag, kIdentity));
+        REQUIRE(response.IsNotModified("\"other\", "s + etag, kIdentity));
+        REQUIRE(response.IsNotModified("*"sv, kIdentity));
+      }
+      THEN("other tags are not recognized") {
+        REQUIRE_FALSE(response.IsNotModified(""sv, kIdentity));
+        REQUIRE_FALSE(response.IsNotModified("\"other\""sv, kIdentity));
+      }
+      THEN("a tag of another encoding is not recognized") {
+        REQUIRE_FALSE(response.IsNotModified(etag, ContentEncoding::kGzip));
+        REQUIRE(response.IsNotModified(
+            response.GetEtag(ContentEncoding::kGzip), ContentEncoding::kGzip));
+      }
+    }
+  }
+
+  GIVEN("a body compressed on every request") {
+    const std::string body = json::serialize(MakeMapJson(10));
+    auto& input_bytes = metrics::GetServerMetrics()
+                            .compression_input_bytes.WithLabels({"gzip"sv});
+    auto input_bytes_before = input_bytes.GetValue();
+
+    THEN("compressor state is reused between calls") {
+      auto first = http_handler::CompressBody(body, ContentEncoding::kGzip);
+      auto second = http_handler::CompressBody(body, ContentEncoding::kGzip);
+      REQUIRE(first == second);
+      REQUIRE(GunzipBody(second) == body);
+      REQUIRE(input_bytes.GetValue() - input_bytes_before == 2 * body.size());
+    }
+  }
+
+  GIVEN("an Accept-Encoding header") {
+    THEN("gzip is preferred") {
+      REQUIRE(util::NegotiateContentEncoding("deflate, gzip"sv) ==
+              ContentEncoding::kGzip);
+      REQUIRE(util::NegotiateContentEncoding("br, *"sv) ==
+              ContentEncoding::kGzip);
+    }
+    THEN("encodings with zero quality are skipped") {
+      REQUIRE(util::NegotiateContentEncoding("gzip;q=0, deflate"sv) ==
+              ContentEncoding::kDeflate);
+      REQUIRE(util::NegotiateContentEncoding("gzip;q=0"sv) ==
+              ContentEncoding::kIdentity);
+    }
+    THEN("identity is used by default") {
+      REQUIRE(util::NegotiateContentEncoding(""sv) ==
+              ContentEncoding::kIdentity);
+    }
+  }
+}
+
+// Сравнивает сериализацию карты на каждый запрос с выдачей готового тела из
+// кеша. Запуск: game_server_tests "[benchmark]"
+TEST_CASE("Map endpoint body", "[.][benchmark]") {
+  const auto map_json = MakeMapJson(1000);
+  http_handler::CachedResponse response(json::serialize(map_json));
+
+  BENCHMARK("serialize on every request") {
+    return json::serialize(map_json);
+  };
+
+  BENCHMARK("cached body") {
+    auto encoding = util::NegotiateContentEncoding("gzip, deflate, br"sv);
+    return response.GetBody(encoding).data();
+  };
+
+  BENCHMARK("gzip on every request") {
+    return http_handler::CompressBody(
+        response.GetBody(util::ContentEncoding::kIdentity),
+        util::ContentEncoding::kGzip);
+  };
+}
@@ -0,0 +1,177 @@
+#include <atomic>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/write.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#include "../src/http_handler/api_handler.h"
+#include "../src/http_server/http_server.h"
+
+using namespace std::literals;
+
+namespace {
+
+std::atomic<std::size_t> allocation_count{0};
+
+}  // namespace
+
+// Подсчитывает все выделения памяти в тестовом процессе.
+void* operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+namespace net = boost::asio;
+namespace http = boost::beast::http;
+using tcp = net::ip::tcp;
+
+constexpr std::size_t kNumOfRequests = 1000;
+constexpr std::string_view kRequest =
+    "GET /api/v1/maps HTTP/1.1\r\nHost: localhost\r\n\r\n"sv;
+constexpr std::string_view kResponseEnd = "[]"sv;
+
+// Отвечает на любой запрос небольшим JSON-телом.
+struct StubHandler {
+  template <typename Send>
+  void operator()(http::request<http::string_body>&& req, Send&& send) {
+    http::response<http::string_body> response(http::status::ok,
+                                               req.version());
+    response.body() = kResponseEnd;
+    response.keep_alive(req.keep_alive());
+    response.prepare_payload();
+    send(std::move(response));
+  }
+};
+
+// Запускает сессию с обработчиком handler на сервере и возвращает
+// подключенный к ней клиентский сокет.
+template <typename Handler = StubHandler>
+tcp::socket ConnectToSession(net::io_context& server_ioc,
+                             net::io_context& client_ioc,
+                             Handler handler = {}) {
+  tcp::acceptor acceptor(server_ioc, {net::ip::make_address("127.0.0.1"sv), 0});
+  tcp::socket client(client_ioc);
+  client.connect(acceptor.local_endpoint());
+  auto server_socket = acceptor.accept();
+  std::make_shared<http_server::Session<Handler>>(std::move(server_socket),
+                                                  std::move(handler))
+      ->Run();
+  return client;
+}
+
+// Читает из сокета ответы, пока не получит num_of_responses тел.
+void ReadResponses(tcp::socket& client, std::size_t num_of_responses) {
+  std::string data;
+  std::size_t received = 0;
+  while (received < num_of_responses) {
+    auto size = net::read_until(client, net::dynamic_buffer(data),
+                                std::string(kResponseEnd));
+    data.erase(0, size);
+    ++received;
+  }
+}
+
+}  // namespace
+
+// Считает число выделений памяти на один запрос keep-alive соединения.
+// Логирование отключено, поэтому учитываются только выделения сервера и
+// клиента.
+// Запуск: game_server_tests "[benchmark]"
+TEST_CASE("Allocations per keep-alive request", "[.][benchmark]") {
+  logger::SetLogLevel(logger::LogLevel::kOff);
+  net::io_context server_ioc;
+  net::io_context client_ioc;
+  auto client = ConnectToSession(server_ioc, client_ioc);
+  auto work = net::make_work_guard(server_ioc);
+  std::thread server_thread([&server_ioc] { server_ioc.run(); });
+
+  // Прогрев: первые запросы выделяют буферы сессии.
+  net::write(client, net::buffer(kRequest));
+  ReadResponses(client, 1);
+
+  SECTION("sequential requests") {
+    auto start_count = allocation_count.load();
+    for (std::size_t i = 0; i < kNumOfRequests; ++i) {
+      net::write(client, net::buffer(kRequest));
+      ReadResponses(client, 1);
+    }
+    auto allocations = allocation_count.load() - start_count;
+    WARN("allocations per request: "
+         << static_cast<double>(allocations) / kNumOfRequests);
+  }
+
+  SECTION("pipelined requests") {
+    std::string requests;
+    for (std::size_t i = 0; i < kNumOfRequests; ++i) {
+      requests += kRequest;
+    }
+    auto start_count = allocation_count.load();
+    net::write(client, net::buffer(requests));
+    ReadResponses(client, kNumOfRequests);
+    auto allocations = allocation_count.load() - start_count;
+    WARN("allocations per pipelined request: "
+         << static_cast<double>(allocations) / kNumOfRequests);
+  }
+
+  client.close();
+  work.reset();
+  server_ioc.stop();
+  server_thread.join();
+  logger::SetLogLevel(logger::LogLevel::kInfo);
+}
+
+// То же для ApiHandler: запрос /api/v1/maps к игре без карт проходит через
+// маршрутизацию и кешированный ответ, как в работающем сервере. Application
+// при создании подключается к базе данных, поэтому нужен GAME_DB_URL.
+// Запуск: GAME_DB_URL=<url> game_server_tests "[benchmark]"
+TEST_CASE("Allocations per keep-alive API request", "[.][benchmark]") {
+  const auto* db_url = std::getenv("GAME_DB_URL");
+  if (!db_url) {
+    WARN("GAME_DB_URL is not set");
+    return;
+  }
+  logger::SetLogLevel(logger::LogLevel::kOff);
+  net::io_context server_ioc;
+  net::io_context client_ioc;
+  model::Game game(model::LootGenerator(1s, 0.0));
+  auto application = std::make_shared<app::Application>(
+      server_ioc, nullptr, game, ""s, false,
+      db::DatabaseConfig(1, [db_url] {
+        return std::make_shared<pqxx::connection>(db_url);
+      }));
+  http_handler::ApiHandler api_handler(server_ioc.get_executor(), application,
+                                       false, false, ""s, 0.0, 1024);
+  auto client =
+      ConnectToSession(server_ioc, client_ioc, std::ref(api_handler));
+  auto work = net::make_work_guard(server_ioc);
+  std::thread server_thread([&server_ioc] { server_ioc.run(); });
+
+  net::write(client, net::buffer(kRequest));
+  ReadResponses(client, 1);
+
+  auto start_count = allocation_count.load();
+  for (std::size_t i = 0; i < kNumOfRequests; ++i) {
+    net::write(client, net::buffer(kRequest));
+    ReadResponses(client, 1);
+  }
+  auto allocations = allocation_count.load() - start_count;
+  WARN("allocations per API request: "
+       << static_cast<double>(allocations) / kNumOfRequests);
+
+  client.close();
+  work.reset();
+  server_ioc.stop();
+  server_thread.join();
+  logger::SetLogLevel(logger::LogLevel::kInfo);
+}
@@ -0,0 +1,113 @@
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/strand.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <future>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../lib/util/io_context_pool.h"
+
+using namespace std::literals;
+
+namespace {
+
+namespace net = boost::asio;
+using Strand = net::strand<net::io_context::executor_type>;
+
+constexpr std::size_t kNumOfSessions = 256;
+// Размер состояния одной сессии: 32 КиБ, примерно как у сессии с десятками
+// собак и потерянных вещей.
+constexpr std::size_t kSessionStateSize = 4096;
+constexpr std::size_t kOperationsPerClient = 20000;
+
+// Состояние игровой сессии, которое изменяет каждая операция.
+struct SessionState {
+  std::vector<double> values = std::vector<double>(kSessionStateSize, 1.0);
+};
+
+// Выполняет операцию в strand сессии и дожидается ее завершения, как
+// Application делает с операциями игровых сессий.
+void ExecuteInStrand(const Strand& strand, SessionState& state) {
+  std::promise<void> done;
+  auto future = done.get_future();
+  net::dispatch(strand, [&state, &done] {
+    for (auto& value : state.values) {
+      value = value * 0.5 + 1.0;
+    }
+    done.set_value();
+  });
+  future.wait();
+}
+
+// Запускает num_of_clients потоков, которые выполняют операции над
+// случайными сессиями, и возвращает число операций в секунду.
+double MeasureThroughput(const std::vector<Strand>& strands,
+                         std::vector<SessionState>& states,
+                         unsigned num_of_clients) {
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::vector<std::jthread> clients;
+    for (unsigned client = 0; client < num_of_clients; ++client) {
+      clients.emplace_back([&strands, &states, client] {
+        std::mt19937 random(client);
+        std::uniform_int_distribution<std::size_t> session(
+            0, kNumOfSessions - 1);
+        for (std::size_t i = 0; i < kOperationsPerClient; ++i) {
+          auto index = session(random);
+          ExecuteInStrand(strands[index], states[index]);
+        }
+      });
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_of_clients * kOperationsPerClient) /
+         elapsed.count();
+}
+
+}  // namespace
+
+// Сравнивает пропускную способность одного io_context с несколькими потоками
+// и пула io_context с потоками, закрепленными за ядрами, при операциях над
+// состоянием игровых сессий.
+// Запуск: game_server_tests "[benchmark]"
+TEST_CASE("Single vs sharded reactor throughput", "[.][benchmark]") {
+  const unsigned num_of_threads =
+      std::max(2u, std::thread::hardware_concurrency());
+  const unsigned num_of_clients = num_of_threads;
+  std::vector<SessionState> states(kNumOfSessions);
+
+  SECTION("single io_context") {
+    net::io_context ioc(static_cast<int>(num_of_threads));
+    auto work = net::make_work_guard(ioc);
+    std::vector<Strand> strands;
+    for (std::size_t i = 0; i < kNumOfSessions; ++i) {
+      strands.push_back(net::make_strand(ioc));
+    }
+    std::vector<std::jthread> workers;
+    for (unsigned i = 0; i < num_of_threads; ++i) {
+      workers.emplace_back([&ioc] { ioc.run(); });
+    }
+    WARN("single io_context, " << num_of_threads << " threads: "
+                               << MeasureThroughput(strands, states,
+                                                    num_of_clients)
+                               << " ops/s");
+    work.reset();
+  }
+
+  SECTION("sharded io_contexts") {
+    util::IoContextPool shards(num_of_threads);
+    std::vector<Strand> strands;
+    for (std::size_t i = 0; i < kNumOfSessions; ++i) {
+      strands.push_back(
+          net::make_strand(shards.GetIoContext(i % shards.GetSize())));
+    }
+    shards.Start(true);
+    WARN(num_of_threads << " pinned shards: "
+                        << MeasureThroughput(strands, states, num_of_clients)
+                        << " ops/s");
+    shards.Stop();
+  }
+}
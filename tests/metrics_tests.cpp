@@ -0,0 +1,70 @@
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+
+#include "../src/metrics/metrics.h"
+
+using namespace std::literals;
+
+SCENARIO("Metrics registry") {
+  using metrics::Registry;
+
+  GIVEN("a registry with a counter, a gauge and a histogram family") {
+    Registry registry;
+    auto& counter = registry.AddCounter("requests_total"s, "Requests"s);
+    auto& gauge = registry.AddGauge("sessions"s, "Sessions"s);
+    auto& family = registry.AddHistogramFamily(
+        "duration_seconds"s, "Duration"s, {"endpoint"s, "code"s}, {0.1, 1});
+
+    WHEN("metrics are updated from several threads") {
+      constexpr int kNumOfThreads = 4;
+      constexpr int kNumOfUpdates = 1000;
+      std::vector<std::thread> threads;
+      for (int i = 0; i < kNumOfThreads; ++i) {
+        threads.emplace_back([&] {
+          for (int j = 0; j < kNumOfUpdates; ++j) {
+            counter.Inc();
+            gauge.Add(1);
+            family.WithLabels({"/a"sv, "200"sv}).Observe(0.5);
+          }
+        });
+      }
+      for (auto& thread : threads) {
+        thread.join();
+      }
+
+      THEN("no updates are lost") {
+        CHECK(counter.GetValue() == kNumOfThreads * kNumOfUpdates);
+        CHECK(gauge.GetValue() == kNumOfThreads * kNumOfUpdates);
+        auto snapshot = family.WithLabels({"/a"sv, "200"sv}).Collect();
+        CHECK(snapshot.cumulative_counts ==
+              std::vector<std::uint64_t>{0, 4000, 4000});
+        CHECK(snapshot.sum == 2000.0);
+      }
+    }
+
+    WHEN("the registry is serialized") {
+      counter.Inc(3);
+      gauge.Set(2.5);
+      family.WithLabels({"/a"sv, "404"sv}).Observe(1);
+
+      THEN("metrics are written in Prometheus text format") {
+        const std::string labels = "endpoint=\"/a\",code=\"404\""s;
+        CHECK(registry.Serialize() ==
+              "# HELP requests_total Requests\n"
+              "# TYPE requests_total counter\n"
+              "requests_total 3\n"
+              "# HELP sessions Sessions\n"
+              "# TYPE sessions gauge\n"
+              "sessions 2.5\n"
+              "# HELP duration_seconds Duration\n"
+              "# TYPE duration_seconds histogram\n"s +
+                  "duration_seconds_bucket{"s + labels + ",le=\"0.1\"} 0\n"s +
+                  "duration_seconds_bucket{"s + labels + ",le=\"1\"} 1\n"s +
+                  "duration_seconds_bucket{"s + labels + ",le=\"+Inf\"} 1\n"s +
+                  "duration_seconds_sum{"s + labels + "} 1\n"s +
+                  "duration_seconds_count{"s + labels + "} 1\n"s);
+      }
+    }
+  }
+}
@@ -0,0 +1,38 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/http_handler/route_table.h"
+
+using namespace std::literals;
+
+namespace {
+
+using http_handler::MethodSet;
+using http_handler::PerfectHashTable;
+namespace http = boost::beast::http;
+
+constexpr std::array<std::string_view, 4> kKeys{
+    "/api/v1/maps"sv, "/api/v1/game/join"sv, "/api/v1/game/state"sv,
+    "/api/v1/game/tick"sv};
+
+constexpr PerfectHashTable kTable(kKeys);
+
+}  // namespace
+
+TEST_CASE("Perfect hash table finds every key at compile time") {
+  STATIC_REQUIRE(kTable.Find("/api/v1/maps"sv) == 0);
+  STATIC_REQUIRE(kTable.Find("/api/v1/game/tick"sv) == 3);
+  STATIC_REQUIRE(!kTable.Find("/api/v1/game"sv));
+  for (std::size_t i = 0; i < kKeys.size(); ++i) {
+    CHECK(kTable.Find(kKeys[i]) == i);
+  }
+  CHECK_FALSE(kTable.Find(""sv));
+  CHECK_FALSE(kTable.Find("/api/v1/game/join/"sv));
+}
+
+TEST_CASE("Method set") {
+  constexpr MethodSet methods{http::verb::get, http::verb::head};
+  STATIC_REQUIRE(methods.Contains(http::verb::get));
+  STATIC_REQUIRE_FALSE(methods.Contains(http::verb::post));
+  CHECK(methods.ToString() == "GET, HEAD"s);
+  CHECK(MethodSet{}.ToString().empty());
+}
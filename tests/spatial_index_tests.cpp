@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+#include "../lib/model/spatial_index.h"
+
+namespace {
+
+using model::Point;
+using model::SpatialIndex;
+
+std::vector<int> FindInRadius(const SpatialIndex<int>& index,
+                              const Point& center, double radius) {
+  std::vector<int> result;
+  index.ForEachInRadius(center, radius, [&result](const int* item) {
+    result.push_back(*item);
+  });
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+}  // namespace
+
+SCENARIO("Spatial index") {
+  const std::vector<int> items{0, 1, 2, 3};
+  const std::vector<Point> positions{{0, 0}, {3, 4}, {-7.5, 0}, {100, 100}};
+  SpatialIndex<int> index(2.0);
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    index.Insert(positions[i], &items[i]);
+  }
+
+  WHEN("objects are searched around a point") {
+    THEN("only objects within the radius are found") {
+      CHECK(FindInRadius(index, {0, 0}, 5) == std::vector{0, 1});
+      CHECK(FindInRadius(index, {0, 0}, 4.99) == std::vector{0});
+      CHECK(FindInRadius(index, {-4, 0}, 4) == std::vector{0, 2});
+      CHECK(FindInRadius(index, {50, 50}, 1).empty());
+    }
+    THEN("a radius larger than the index visits every occupied cell") {
+      CHECK(FindInRadius(index, {0, 0}, 1e9) == std::vector{0, 1, 2, 3});
+    }
+  }
+
+  WHEN("an object is removed") {
+    index.Remove(positions[1], &items[1]);
+    THEN("it is no longer found") {
+      CHECK(FindInRadius(index, {0, 0}, 5) == std::vector{0});
+    }
+  }
+
+  WHEN("an object moves into range") {
+    index.Remove(positions[3], &items[3]);
+    index.Insert({1, 1}, &items[3]);
+    THEN("it is found at the new position") {
+      CHECK(FindInRadius(index, {0, 0}, 2) == std::vector{0, 3});
+      CHECK(FindInRadius(index, {100, 100}, 2).empty());
+    }
+  }
+}
@@ -0,0 +1,245 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+
+#include "../src/http_handler/static_file_cache.h"
+
+using namespace std::literals;
+
+namespace {
+
+namespace fs = std::filesystem;
+namespace http = boost::beast::http;
+using http_handler::StaticFileBody;
+using http_handler::StaticFileCache;
+
+// Временный каталог с файлами для теста. Удаляется вместе с файлами.
+class TempDir {
+ public:
+  TempDir()
+      : path_(fs::temp_directory_path() /
+              ("static_file_cache_tests_"s + std::to_string(::getpid()))) {
+    fs::create_directories(path_);
+  }
+  ~TempDir() {
+    std::error_code ec;
+    fs::remove_all(path_, ec);
+  }
+
+  fs::path AddFile(const std::string& name, const std::string& content) {
+    auto path = path_ / name;
+    std::ofstream(path, std::ios::binary) << content;
+    return path;
+  }
+
+ private:
+  fs::path path_;
+};
+
+// Ответ, переданный в send, без тела для empty_body.
+struct SentResponse {
+  http::status status;
+  http::fields headers;
+  std::string body;
+};
+
+// Вызывает SendCachedFile для запроса GET target с заголовками headers.
+SentResponse SendFile(
+    StaticFileCache::FilePtr file,
+    std::initializer_list<std::pair<http::field, std::string_view>> headers) {
+  http::request<http::string_body> req(http::verb::get, "/file.txt"sv, 11);
+  for (const auto& [field, value] : headers) {
+    req.set(field, value);
+  }
+  SentResponse sent;
+  http_handler::SendCachedFile(std::move(file), req, [&sent](auto&& response) {
+    using Body = typename std::decay_t<decltype(response)>::body_type;
+    sent.status = response.result();
+    for (const auto& field : response.base()) {
+      sent.headers.insert(field.name_string(), field.value());
+    }
+    if constexpr (std::is_same_v<Body, StaticFileBody>) {
+      sent.body = std::string(response.body().data);
+    } else if constexpr (std::is_same_v<Body, http::string_body>) {
+      sent.body = response.body();
+    }
+  });
+  return sent;
+}
+
+}  // namespace
+
+SCENARIO("Static file cache") {
+  TempDir dir;
+  // Текст хорошо сжимается, поэтому у файла есть gzip-вариант.
+  std::string content;
+  for (int i = 0; i < 200; ++i) {
+    content += "line "s + std::to_string(i % 10) + "\n"s;
+  }
+  auto path = dir.AddFile("file.txt", content);
+
+  GIVEN("a cache with enough budget") {
+    StaticFileCache cache(1024 * 1024);
+
+    THEN("a loaded file is found by its target") {
+      REQUIRE_FALSE(cache.Find("/file.txt"sv));
+      auto file = cache.Load("/file.txt"sv, path);
+      REQUIRE(file);
+      REQUIRE(file->content == content);
+      REQUIRE_FALSE(file->gzip_content.empty());
+      REQUIRE(file->gzip_etag != file->etag);
+      REQUIRE(cache.Find("/file.txt"sv) == file);
+    }
+
+    THEN("the first loaded file wins") {
+      auto other_path = dir.AddFile("other.txt", "other"s);
+      auto file = cache.Load("/file.txt"sv, path);
+      REQUIRE(cache.Load("/file.txt"sv, other_path) == file);
+      REQUIRE(cache.Find("/file.txt"sv)->content == content);
+    }
+
+    THEN("files larger than kMaxFileSize are not cached") {
+      auto large_path = dir.AddFile("large.bin", ""s);
+      fs::resize_file(large_path, StaticFileCache::kMaxFileSize + 1);
+      StaticFileCache large_cache(2 * StaticFileCache::kMaxFileSize);
+      REQUIRE_FALSE(large_cache.Load("/large.bin"sv, large_path));
+      REQUIRE_FALSE(large_cache.Find("/large.bin"sv));
+    }
+  }
+
+  GIVEN("a cache with a small budget") {
+    StaticFileCache cache(content.size() + 100);
+
+    THEN("files that do not fit into the rest of the budget are not cached") {
+      REQUIRE(cache.Load("/file.txt"sv, path));
+      auto second_path = dir.AddFile("second.txt", content);
+      REQUIRE_FALSE(cache.Load("/second.txt"sv, second_path));
+      REQUIRE_FALSE(cache.Find("/second.txt"sv));
+
+      AND_THEN("they are not loaded again even if they would fit now") {
+        fs::resize_file(second_path, 1);
+        REQUIRE_FALSE(cache.Load("/second.txt"sv, second_path));
+      }
+    }
+  }
+
+  GIVEN("different targets of one file") {
+    const fs::path root = "/var/www"s;
+
+    THEN("they map to one cache key") {
+      const auto key = http_handler::MakeStaticFileKey(root, root / "a.js"s);
+      REQUIRE(key == "a.js"s);
+      REQUIRE(http_handler::MakeStaticFileKey(root, "/var/www//a.js"s) == key);
+      REQUIRE(http_handler::MakeStaticFileKey(root, "/var/www/./././a.js"s) ==
+              key);
+      REQUIRE(http_handler::MakeStaticFileKey(root, "/var/www/js/../a.js"s) ==
+              key);
+      REQUIRE(http_handler::MakeStaticFileKey("/var/www/"s, "/var/www/a.js"s) ==
+              key);
+    }
+  }
+
+  GIVEN("a cached file") {
+    StaticFileCache cache(1024 * 1024);
+    auto file = cache.Load("/file.txt"sv, path);
+    REQUIRE(file);
+
+    THEN("it is sent whole with validators") {
+      auto sent = SendFile(file, {});
+      REQUIRE(sent.status == http::status::ok);
+      REQUIRE(sent.body == content);
+      REQUIRE(sent.headers[http::field::etag] == file->etag);
+      REQUIRE(sent.headers[http::field::vary] == "Accept-Encoding"sv);
+    }
+
+    THEN("gzip is sent with its own ETag") {
+      auto sent = SendFile(file, {{http::field::accept_encoding, "gzip"sv}});
+      REQUIRE(sent.status == http::status::ok);
+      REQUIRE(sent.body == file->gzip_content);
+      REQUIRE(sent.headers[http::field::content_encoding] == "gzip"sv);
+      REQUIRE(sent.headers[http::field::etag] == file->gzip_etag);
+    }
+
+    THEN("a matching ETag of the sent representation gives 304") {
+      auto sent = SendFile(file, {{http::field::if_none_match, file->etag}});
+      REQUIRE(sent.status == http::status::not_modified);
+      REQUIRE(sent.headers[http::field::vary] == "Accept-Encoding"sv);
+
+      sent = SendFile(file, {{http::field::accept_encoding, "gzip"sv},
+                             {http::field::if_none_match, file->etag}});
+      REQUIRE(sent.status == http::status::ok);
+    }
+
+    THEN("a range is sent with 206") {
+      auto sent = SendFile(file, {{http::field::range, "bytes=5-9"sv}});
+      REQUIRE(sent.status == http::status::partial_content);
+      REQUIRE(sent.body == content.substr(5, 5));
+      REQUIRE(sent.headers[http::field::content_range] ==
+              "bytes 5-9/"s + std::to_string(content.size()));
+    }
+
+    THEN("If-Range with the ETag of another representation gives 200") {
+      auto sent = SendFile(file, {{http::field::accept_encoding, "gzip"sv},
+                                  {http::field::range, "bytes=5-9"sv},
+                                  {http::field::if_range, file->etag}});
+      REQUIRE(sent.status == http::status::ok);
+      REQUIRE(sent.body == file->gzip_content);
+    }
+
+    THEN("a range past the end gives 416") {
+      auto sent = SendFile(file, {{http::field::range, "bytes=100000-"sv}});
+      REQUIRE(sent.status == http::status::range_not_satisfiable);
+      REQUIRE(sent.headers[http::field::content_range] ==
+              "bytes */"s + std::to_string(content.size()));
+    }
+  }
+}
+
+SCENARIO("Range header parsing") {
+  using http_handler::ParseRange;
+  using http_handler::RangeStatus;
+
+  GIVEN("a file of 100 bytes") {
+    constexpr std::size_t kSize = 100;
+
+    THEN("closed, open and suffix ranges are satisfiable") {
+      auto [status, range] = ParseRange("bytes=10-19"sv, kSize);
+      REQUIRE(status == RangeStatus::kSatisfiable);
+      REQUIRE(range.offset == 10);
+      REQUIRE(range.length == 10);
+
+      std::tie(status, range) = ParseRange("bytes=90-"sv, kSize);
+      REQUIRE(status == RangeStatus::kSatisfiable);
+      REQUIRE(range.offset == 90);
+      REQUIRE(range.length == 10);
+
+      std::tie(status, range) = ParseRange("bytes=-5"sv, kSize);
+      REQUIRE(status == RangeStatus::kSatisfiable);
+      REQUIRE(range.offset == 95);
+      REQUIRE(range.length == 5);
+    }
+
+    THEN("ranges past the end are truncated") {
+      auto [status, range] = ParseRange("bytes=50-1000"sv, kSize);
+      REQUIRE(status == RangeStatus::kSatisfiable);
+      REQUIRE(range.length == 50);
+    }
+
+    THEN("ranges starting past the end are unsatisfiable") {
+      REQUIRE(ParseRange("bytes=100-"sv, kSize).first ==
+              RangeStatus::kUnsatisfiable);
+      REQUIRE(ParseRange("bytes=-0"sv, kSize).first ==
+              RangeStatus::kUnsatisfiable);
+    }
+
+    THEN("unsupported and malformed ranges are ignored") {
+      REQUIRE(ParseRange("bytes=0-1,5-6"sv, kSize).first == RangeStatus::kNone);
+      REQUIRE(ParseRange("items=0-1"sv, kSize).first == RangeStatus::kNone);
+      REQUIRE(ParseRange("bytes=5-1"sv, kSize).first == RangeStatus::kNone);
+      REQUIRE(ParseRange("bytes=a-b"sv, kSize).first == RangeStatus::kNone);
+    }
+  }
+}
@@ -0,0 +1,98 @@
+#include <boost/asio/io_context.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <optional>
+
+#include "../src/http_server/timer_wheel.h"
+
+using namespace std::literals;
+
+namespace net = boost::asio;
+
+// Проверки не полагаются на точность срабатывания: колесо проверяется только
+// на порядок срабатывания, однократный вызов обработчика и на то, что таймер
+// не срабатывает раньше срока. Сроки таймеров разнесены на сотни
+// миллисекунд, чтобы тест не зависел от загрузки машины.
+SCENARIO("Timer wheel") {
+  using http_server::TimerWheel;
+  using http_server::WheelTimer;
+  using Clock = TimerWheel::Clock;
+
+  net::io_context ioc;
+  auto wheel = std::make_shared<TimerWheel>(ioc.get_executor(), 1ms, 16);
+  wheel->Start();
+
+  // Обслуживает колесо в течение duration.
+  auto run_for = [&ioc](std::chrono::milliseconds duration) {
+    ioc.restart();
+    ioc.run_for(duration);
+  };
+
+  // Число срабатываний таймера и момент первого срабатывания.
+  struct Expiration {
+    int count = 0;
+    std::optional<Clock::time_point> time;
+  };
+  Expiration near_expiration;
+  Expiration far_expiration;
+
+  // Обслуживает колесо, пока таймер не сработает, но не дольше 10 с.
+  auto run_until_expired = [&ioc](const Expiration& expiration) {
+    const auto limit = Clock::now() + 10s;
+    ioc.restart();
+    while (expiration.count == 0 && Clock::now() < limit) {
+      ioc.run_one_for(10ms);
+    }
+    return expiration.count > 0;
+  };
+  auto make_timer = [&wheel](Expiration& expiration) {
+    return std::make_shared<WheelTimer>(wheel, [&expiration] {
+      ++expiration.count;
+      if (!expiration.time) {
+        expiration.time = Clock::now();
+      }
+    });
+  };
+
+  GIVEN("timers with different deadlines") {
+    auto near_timer = make_timer(near_expiration);
+    auto far_timer = make_timer(far_expiration);
+    const auto start = Clock::now();
+    near_timer->ExpiresAt(start + 5ms);
+    // Срок дальше оборота колеса.
+    far_timer->ExpiresAt(start + 500ms);
+
+    THEN("timers expire once, in deadline order and not before deadline") {
+      REQUIRE(run_until_expired(near_expiration));
+      REQUIRE(far_expiration.count == 0);
+      REQUIRE_FALSE(far_timer->IsExpired(start + 400ms));
+      REQUIRE(run_until_expired(far_expiration));
+      REQUIRE(*near_expiration.time >= start + 5ms);
+      REQUIRE(*far_expiration.time >= start + 500ms);
+      REQUIRE(far_timer->IsExpired());
+
+      run_for(50ms);
+      REQUIRE(near_expiration.count == 1);
+      REQUIRE(far_expiration.count == 1);
+    }
+
+    THEN("postponed and cancelled timers do not expire early") {
+      near_timer->ExpiresAt(start + 500ms);
+      far_timer->Cancel();
+      // Пробный таймер с коротким сроком показывает, что колесо уже
+      // проверило слот прежнего срока near_timer.
+      Expiration probe;
+      auto probe_timer = make_timer(probe);
+      probe_timer->ExpiresAt(start + 20ms);
+      REQUIRE(run_until_expired(probe));
+      REQUIRE(near_expiration.count == 0);
+
+      REQUIRE(run_until_expired(near_expiration));
+      REQUIRE(*near_expiration.time >= start + 500ms);
+      run_for(50ms);
+      REQUIRE(near_expiration.count == 1);
+      REQUIRE(far_expiration.count == 0);
+    }
+  }
+
+  wheel->Stop();
+}